@@ -0,0 +1,508 @@
+#include "contact_columnar.h"
+#include "contact_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stddef.h> // offsetof
+
+// ============================================================================
+// WRITING
+// ============================================================================
+
+static const char *field_of(const Contact *contact, ColumnTag tag)
+{
+    switch (tag)
+    {
+    case COLUMN_NAME:
+        return contact->name;
+    case COLUMN_PHONE:
+        return contact->phone;
+    default:
+        return contact->email;
+    }
+}
+
+// Builds the body of one column in memory. Returns its length, 0 on failure.
+static uint32_t build_column(const ContactList *list, ColumnTag tag, uint8_t **body_out)
+{
+    uint32_t count = (uint32_t)list->size;
+    size_t length;
+    uint8_t *body;
+
+    if (tag == COLUMN_ID)
+    {
+        length = (size_t)count * sizeof(int32_t);
+        body = malloc(length > 0 ? length : 1);
+        if (body == NULL)
+            return 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            int32_t id = list->data[i].id;
+            memcpy(body + (size_t)i * sizeof(int32_t), &id, sizeof(id));
+        }
+    }
+    else
+    {
+        // Offsets first, so the reader can jump to any value
+        size_t table = (size_t)(count + 1) * sizeof(uint32_t);
+        size_t text = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            text += strlen(field_of(&list->data[i], tag));
+        }
+
+        length = table + text;
+        body = malloc(length);
+        if (body == NULL)
+            return 0;
+
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const char *value = field_of(&list->data[i], tag);
+            size_t value_length = strlen(value);
+            memcpy(body + (size_t)i * sizeof(uint32_t), &offset, sizeof(offset));
+            memcpy(body + table + offset, value, value_length);
+            offset += (uint32_t)value_length;
+        }
+        memcpy(body + (size_t)count * sizeof(uint32_t), &offset, sizeof(offset));
+    }
+
+    *body_out = body;
+    return (uint32_t)length;
+}
+
+static bool write_column(FILE *file, const ContactList *list, ColumnTag tag, ColumnDirEntry *entry)
+{
+    static const uint8_t padding[4] = {0};
+    uint8_t *body = NULL;
+    uint32_t length = build_column(list, tag, &body);
+    if (body == NULL)
+    {
+        printf("COLUMNAR ERROR: Out of memory for column %d\n", (int)tag);
+        return false;
+    }
+
+    ColumnBlockHeader block = {0};
+    block.tag = (uint32_t)tag;
+    block.length = length;
+    block.checksum = fletcher32(body, length);
+
+    bool ok = fwrite(&block, sizeof(block), 1, file) == 1;
+    entry->tag = block.tag;
+    entry->offset = (uint32_t)ftell(file);
+    entry->length = length;
+    entry->checksum = block.checksum;
+    ok = ok && (length == 0 || fwrite(body, 1, length, file) == length);
+    ok = ok && fwrite(padding, 1, (4 - length % 4) % 4, file) == (4 - length % 4) % 4;
+
+    free(body);
+    return ok;
+}
+
+bool contact_columnar_save(const ContactList *list, const char *filename)
+{
+    if (list == NULL || filename == NULL)
+    {
+        printf("COLUMNAR ERROR: NULL parameters\n");
+        return false;
+    }
+
+    char temp_name[256];
+    snprintf(temp_name, sizeof(temp_name), "%s.tmp", filename);
+
+    FILE *file = NULL;
+    ColumnDirEntry directory[COLUMN_COUNT];
+    bool success = false;
+
+    // === STEP 1: Header ===
+    ColumnarHeader header = {0};
+    header.magic = COLUMNAR_MAGIC;
+    header.version = COLUMNAR_VERSION;
+    header.contact_count = (uint32_t)list->size;
+    header.next_contact_id = (uint32_t)next_contact_id;
+    header.column_count = COLUMN_COUNT;
+    header.timestamp = time(NULL);
+    header.header_checksum = fletcher32(
+        &header.contact_count,
+        sizeof(ColumnarHeader) - offsetof(ColumnarHeader, contact_count));
+
+    file = fopen(temp_name, "wb");
+    if (file == NULL)
+    {
+        printf("COLUMNAR ERROR: Cannot open '%s' for writing\n", temp_name);
+        goto cleanup;
+    }
+    if (fwrite(&header, sizeof(header), 1, file) != 1)
+    {
+        printf("COLUMNAR ERROR: Failed to write header\n");
+        goto cleanup;
+    }
+
+    // === STEP 2: One block per column ===
+    for (int tag = COLUMN_ID; tag <= COLUMN_COUNT; tag++)
+    {
+        if (!write_column(file, list, (ColumnTag)tag, &directory[tag - COLUMN_ID]))
+        {
+            printf("COLUMNAR ERROR: Failed to write column %d\n", tag);
+            goto cleanup;
+        }
+    }
+
+    // === STEP 3: Directory + footer ===
+    ColumnarFooter footer = {0};
+    footer.directory_offset = (uint32_t)ftell(file);
+    footer.directory_checksum = fletcher32(directory, sizeof(directory));
+    footer.magic = FILE_MAGIC_TRBL;
+    if (fwrite(directory, sizeof(directory), 1, file) != 1 ||
+        fwrite(&footer, sizeof(footer), 1, file) != 1)
+    {
+        printf("COLUMNAR ERROR: Failed to write directory\n");
+        goto cleanup;
+    }
+
+    if (!file_sync(file))
+    {
+        printf("COLUMNAR ERROR: fsync of '%s' failed\n", temp_name);
+        goto cleanup;
+    }
+    success = true;
+
+cleanup:
+    if (file != NULL && fclose(file) != 0)
+    {
+        success = false;
+    }
+    if (success && !file_replace(temp_name, filename))
+    {
+        printf("COLUMNAR ERROR: Cannot replace '%s'\n", filename);
+        success = false;
+    }
+    if (!success)
+    {
+        remove(temp_name);
+        return false;
+    }
+
+    file_sync_dir(filename);
+    printf("COLUMNAR: Saved %d contacts to '%s'\n", list->size, filename);
+    return true;
+}
+
+// ============================================================================
+// READING
+// ============================================================================
+
+bool contact_columnar_open(ColumnarSnapshot *snapshot, const char *filename)
+{
+    if (snapshot == NULL || filename == NULL)
+    {
+        return false;
+    }
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    if (!file_map(filename, &snapshot->map))
+    {
+        printf("COLUMNAR ERROR: Cannot map '%s'\n", filename);
+        return false;
+    }
+
+    const uint8_t *data = snapshot->map.data;
+    size_t size = snapshot->map.size;
+
+    // === STEP 1: Header ===
+    const ColumnarHeader *header = (const ColumnarHeader *)data;
+    if (size < sizeof(ColumnarHeader) + sizeof(ColumnarFooter) ||
+        header->magic != COLUMNAR_MAGIC ||
+        header->version > COLUMNAR_VERSION ||
+        header->column_count == 0 || header->column_count > COLUMN_COUNT ||
+        header->header_checksum != fletcher32(&header->contact_count,
+                                              sizeof(ColumnarHeader) -
+                                                  offsetof(ColumnarHeader, contact_count)))
+    {
+        printf("COLUMNAR ERROR: '%s' is not a valid columnar snapshot\n", filename);
+        contact_columnar_close(snapshot);
+        return false;
+    }
+
+    // === STEP 2: Footer -> directory ===
+    const ColumnarFooter *footer = (const ColumnarFooter *)(data + size - sizeof(ColumnarFooter));
+    size_t directory_size = header->column_count * sizeof(ColumnDirEntry);
+    if (footer->magic != FILE_MAGIC_TRBL ||
+        (size_t)footer->directory_offset + directory_size != size - sizeof(ColumnarFooter) ||
+        footer->directory_offset % 4 != 0 ||
+        footer->directory_checksum != fletcher32(data + footer->directory_offset, directory_size))
+    {
+        printf("COLUMNAR ERROR: Directory of '%s' is damaged\n", filename);
+        contact_columnar_close(snapshot);
+        return false;
+    }
+
+    const ColumnDirEntry *directory = (const ColumnDirEntry *)(data + footer->directory_offset);
+    for (uint32_t i = 0; i < header->column_count; i++)
+    {
+        if (directory[i].offset % 4 != 0 ||
+            directory[i].offset < sizeof(ColumnarHeader) ||
+            (size_t)directory[i].offset + directory[i].length > footer->directory_offset)
+        {
+            printf("COLUMNAR ERROR: Column %u of '%s' is out of bounds\n", directory[i].tag, filename);
+            contact_columnar_close(snapshot);
+            return false;
+        }
+    }
+
+    snapshot->header = header;
+    snapshot->directory = directory;
+    return true;
+}
+
+void contact_columnar_close(ColumnarSnapshot *snapshot)
+{
+    if (snapshot == NULL)
+    {
+        return;
+    }
+
+    file_unmap(&snapshot->map);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+// Checksum + shape of one block, done once per open snapshot
+static bool verify_column(const ColumnDirEntry *entry, const uint8_t *body, uint32_t count)
+{
+    if (fletcher32(body, entry->length) != entry->checksum)
+    {
+        return false;
+    }
+
+    if (entry->tag == COLUMN_ID)
+    {
+        return entry->length == (uint64_t)count * sizeof(int32_t);
+    }
+
+    size_t table = (size_t)(count + 1) * sizeof(uint32_t);
+    if (entry->length < table)
+    {
+        return false;
+    }
+
+    const uint32_t *offsets = (const uint32_t *)body;
+    if (offsets[0] != 0 || offsets[count] != entry->length - table)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (offsets[i] > offsets[i + 1])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool contact_columnar_column(ColumnarSnapshot *snapshot, ColumnTag tag, ColumnView *view)
+{
+    if (snapshot == NULL || snapshot->header == NULL || view == NULL ||
+        tag < COLUMN_ID || tag > COLUMN_COUNT)
+    {
+        return false;
+    }
+
+    const ColumnDirEntry *entry = NULL;
+    for (uint32_t i = 0; i < snapshot->header->column_count; i++)
+    {
+        if (snapshot->directory[i].tag == (uint32_t)tag)
+        {
+            entry = &snapshot->directory[i];
+            break;
+        }
+    }
+    if (entry == NULL)
+    {
+        return false;
+    }
+
+    uint32_t count = snapshot->header->contact_count;
+    const uint8_t *body = snapshot->map.data + entry->offset;
+    if (!snapshot->verified[tag])
+    {
+        if (!verify_column(entry, body, count))
+        {
+            printf("COLUMNAR ERROR: CHECKSUM FAILED for column %d\n", (int)tag);
+            return false;
+        }
+        snapshot->verified[tag] = true;
+    }
+
+    memset(view, 0, sizeof(*view));
+    view->count = count;
+    if (tag == COLUMN_ID)
+    {
+        view->ids = (const int32_t *)body;
+    }
+    else
+    {
+        view->offsets = (const uint32_t *)body;
+        view->bytes = (const char *)body + (size_t)(count + 1) * sizeof(uint32_t);
+    }
+    return true;
+}
+
+const char *contact_columnar_value(const ColumnView *view, uint32_t position, uint32_t *length)
+{
+    if (view == NULL || view->offsets == NULL || position >= view->count)
+    {
+        return NULL;
+    }
+
+    if (length != NULL)
+    {
+        *length = view->offsets[position + 1] - view->offsets[position];
+    }
+    return view->bytes + view->offsets[position];
+}
+
+int contact_columnar_scan(ColumnarSnapshot *snapshot, ColumnTag tag,
+                          ColumnScanFn callback, void *context)
+{
+    ColumnView view;
+    if (callback == NULL || tag == COLUMN_ID ||
+        !contact_columnar_column(snapshot, tag, &view))
+    {
+        return -1;
+    }
+
+    int visited = 0;
+    for (uint32_t i = 0; i < view.count; i++)
+    {
+        visited++;
+        if (!callback(i, view.bytes + view.offsets[i], view.offsets[i + 1] - view.offsets[i], context))
+        {
+            break;
+        }
+    }
+    return visited;
+}
+
+typedef struct
+{
+    const char *domain;
+    size_t domain_length;
+    int matches;
+} DomainCount;
+
+static bool count_domain_value(uint32_t position, const char *value, uint32_t length, void *context)
+{
+    (void)position;
+    DomainCount *count = (DomainCount *)context;
+
+    // Domain = everything after the last '@'
+    uint32_t at = length;
+    while (at > 0 && value[at - 1] != '@')
+    {
+        at--;
+    }
+    if (at == 0 || length - at != count->domain_length)
+    {
+        return true;
+    }
+
+    for (size_t k = 0; k < count->domain_length; k++)
+    {
+        if (tolower((unsigned char)value[at + k]) != tolower((unsigned char)count->domain[k]))
+        {
+            return true;
+        }
+    }
+    count->matches++;
+    return true;
+}
+
+int contact_columnar_count_domain(ColumnarSnapshot *snapshot, const char *domain)
+{
+    if (domain == NULL)
+    {
+        return -1;
+    }
+
+    DomainCount count = {domain, strlen(domain), 0};
+    if (contact_columnar_scan(snapshot, COLUMN_EMAIL, count_domain_value, &count) < 0)
+    {
+        return -1;
+    }
+    return count.matches;
+}
+
+// Copies a column value into a fixed Contact field, truncating like strncpy
+static void copy_value(char *out, size_t capacity, const ColumnView *view, uint32_t position)
+{
+    uint32_t length = 0;
+    const char *value = contact_columnar_value(view, position, &length);
+    if (length >= capacity)
+    {
+        length = (uint32_t)capacity - 1;
+    }
+    memcpy(out, value, length);
+    out[length] = '\0';
+}
+
+bool contact_columnar_load(ContactList *list, const char *filename)
+{
+    if (list == NULL || filename == NULL)
+    {
+        printf("COLUMNAR ERROR: NULL parameters\n");
+        return false;
+    }
+
+    ColumnarSnapshot snapshot;
+    if (!contact_columnar_open(&snapshot, filename))
+    {
+        return false;
+    }
+
+    ColumnView ids, names, phones, emails;
+    bool success = contact_columnar_column(&snapshot, COLUMN_ID, &ids) &&
+                   contact_columnar_column(&snapshot, COLUMN_NAME, &names) &&
+                   contact_columnar_column(&snapshot, COLUMN_PHONE, &phones) &&
+                   contact_columnar_column(&snapshot, COLUMN_EMAIL, &emails) &&
+                   contact_list_ensure_capacity(list, list->size + (int)ids.count);
+
+    if (success)
+    {
+        for (uint32_t i = 0; i < ids.count; i++)
+        {
+            Contact *contact = &list->data[list->size + (int)i];
+            memset(contact, 0, sizeof(*contact));
+            contact->id = ids.ids[i];
+            copy_value(contact->name, sizeof(contact->name), &names, i);
+            copy_value(contact->phone, sizeof(contact->phone), &phones, i);
+            copy_value(contact->email, sizeof(contact->email), &emails, i);
+        }
+        contact_list_commit_slots(list, (int)ids.count);
+
+        // Never hand out an id the loaded contacts already use
+        if (next_contact_id < (int)snapshot.header->next_contact_id)
+        {
+            next_contact_id = (int)snapshot.header->next_contact_id;
+        }
+        printf("COLUMNAR: Loaded %u contacts from '%s'\n", ids.count, filename);
+    }
+
+    contact_columnar_close(&snapshot);
+    return success;
+}
+
+bool contact_columnar_is_col(const char *path)
+{
+    if (path == NULL)
+    {
+        return false;
+    }
+    size_t length = strlen(path);
+    return length >= 4 && path[length - 4] == '.' &&
+           tolower((unsigned char)path[length - 3]) == 'c' &&
+           tolower((unsigned char)path[length - 2]) == 'o' &&
+           tolower((unsigned char)path[length - 1]) == 'l';
+}
@@ -0,0 +1,116 @@
+#ifndef CONTACT_COLUMNAR_H
+#define CONTACT_COLUMNAR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "contact_dynamic.h"
+#include "file_io.h"
+
+// Column-oriented snapshot. Instead of one 323-byte record per contact the
+// file holds one block per field, so a scan over phones or emails touches
+// only that block of the memory map.
+//
+// Layout:
+//   ColumnarHeader
+//   per column: ColumnBlockHeader + body (padded to 4 bytes)
+//       COLUMN_ID:        int32_t id[count]
+//       string columns:   uint32_t offset[count + 1], then the bytes (no NULs)
+//   ColumnDirEntry[column_count]   - where each block lives
+//   ColumnarFooter                 - where the directory lives
+
+#define COLUMNAR_MAGIC 0x4C524243 // "LRBC"
+#define COLUMNAR_VERSION 1
+#define COLUMNAR_DEFAULT_FILE "contacts.col"
+
+typedef enum
+{
+    COLUMN_ID = 1,
+    COLUMN_NAME,
+    COLUMN_PHONE,
+    COLUMN_EMAIL,
+    COLUMN_COUNT = COLUMN_EMAIL // number of columns written
+} ColumnTag;
+
+typedef struct
+{
+    uint32_t magic;   // "LRBC"
+    uint32_t version; // 1
+    uint32_t header_checksum;
+    uint32_t contact_count;
+    uint32_t next_contact_id;
+    uint32_t column_count;
+    time_t timestamp;
+} ColumnarHeader;
+
+typedef struct
+{
+    uint32_t tag;      // ColumnTag
+    uint32_t length;   // body bytes, without padding
+    uint32_t checksum; // fletcher32 of the body
+    uint32_t reserved;
+} ColumnBlockHeader;
+
+typedef struct
+{
+    uint32_t tag;
+    uint32_t offset; // of the body, from the start of the file
+    uint32_t length;
+    uint32_t checksum;
+} ColumnDirEntry;
+
+typedef struct
+{
+    uint32_t directory_offset;
+    uint32_t directory_checksum;
+    uint32_t magic; // "TRBL"
+    uint32_t reserved;
+} ColumnarFooter;
+
+typedef struct
+{
+    FileMap map;
+    const ColumnarHeader *header;
+    const ColumnDirEntry *directory;
+    bool verified[COLUMN_COUNT + 1]; // block checksum already checked
+} ColumnarSnapshot;
+
+// One column, pointing straight into the map
+typedef struct
+{
+    uint32_t count;
+    const int32_t *ids;       // COLUMN_ID only
+    const uint32_t *offsets;  // string columns only
+    const char *bytes;
+} ColumnView;
+
+// Called per value; return false to stop the scan
+typedef bool (*ColumnScanFn)(uint32_t position, const char *value, uint32_t length, void *context);
+
+// Writes 'list' as a columnar snapshot (temp file + atomic replace).
+bool contact_columnar_save(const ContactList *list, const char *filename);
+
+// Maps the file and checks header, footer and directory. Column bodies are
+// verified the first time they are used.
+bool contact_columnar_open(ColumnarSnapshot *snapshot, const char *filename);
+void contact_columnar_close(ColumnarSnapshot *snapshot);
+
+bool contact_columnar_column(ColumnarSnapshot *snapshot, ColumnTag tag, ColumnView *view);
+
+// Value 'position' of a string column (not NUL-terminated).
+const char *contact_columnar_value(const ColumnView *view, uint32_t position, uint32_t *length);
+
+// Visits every value of one string column. Returns the number visited, or -1.
+int contact_columnar_scan(ColumnarSnapshot *snapshot, ColumnTag tag,
+                          ColumnScanFn callback, void *context);
+
+// Number of emails at 'domain' (case-insensitive) - reads the email column only.
+int contact_columnar_count_domain(ColumnarSnapshot *snapshot, const char *domain);
+
+// Appends every contact of the file to 'list' (all columns).
+bool contact_columnar_load(ContactList *list, const char *filename);
+
+// True for *.col file names.
+bool contact_columnar_is_col(const char *path);
+
+#endif
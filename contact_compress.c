@@ -0,0 +1,673 @@
+#include "contact_compress.h"
+#include "contact_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 12
+#define LZ_NO_POSITION UINT32_MAX
+#define PHONE_ESCAPE 0xF
+
+// ============================================================================
+// BYTE BUFFER
+// ============================================================================
+
+typedef struct
+{
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    bool failed; // sticky - check once at the end
+} ByteBuffer;
+
+static void buffer_put(ByteBuffer *buffer, const void *bytes, size_t length)
+{
+    if (buffer->failed)
+        return;
+
+    if (buffer->size + length > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+        while (capacity < buffer->size + length)
+            capacity *= 2;
+
+        uint8_t *grown = realloc(buffer->data, capacity);
+        if (grown == NULL)
+        {
+            buffer->failed = true;
+            return;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(buffer->data + buffer->size, bytes, length);
+    buffer->size += length;
+}
+
+static void buffer_byte(ByteBuffer *buffer, uint8_t value)
+{
+    buffer_put(buffer, &value, 1);
+}
+
+static void buffer_varint(ByteBuffer *buffer, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer_byte(buffer, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    buffer_byte(buffer, (uint8_t)value);
+}
+
+static void buffer_u32(ByteBuffer *buffer, uint32_t value)
+{
+    buffer_put(buffer, &value, sizeof(value));
+}
+
+// Bounds-checked cursor over a decoded model stream
+typedef struct
+{
+    const uint8_t *at;
+    const uint8_t *end;
+    bool failed;
+} ByteReader;
+
+static uint32_t reader_varint(ByteReader *reader)
+{
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (reader->at >= reader->end)
+            break;
+        uint8_t byte = *reader->at++;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    reader->failed = true;
+    return 0;
+}
+
+static const uint8_t *reader_bytes(ByteReader *reader, size_t length)
+{
+    if (reader->failed || (size_t)(reader->end - reader->at) < length)
+    {
+        reader->failed = true;
+        return NULL;
+    }
+    const uint8_t *bytes = reader->at;
+    reader->at += length;
+    return bytes;
+}
+
+// ============================================================================
+// FIELD CODING
+// ============================================================================
+
+static int phone_code(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+
+    switch (c)
+    {
+    case '+':
+        return 0xA;
+    case '-':
+        return 0xB;
+    case ' ':
+        return 0xC;
+    case '(':
+        return 0xD;
+    case ')':
+        return 0xE;
+    default:
+        return PHONE_ESCAPE;
+    }
+}
+
+static void encode_phone(ByteBuffer *buffer, const char *phone)
+{
+    uint8_t nibbles[3 * MAX_PHONE_LEN];
+    uint32_t count = 0;
+
+    for (const char *c = phone; *c; c++)
+    {
+        int code = phone_code(*c);
+        nibbles[count++] = (uint8_t)code;
+        if (code == PHONE_ESCAPE)
+        {
+            nibbles[count++] = (uint8_t)((unsigned char)*c >> 4);
+            nibbles[count++] = (uint8_t)(*c & 0xF);
+        }
+    }
+
+    buffer_varint(buffer, count);
+    for (uint32_t i = 0; i < count; i += 2)
+    {
+        uint8_t low = (i + 1 < count) ? nibbles[i + 1] : 0;
+        buffer_byte(buffer, (uint8_t)(nibbles[i] << 4 | low));
+    }
+}
+
+static uint8_t nibble_at(const uint8_t *packed, uint32_t i)
+{
+    return (i % 2 == 0) ? packed[i / 2] >> 4 : packed[i / 2] & 0xF;
+}
+
+static bool decode_phone(ByteReader *reader, char phone[MAX_PHONE_LEN])
+{
+    static const char symbols[] = "0123456789+- ()";
+    uint32_t count = reader_varint(reader);
+    if (count > 3 * MAX_PHONE_LEN)
+        return false;
+
+    const uint8_t *packed = reader_bytes(reader, (count + 1) / 2);
+    if (packed == NULL)
+        return false;
+
+    int length = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t code = nibble_at(packed, i);
+        char c = symbols[code < PHONE_ESCAPE ? code : 0];
+        if (code == PHONE_ESCAPE)
+        {
+            if (i + 2 >= count)
+                return false;
+            c = (char)(nibble_at(packed, i + 1) << 4 | nibble_at(packed, i + 2));
+            i += 2;
+        }
+
+        if (length >= MAX_PHONE_LEN - 1)
+            return false;
+        phone[length++] = c;
+    }
+    phone[length] = '\0';
+    return true;
+}
+
+// Domain = text after the last '@'; NULL if there is none
+static const char *email_domain(const char *email)
+{
+    const char *at = strrchr(email, '@');
+    return (at != NULL && at[1] != '\0') ? at + 1 : NULL;
+}
+
+static int compare_strings(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+// Sorted, de-duplicated domains of every email (pointers into 'list')
+static const char **build_domains(const ContactList *list, uint32_t *count_out)
+{
+    const char **domains = malloc((list->size > 0 ? list->size : 1) * sizeof(char *));
+    if (domains == NULL)
+        return NULL;
+
+    uint32_t count = 0;
+    for (int i = 0; i < list->size; i++)
+    {
+        const char *domain = email_domain(list->data[i].email);
+        if (domain != NULL)
+            domains[count++] = domain;
+    }
+    qsort(domains, count, sizeof(char *), compare_strings);
+
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (unique == 0 || strcmp(domains[unique - 1], domains[i]) != 0)
+            domains[unique++] = domains[i];
+    }
+
+    *count_out = unique;
+    return domains;
+}
+
+static const Contact *sort_base; // qsort has no context argument
+
+static int compare_position_by_name(const void *a, const void *b)
+{
+    uint32_t pos_a = *(const uint32_t *)a;
+    uint32_t pos_b = *(const uint32_t *)b;
+    int order = strcmp(sort_base[pos_a].name, sort_base[pos_b].name);
+    if (order != 0)
+        return order;
+    return (pos_a > pos_b) - (pos_a < pos_b);
+}
+
+static bool build_model(const ContactList *list, ByteBuffer *model)
+{
+    uint32_t domain_count = 0;
+    const char **domains = build_domains(list, &domain_count);
+    uint32_t *order = malloc((list->size > 0 ? list->size : 1) * sizeof(uint32_t));
+    if (domains == NULL || order == NULL)
+    {
+        free(domains);
+        free(order);
+        return false;
+    }
+
+    // === Dictionary ===
+    buffer_varint(model, domain_count);
+    for (uint32_t d = 0; d < domain_count; d++)
+    {
+        size_t length = strlen(domains[d]);
+        buffer_varint(model, (uint32_t)length);
+        buffer_put(model, domains[d], length);
+    }
+
+    // === Records in name order (front coding needs sorted neighbours) ===
+    for (int i = 0; i < list->size; i++)
+        order[i] = (uint32_t)i;
+    sort_base = list->data;
+    qsort(order, list->size, sizeof(uint32_t), compare_position_by_name);
+
+    const char *previous_name = "";
+    for (int k = 0; k < list->size; k++)
+    {
+        const Contact *contact = &list->data[order[k]];
+        buffer_varint(model, order[k]);
+        buffer_varint(model, (uint32_t)contact->id);
+
+        size_t shared = 0;
+        while (previous_name[shared] != '\0' && previous_name[shared] == contact->name[shared])
+            shared++;
+        size_t suffix = strlen(contact->name + shared);
+        buffer_varint(model, (uint32_t)shared);
+        buffer_varint(model, (uint32_t)suffix);
+        buffer_put(model, contact->name + shared, suffix);
+        previous_name = contact->name;
+
+        encode_phone(model, contact->phone);
+
+        const char *domain = email_domain(contact->email);
+        uint32_t reference = 0;
+        size_t local = strlen(contact->email);
+        if (domain != NULL)
+        {
+            const char **found = bsearch(&domain, domains, domain_count, sizeof(char *), compare_strings);
+            reference = (uint32_t)(found - domains) + 1;
+            local = (size_t)(domain - 1 - contact->email);
+        }
+        buffer_varint(model, reference);
+        buffer_varint(model, (uint32_t)local);
+        buffer_put(model, contact->email, local);
+    }
+
+    free(domains);
+    free(order);
+    return !model->failed;
+}
+
+// ============================================================================
+// LZ BLOCK CODEC
+// ============================================================================
+
+static uint32_t lz_hash(const uint8_t *bytes)
+{
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// Writes a 15 + 255 + 255 + ... length extension
+static bool lz_put_length(uint8_t *out, uint32_t *used, uint32_t capacity, uint32_t length)
+{
+    while (length >= 255)
+    {
+        if (*used >= capacity)
+            return false;
+        out[(*used)++] = 255;
+        length -= 255;
+    }
+    if (*used >= capacity)
+        return false;
+    out[(*used)++] = (uint8_t)length;
+    return true;
+}
+
+// One sequence: literals, then (unless last) a back-reference
+static bool lz_put_sequence(uint8_t *out, uint32_t *used, uint32_t capacity,
+                            const uint8_t *literals, uint32_t literal_count,
+                            uint32_t offset, uint32_t match_length)
+{
+    uint32_t match_code = match_length ? match_length - LZ_MIN_MATCH : 0;
+    if (*used >= capacity)
+        return false;
+    out[(*used)++] = (uint8_t)((literal_count < 15 ? literal_count : 15) << 4 |
+                               (match_code < 15 ? match_code : 15));
+
+    if (literal_count >= 15 && !lz_put_length(out, used, capacity, literal_count - 15))
+        return false;
+    if (capacity - *used < literal_count)
+        return false;
+    memcpy(out + *used, literals, literal_count);
+    *used += literal_count;
+
+    if (match_length == 0)
+        return true; // final literals-only sequence
+
+    if (capacity - *used < 2)
+        return false;
+    out[(*used)++] = (uint8_t)(offset & 0xFF);
+    out[(*used)++] = (uint8_t)(offset >> 8);
+    return match_code < 15 || lz_put_length(out, used, capacity, match_code - 15);
+}
+
+uint32_t contact_lz_compress(const uint8_t *in, uint32_t in_size, uint8_t *out)
+{
+    uint32_t table[1 << LZ_HASH_BITS];
+    memset(table, 0xFF, sizeof(table)); // LZ_NO_POSITION
+
+    uint32_t capacity = in_size; // not smaller = not worth it
+    uint32_t used = 0;
+    uint32_t anchor = 0;
+    uint32_t i = 0;
+
+    while (i + LZ_MIN_MATCH <= in_size)
+    {
+        uint32_t hash = lz_hash(in + i);
+        uint32_t candidate = table[hash];
+        table[hash] = i;
+
+        if (candidate == LZ_NO_POSITION || i - candidate > 0xFFFF ||
+            memcmp(in + candidate, in + i, LZ_MIN_MATCH) != 0)
+        {
+            i++;
+            continue;
+        }
+
+        uint32_t length = LZ_MIN_MATCH;
+        while (i + length < in_size && in[candidate + length] == in[i + length])
+            length++;
+
+        if (!lz_put_sequence(out, &used, capacity, in + anchor, i - anchor, i - candidate, length))
+            return 0;
+        i += length;
+        anchor = i;
+    }
+
+    if (!lz_put_sequence(out, &used, capacity, in + anchor, in_size - anchor, 0, 0) ||
+        used >= in_size)
+    {
+        return 0;
+    }
+    return used;
+}
+
+static bool lz_get_length(const uint8_t *in, uint32_t in_size, uint32_t *i, uint32_t *length)
+{
+    uint8_t byte;
+    do
+    {
+        if (*i >= in_size)
+            return false;
+        byte = in[(*i)++];
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+bool contact_lz_decompress(const uint8_t *in, uint32_t in_size, uint8_t *out, uint32_t out_size)
+{
+    uint32_t i = 0;
+    uint32_t o = 0;
+
+    while (i < in_size)
+    {
+        uint8_t token = in[i++];
+
+        uint32_t literal_count = token >> 4;
+        if (literal_count == 15 && !lz_get_length(in, in_size, &i, &literal_count))
+            return false;
+        if (literal_count > in_size - i || literal_count > out_size - o)
+            return false;
+        memcpy(out + o, in + i, literal_count);
+        i += literal_count;
+        o += literal_count;
+
+        if (i == in_size)
+            break; // last sequence has no match
+
+        if (in_size - i < 2)
+            return false;
+        uint32_t offset = (uint32_t)in[i] | (uint32_t)in[i + 1] << 8;
+        i += 2;
+        if (offset == 0 || offset > o)
+            return false;
+
+        uint32_t length = token & 0xF;
+        if (length == 15 && !lz_get_length(in, in_size, &i, &length))
+            return false;
+        length += LZ_MIN_MATCH;
+        if (length > out_size - o)
+            return false;
+
+        // Byte by byte: source and destination may overlap (runs)
+        for (uint32_t k = 0; k < length; k++, o++)
+            out[o] = out[o - offset];
+    }
+
+    return o == out_size;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+bool contact_compress_encode(const ContactList *list, uint8_t **payload_out, uint32_t *size_out)
+{
+    if (list == NULL || payload_out == NULL || size_out == NULL)
+    {
+        return false;
+    }
+
+    ByteBuffer model = {0};
+    ByteBuffer payload = {0};
+    uint8_t *scratch = malloc(COMPRESS_BLOCK_SIZE);
+    bool success = false;
+
+    if (scratch == NULL || !build_model(list, &model))
+    {
+        printf("COMPRESS ERROR: Out of memory while encoding %d contacts\n", list->size);
+        goto cleanup;
+    }
+
+    uint32_t block_count = (uint32_t)((model.size + COMPRESS_BLOCK_SIZE - 1) / COMPRESS_BLOCK_SIZE);
+    buffer_u32(&payload, (uint32_t)model.size);
+    buffer_u32(&payload, block_count);
+
+    for (size_t start = 0; start < model.size; start += COMPRESS_BLOCK_SIZE)
+    {
+        uint32_t raw_size = (uint32_t)(model.size - start < COMPRESS_BLOCK_SIZE ? model.size - start
+                                                                                : COMPRESS_BLOCK_SIZE);
+        uint32_t stored_size = contact_lz_compress(model.data + start, raw_size, scratch);
+        const uint8_t *stored = scratch;
+        if (stored_size == 0)
+        {
+            stored_size = raw_size; // incompressible - store as is
+            stored = model.data + start;
+        }
+
+        buffer_u32(&payload, raw_size);
+        buffer_u32(&payload, stored_size);
+        buffer_u32(&payload, fletcher32(stored, stored_size));
+        buffer_put(&payload, stored, stored_size);
+    }
+
+    if (payload.failed)
+    {
+        printf("COMPRESS ERROR: Out of memory while encoding %d contacts\n", list->size);
+        goto cleanup;
+    }
+
+    *payload_out = payload.data;
+    *size_out = (uint32_t)payload.size;
+    payload.data = NULL;
+    success = true;
+
+cleanup:
+    free(model.data);
+    free(payload.data);
+    free(scratch);
+    return success;
+}
+
+static bool decode_records(ByteReader *reader, uint32_t count, ContactList *list)
+{
+    // === Dictionary (points into the model) ===
+    uint32_t domain_count = reader_varint(reader);
+    if (reader->failed || domain_count > count)
+        return false;
+
+    const uint8_t **domains = malloc((domain_count > 0 ? domain_count : 1) * sizeof(uint8_t *));
+    uint32_t *domain_lengths = malloc((domain_count > 0 ? domain_count : 1) * sizeof(uint32_t));
+    bool success = domains != NULL && domain_lengths != NULL;
+
+    for (uint32_t d = 0; success && d < domain_count; d++)
+    {
+        domain_lengths[d] = reader_varint(reader);
+        domains[d] = reader_bytes(reader, domain_lengths[d]);
+        success = domains[d] != NULL && domain_lengths[d] < MAX_EMAIL_LEN;
+    }
+
+    // === Records, written back to their original positions ===
+    memset(list->data, 0, count * sizeof(Contact));
+    const char *previous_name = "";
+    for (uint32_t k = 0; success && k < count; k++)
+    {
+        uint32_t position = reader_varint(reader);
+        uint32_t id = reader_varint(reader);
+        if (reader->failed || position >= count)
+        {
+            success = false;
+            break;
+        }
+        Contact *contact = &list->data[position];
+        contact->id = (int)id;
+
+        uint32_t shared = reader_varint(reader);
+        uint32_t suffix = reader_varint(reader);
+        const uint8_t *suffix_bytes = reader_bytes(reader, suffix);
+        if (suffix_bytes == NULL || shared > strlen(previous_name) ||
+            (size_t)shared + suffix >= MAX_NAME_LEN)
+        {
+            success = false;
+            break;
+        }
+        memcpy(contact->name, previous_name, shared);
+        memcpy(contact->name + shared, suffix_bytes, suffix);
+        contact->name[shared + suffix] = '\0';
+        previous_name = contact->name;
+
+        if (!decode_phone(reader, contact->phone))
+        {
+            success = false;
+            break;
+        }
+
+        uint32_t reference = reader_varint(reader);
+        uint32_t local = reader_varint(reader);
+        const uint8_t *local_bytes = reader_bytes(reader, local);
+        size_t domain_length = (reference > 0 && reference <= domain_count) ? domain_lengths[reference - 1] + 1 : 0;
+        if (local_bytes == NULL || reference > domain_count ||
+            (size_t)local + domain_length >= MAX_EMAIL_LEN)
+        {
+            success = false;
+            break;
+        }
+        memcpy(contact->email, local_bytes, local);
+        if (reference > 0)
+        {
+            contact->email[local] = '@';
+            memcpy(contact->email + local + 1, domains[reference - 1], domain_lengths[reference - 1]);
+        }
+        contact->email[local + domain_length] = '\0';
+    }
+
+    free(domains);
+    free(domain_lengths);
+    return success && !reader->failed;
+}
+
+bool contact_compress_decode(const uint8_t *payload, uint32_t size, uint32_t count,
+                             ContactList *list)
+{
+    if (payload == NULL || list == NULL || list->capacity < (int)count)
+    {
+        return false;
+    }
+
+    ByteReader blocks = {payload, payload + size, false};
+    uint32_t model_size = 0;
+    uint32_t block_count = 0;
+    const uint8_t *fields = reader_bytes(&blocks, 2 * sizeof(uint32_t));
+    if (fields == NULL)
+    {
+        printf("COMPRESS ERROR: Payload too short\n");
+        return false;
+    }
+    memcpy(&model_size, fields, sizeof(uint32_t));
+    memcpy(&block_count, fields + sizeof(uint32_t), sizeof(uint32_t));
+
+    uint8_t *model = malloc(model_size > 0 ? model_size : 1);
+    if (model == NULL)
+    {
+        printf("COMPRESS ERROR: Out of memory for %u byte model\n", model_size);
+        return false;
+    }
+
+    // === STEP 1: Blocks -> model, checking each as it streams past ===
+    uint32_t filled = 0;
+    bool success = true;
+    for (uint32_t b = 0; success && b < block_count; b++)
+    {
+        uint32_t block[3]; // raw_size, stored_size, checksum
+        const uint8_t *block_header = reader_bytes(&blocks, sizeof(block));
+        if (block_header == NULL)
+        {
+            success = false;
+            break;
+        }
+        memcpy(block, block_header, sizeof(block));
+
+        const uint8_t *stored = reader_bytes(&blocks, block[1]);
+        if (stored == NULL || block[0] > model_size - filled || block[1] > block[0] ||
+            fletcher32(stored, block[1]) != block[2])
+        {
+            printf("COMPRESS ERROR: Block %u is damaged\n", b);
+            success = false;
+            break;
+        }
+
+        if (block[1] == block[0])
+            memcpy(model + filled, stored, block[0]);
+        else
+            success = contact_lz_decompress(stored, block[1], model + filled, block[0]);
+        filled += block[0];
+    }
+    success = success && filled == model_size;
+
+    // === STEP 2: Model -> records ===
+    if (success)
+    {
+        ByteReader reader = {model, model + model_size, false};
+        success = decode_records(&reader, count, list);
+    }
+
+    if (success)
+    {
+        list->size = (int)count;
+    }
+    else
+    {
+        printf("COMPRESS ERROR: Cannot decode compressed snapshot\n");
+    }
+    free(model);
+    return success;
+}
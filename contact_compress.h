@@ -0,0 +1,37 @@
+#ifndef CONTACT_COMPRESS_H
+#define CONTACT_COMPRESS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "contact_dynamic.h"
+
+// Codec for compressed (version 2) snapshots. The list is first turned into
+// a compact "model" stream, which is then LZ-compressed in blocks:
+//
+//   model:  varint domain_count, domains (varint length + bytes, sorted)
+//           per record, in name order:
+//             varint original position, varint id
+//             name:  varint shared prefix with previous name, varint suffix length, suffix
+//             phone: varint nibble count, 4-bit codes (0-9, + - space ( ), 0xF = raw byte)
+//             email: varint domain number (0 = no domain), varint local length, local part
+//
+//   payload: uint32_t model_size, uint32_t block_count, then per block
+//            uint32_t raw_size, uint32_t stored_size, uint32_t checksum, bytes
+//            (stored_size == raw_size means the block is stored uncompressed)
+
+#define COMPRESS_BLOCK_SIZE 65536
+
+// Encodes 'list'. On success *payload_out is malloc'd (caller frees).
+bool contact_compress_encode(const ContactList *list, uint8_t **payload_out, uint32_t *size_out);
+
+// Decodes 'count' records into list->data (capacity must be >= count) in
+// their original order and sets list->size.
+bool contact_compress_decode(const uint8_t *payload, uint32_t size, uint32_t count,
+                             ContactList *list);
+
+// LZ77 block codec (LZ4-style sequences, 64 KB window).
+// Returns the compressed size, or 0 if the block does not get smaller.
+uint32_t contact_lz_compress(const uint8_t *in, uint32_t in_size, uint8_t *out);
+bool contact_lz_decompress(const uint8_t *in, uint32_t in_size, uint8_t *out, uint32_t out_size);
+
+#endif
@@ -0,0 +1,604 @@
+#include "contact_csv.h"
+#include "file_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+typedef enum
+{
+    ROLE_NONE,
+    ROLE_NAME,
+    ROLE_PHONE,
+    ROLE_EMAIL
+} ColumnRole;
+
+// Where one column of the current record goes
+typedef struct
+{
+    char *text;      // NULL = column is skipped
+    size_t capacity; // including the NUL
+    size_t length;
+    bool overflow;
+} FieldSink;
+
+typedef struct
+{
+    FILE *file;
+    char *buffer;
+    size_t filled;   // valid bytes in buffer
+    size_t position; // start of the next unparsed record
+    size_t record_start; // of the record last returned
+    bool at_eof;
+    long line; // line the next record starts on
+    long long bytes;
+} CsvReader;
+
+// ============================================================================
+// SCANNING
+// ============================================================================
+
+// First byte in [p, end) that ends an unquoted run: the delimiter, a quote,
+// CR or LF. Returns 'end' if there is none.
+static const char *find_special(const char *p, const char *end, char delimiter)
+{
+#ifdef __SSE2__
+    // 16 bytes per step; most fields end within the first one or two
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+    const __m128i quotes = _mm_set1_epi8('"');
+    const __m128i returns = _mm_set1_epi8('\r');
+    const __m128i newlines = _mm_set1_epi8('\n');
+    while (end - p >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, delimiters),
+                                                 _mm_cmpeq_epi8(chunk, quotes)),
+                                    _mm_or_si128(_mm_cmpeq_epi8(chunk, returns),
+                                                 _mm_cmpeq_epi8(chunk, newlines)));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0)
+        {
+            return p + __builtin_ctz((unsigned)mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != delimiter && *p != '"' && *p != '\r' && *p != '\n')
+    {
+        p++;
+    }
+    return p;
+}
+
+static long count_newlines(const char *p, const char *end)
+{
+    long count = 0;
+    while ((p = memchr(p, '\n', (size_t)(end - p))) != NULL)
+    {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+static void field_append(FieldSink *field, const char *bytes, size_t count)
+{
+    if (field->text == NULL)
+    {
+        return;
+    }
+    if (field->length + count >= field->capacity)
+    {
+        field->overflow = true;
+        count = field->capacity - 1 - field->length;
+    }
+    memcpy(field->text + field->length, bytes, count);
+    field->length += count;
+}
+
+// Parses one record starting at 'p'. Returns the start of the next one, or
+// NULL if the record runs past 'end' and more input may follow.
+static const char *parse_record(const char *p, const char *end, bool at_eof, char delimiter,
+                                FieldSink fields[], int *column_count, long *line_breaks)
+{
+    for (int i = 0; i < CSV_MAX_COLUMNS; i++)
+    {
+        fields[i].length = 0;
+        fields[i].overflow = false;
+    }
+
+    int column = 0;
+    long breaks = 0;
+    for (;;)
+    {
+        FieldSink discard = {0};
+        FieldSink *field = (column < CSV_MAX_COLUMNS) ? &fields[column] : &discard;
+        const char *q;
+
+        // === Quoted part: "" is a literal quote, delimiters and newlines are data ===
+        if (p < end && *p == '"')
+        {
+            p++;
+            for (;;)
+            {
+                q = memchr(p, '"', (size_t)(end - p));
+                if (q == NULL)
+                {
+                    if (!at_eof)
+                        return NULL;
+                    q = end; // unterminated at end of file - keep what is there
+                }
+                breaks += count_newlines(p, q);
+                field_append(field, p, (size_t)(q - p));
+                if (q == end)
+                {
+                    p = end;
+                    break;
+                }
+                if (q + 1 == end && !at_eof)
+                {
+                    return NULL; // cannot tell "" from a closing quote yet
+                }
+                if (q + 1 < end && q[1] == '"')
+                {
+                    field_append(field, q, 1);
+                    p = q + 2;
+                    continue;
+                }
+                p = q + 1;
+                break;
+            }
+        }
+
+        // === Unquoted part (stray quotes in it are kept as they are) ===
+        for (;;)
+        {
+            q = find_special(p, end, delimiter);
+            field_append(field, p, (size_t)(q - p));
+            p = q;
+            if (p < end && *p == '"')
+            {
+                field_append(field, p, 1);
+                p++;
+                continue;
+            }
+            break;
+        }
+
+        column++;
+        if (p == end)
+        {
+            if (!at_eof)
+                return NULL;
+            break; // last record without a line break
+        }
+        if (*p == delimiter)
+        {
+            p++;
+            continue;
+        }
+
+        // CR, LF or CRLF ends the record
+        if (*p == '\r')
+        {
+            if (p + 1 == end && !at_eof)
+                return NULL;
+            p++;
+            if (p < end && *p == '\n')
+                p++;
+        }
+        else
+        {
+            p++;
+        }
+        breaks++;
+        break;
+    }
+
+    for (int i = 0; i < CSV_MAX_COLUMNS; i++)
+    {
+        if (fields[i].text != NULL)
+            fields[i].text[fields[i].length] = '\0';
+    }
+    *column_count = column;
+    *line_breaks = breaks;
+    return p;
+}
+
+// Moves the unparsed tail to the front of the buffer and reads more
+static bool refill(CsvReader *reader)
+{
+    size_t tail = reader->filled - reader->position;
+    memmove(reader->buffer, reader->buffer + reader->position, tail);
+    reader->filled = tail;
+    reader->position = 0;
+
+    size_t got = fread(reader->buffer + tail, 1, CSV_BUFFER_SIZE - tail, reader->file);
+    if (got == 0)
+    {
+        if (ferror(reader->file))
+        {
+            return false;
+        }
+        reader->at_eof = true;
+    }
+    reader->filled += got;
+    reader->bytes += (long long)got;
+    return true;
+}
+
+// Next record of the file into 'fields'. Returns false at end of input or
+// on error (*failed set).
+static bool next_record(CsvReader *reader, char delimiter, FieldSink fields[],
+                        int *column_count, bool *blank, bool *failed)
+{
+    *failed = false;
+    for (;;)
+    {
+        if (reader->position == reader->filled && reader->at_eof)
+        {
+            return false;
+        }
+
+        const char *start = reader->buffer + reader->position;
+        const char *end = reader->buffer + reader->filled;
+        long breaks = 0;
+        const char *next = (start == end)
+                               ? NULL
+                               : parse_record(start, end, reader->at_eof, delimiter,
+                                              fields, column_count, &breaks);
+        if (next != NULL)
+        {
+            *blank = (*start == '\r' || *start == '\n');
+            reader->record_start = reader->position;
+            reader->position = (size_t)(next - reader->buffer);
+            reader->line += breaks;
+            return true;
+        }
+
+        if (reader->position == 0 && reader->filled == CSV_BUFFER_SIZE)
+        {
+            printf("CSV ERROR: Record at line %ld is longer than %d bytes\n", reader->line, CSV_BUFFER_SIZE);
+            *failed = true;
+            return false;
+        }
+        if (!refill(reader))
+        {
+            printf("CSV ERROR: Read failed near line %ld\n", reader->line);
+            *failed = true;
+            return false;
+        }
+    }
+}
+
+// ============================================================================
+// IMPORT
+// ============================================================================
+
+static ColumnRole role_for(const char *header)
+{
+    char name[32];
+    size_t length = 0;
+
+    // Case-insensitive, ignoring surrounding spaces
+    while (isspace((unsigned char)*header))
+        header++;
+    while (*header != '\0' && length < sizeof(name) - 1)
+        name[length++] = (char)tolower((unsigned char)*header++);
+    while (length > 0 && isspace((unsigned char)name[length - 1]))
+        length--;
+    name[length] = '\0';
+
+    if (strcmp(name, "name") == 0 || strcmp(name, "full name") == 0)
+        return ROLE_NAME;
+    if (strcmp(name, "phone") == 0 || strcmp(name, "telephone") == 0 || strcmp(name, "tel") == 0)
+        return ROLE_PHONE;
+    if (strcmp(name, "email") == 0 || strcmp(name, "e-mail") == 0)
+        return ROLE_EMAIL;
+    return ROLE_NONE;
+}
+
+// Points each column's sink at its field of 'contact'
+static void bind_fields(FieldSink fields[], const ColumnRole roles[], Contact *contact)
+{
+    for (int i = 0; i < CSV_MAX_COLUMNS; i++)
+    {
+        switch (roles[i])
+        {
+        case ROLE_NAME:
+            fields[i].text = contact->name;
+            fields[i].capacity = MAX_NAME_LEN;
+            break;
+        case ROLE_PHONE:
+            fields[i].text = contact->phone;
+            fields[i].capacity = MAX_PHONE_LEN;
+            break;
+        case ROLE_EMAIL:
+            fields[i].text = contact->email;
+            fields[i].capacity = MAX_EMAIL_LEN;
+            break;
+        default:
+            fields[i].text = NULL;
+            fields[i].capacity = 0;
+            break;
+        }
+    }
+}
+
+static const char *reject_reason(const Contact *contact, const FieldSink fields[])
+{
+    for (int i = 0; i < CSV_MAX_COLUMNS; i++)
+    {
+        if (fields[i].overflow)
+            return "field too long";
+    }
+    if (!contact_validate_name(contact->name))
+        return "invalid name";
+    if (!contact_validate_phone(contact->phone))
+        return "invalid phone";
+    if (!contact_validate_email(contact->email))
+        return "invalid e-mail";
+    return NULL;
+}
+
+CsvOptions contact_csv_options_for(const char *path)
+{
+    CsvOptions options = {',', true};
+    size_t length = (path != NULL) ? strlen(path) : 0;
+    if (length > 4 && (strcmp(path + length - 4, ".tsv") == 0 || strcmp(path + length - 4, ".TSV") == 0))
+    {
+        options.delimiter = '\t';
+    }
+    return options;
+}
+
+bool contact_csv_import(const char *path, const CsvOptions *options,
+                        CsvBatchFn sink, void *ctx, CsvStats *stats)
+{
+    if (path == NULL || options == NULL || sink == NULL || stats == NULL)
+    {
+        return false;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    clock_t started = clock();
+    CsvReader reader = {0};
+    Contact *batch = NULL;
+    int batched = 0;
+    bool success = false;
+    bool failed = false;
+    bool blank = false;
+    int columns = 0;
+
+    FieldSink fields[CSV_MAX_COLUMNS];
+    ColumnRole roles[CSV_MAX_COLUMNS] = {ROLE_NAME, ROLE_PHONE, ROLE_EMAIL}; // rest ROLE_NONE
+    Contact contact;
+
+    // === STEP 1: Open ===
+    reader.file = fopen(path, "rb");
+    if (reader.file == NULL)
+    {
+        printf("CSV ERROR: Cannot open '%s'\n", path);
+        return false;
+    }
+    reader.buffer = malloc(CSV_BUFFER_SIZE);
+    batch = malloc(CSV_BATCH_SIZE * sizeof(Contact));
+    if (reader.buffer == NULL || batch == NULL)
+    {
+        printf("CSV ERROR: Out of memory\n");
+        goto cleanup;
+    }
+    reader.line = 1;
+    if (!refill(&reader))
+    {
+        printf("CSV ERROR: Cannot read '%s'\n", path);
+        goto cleanup;
+    }
+    if (reader.filled >= 3 && memcmp(reader.buffer, "\xEF\xBB\xBF", 3) == 0)
+    {
+        reader.position = 3; // UTF-8 byte order mark
+    }
+
+    // === STEP 2: Header row names the columns (if it names none, it is data) ===
+    if (options->has_header)
+    {
+        char names[CSV_MAX_COLUMNS][32];
+        for (int i = 0; i < CSV_MAX_COLUMNS; i++)
+        {
+            fields[i].text = names[i];
+            fields[i].capacity = sizeof(names[i]);
+        }
+        if (!next_record(&reader, options->delimiter, fields, &columns, &blank, &failed))
+        {
+            success = !failed; // empty file
+            goto cleanup;
+        }
+
+        bool seen[ROLE_EMAIL + 1] = {false};
+        for (int i = 0; i < CSV_MAX_COLUMNS; i++)
+        {
+            roles[i] = (i < columns) ? role_for(names[i]) : ROLE_NONE;
+            if (seen[roles[i]])
+                roles[i] = ROLE_NONE; // first column of a name wins
+            seen[roles[i]] = true;
+        }
+        if (!seen[ROLE_NAME] && !seen[ROLE_PHONE] && !seen[ROLE_EMAIL])
+        {
+            roles[0] = ROLE_NAME;
+            roles[1] = ROLE_PHONE;
+            roles[2] = ROLE_EMAIL;
+            reader.position = reader.record_start;
+            reader.line = 1;
+        }
+        else if (!seen[ROLE_NAME] || !seen[ROLE_PHONE] || !seen[ROLE_EMAIL])
+        {
+            printf("CSV ERROR: Header of '%s' must have name, phone and email columns\n", path);
+            goto cleanup;
+        }
+    }
+
+    // === STEP 3: Parse, validate, hand over in batches ===
+    bind_fields(fields, roles, &contact);
+    for (;;)
+    {
+        long line = reader.line;
+        memset(&contact, 0, sizeof(contact));
+        if (!next_record(&reader, options->delimiter, fields, &columns, &blank, &failed))
+        {
+            if (failed)
+                goto cleanup;
+            break;
+        }
+        if (blank)
+        {
+            continue;
+        }
+
+        stats->rows++;
+        const char *reason = reject_reason(&contact, fields);
+        if (reason != NULL)
+        {
+            if (stats->rejected < CSV_MAX_REPORTED)
+                printf("CSV WARNING: Line %ld skipped (%s)\n", line, reason);
+            stats->rejected++;
+            continue;
+        }
+
+        contact.id = next_contact_id++;
+        batch[batched++] = contact;
+        if (batched == CSV_BATCH_SIZE)
+        {
+            if (!sink(batch, batched, ctx))
+            {
+                printf("CSV ERROR: Could not store rows before line %ld\n", reader.line);
+                goto cleanup;
+            }
+            stats->imported += batched;
+            batched = 0;
+        }
+    }
+
+    if (batched > 0)
+    {
+        if (!sink(batch, batched, ctx))
+        {
+            printf("CSV ERROR: Could not store the last %d rows\n", batched);
+            goto cleanup;
+        }
+        stats->imported += batched;
+    }
+    success = true;
+
+cleanup:
+    if (stats->rejected > CSV_MAX_REPORTED)
+    {
+        printf("CSV WARNING: %ld more rows skipped\n", stats->rejected - CSV_MAX_REPORTED);
+    }
+    stats->bytes = reader.bytes;
+    stats->seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+    fclose(reader.file);
+    free(reader.buffer);
+    free(batch);
+    return success;
+}
+
+bool contact_csv_to_list(const Contact batch[], int count, void *ctx)
+{
+    return contact_list_add_batch((ContactList *)ctx, batch, count);
+}
+
+// ============================================================================
+// EXPORT
+// ============================================================================
+
+static void write_field(FILE *file, const char *text, char delimiter)
+{
+    size_t length = strlen(text);
+    bool quote = length > 0 && (text[0] == ' ' || text[length - 1] == ' ');
+    for (size_t i = 0; !quote && i < length; i++)
+    {
+        char c = text[i];
+        quote = (c == delimiter || c == '"' || c == '\r' || c == '\n');
+    }
+
+    if (!quote)
+    {
+        fwrite(text, 1, length, file);
+        return;
+    }
+
+    putc('"', file);
+    for (size_t i = 0; i < length; i++)
+    {
+        if (text[i] == '"')
+            putc('"', file); // doubled
+        putc(text[i], file);
+    }
+    putc('"', file);
+}
+
+bool contact_csv_export(const char *path, const ContactList *list,
+                        const CsvOptions *options, CsvStats *stats)
+{
+    if (path == NULL || list == NULL || options == NULL || stats == NULL)
+    {
+        return false;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    clock_t started = clock();
+    char temp_name[512];
+    snprintf(temp_name, sizeof(temp_name), "%s.tmp", path);
+
+    FILE *file = fopen(temp_name, "wb");
+    if (file == NULL)
+    {
+        printf("CSV ERROR: Cannot create '%s'\n", temp_name);
+        return false;
+    }
+    setvbuf(file, NULL, _IOFBF, CSV_BUFFER_SIZE);
+
+    char delimiter = options->delimiter;
+    if (options->has_header)
+    {
+        fprintf(file, "id%cname%cphone%cemail\r\n", delimiter, delimiter, delimiter);
+    }
+    for (int i = 0; i < list->size; i++)
+    {
+        const Contact *contact = &list->data[i];
+        fprintf(file, "%d%c", contact->id, delimiter);
+        write_field(file, contact->name, delimiter);
+        putc(delimiter, file);
+        write_field(file, contact->phone, delimiter);
+        putc(delimiter, file);
+        write_field(file, contact->email, delimiter);
+        fputs("\r\n", file); // RFC 4180 line break
+    }
+
+    bool success = fflush(file) == 0 && !ferror(file) && file_sync(file);
+    stats->bytes = (long long)ftell(file);
+    if (fclose(file) != 0)
+    {
+        success = false;
+    }
+    if (success && !file_replace(temp_name, path))
+    {
+        printf("CSV ERROR: Cannot replace '%s'\n", path);
+        success = false;
+    }
+    if (!success)
+    {
+        printf("CSV ERROR: Export to '%s' failed\n", path);
+        remove(temp_name);
+        return false;
+    }
+
+    stats->rows = list->size;
+    stats->imported = list->size;
+    stats->seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef CONTACT_CSV_H
+#define CONTACT_CSV_H
+
+#include <stdbool.h>
+#include "contact_dynamic.h"
+
+// Streaming CSV / TSV import and export (RFC 4180 quoting).
+//
+// The reader works through a fixed CSV_BUFFER_SIZE window, so memory stays
+// the same for any file size; one record must fit in the window. Rows are
+// validated with contact_validate_*, given ids from next_contact_id and
+// handed to a sink CSV_BATCH_SIZE at a time. Invalid rows are counted and
+// skipped.
+//
+// Columns are name, phone, email unless the first row is a header, which
+// may name them in any order ("id" and unknown columns are ignored). A
+// first row that names none of them is read as data.
+
+#define CSV_BUFFER_SIZE (256 * 1024)
+#define CSV_BATCH_SIZE 4096
+#define CSV_MAX_COLUMNS 32
+#define CSV_MAX_REPORTED 5 // rejected rows printed individually
+
+typedef struct
+{
+    char delimiter;  // ',' or '\t'
+    bool has_header; // import: look for a header row; export: write one
+} CsvOptions;
+
+typedef struct
+{
+    long rows;     // data rows read (blank lines excluded)
+    long imported; // rows accepted by the sink (export: rows written)
+    long rejected; // rows that failed validation
+    long long bytes;
+    double seconds; // processor time
+} CsvStats;
+
+// Receives validated contacts. Returning false stops the import.
+typedef bool (*CsvBatchFn)(const Contact batch[], int count, void *ctx);
+
+// Default options for 'path': tab-separated for *.tsv, comma otherwise,
+// header row on.
+CsvOptions contact_csv_options_for(const char *path);
+
+bool contact_csv_import(const char *path, const CsvOptions *options,
+                        CsvBatchFn sink, void *ctx, CsvStats *stats);
+
+// Writes 'list' (id, name, phone, email) through a temp file + rename.
+bool contact_csv_export(const char *path, const ContactList *list,
+                        const CsvOptions *options, CsvStats *stats);
+
+// Sink appending to the ContactList passed as 'ctx'.
+bool contact_csv_to_list(const Contact batch[], int count, void *ctx);
+
+#endif
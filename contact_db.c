@@ -2,11 +2,392 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>   // for malloc / free
+#include <stdbool.h>
+#include <pthread.h>
+
+/* ------------------------------------------------------------------ */
+/*  Prepared statement cache                                          */
+/* ------------------------------------------------------------------ */
+// Each connection keeps one prepared copy of every statement below,
+// created on first use and finalized by db_close. A statement is checked
+// out while a caller steps it; if another thread already holds it, the
+// caller gets a private one that is finalized on release.
+typedef enum {
+    DB_STMT_INSERT,
+    DB_STMT_LOAD_ALL,
+    DB_STMT_COUNT_ALL,
+    DB_STMT_SEARCH_NAME,
+    DB_STMT_SEARCH_EMAIL,
+    DB_STMT_SEARCH_PHONE,
+    DB_STMT_SEARCH_DIGITS,
+    DB_STMT_PHONE_EXACT,
+    DB_STMT_PHONE_SUFFIX,
+    DB_STMT_FTS_NAME,
+    DB_STMT_FTS_EMAIL,
+    DB_STMT_SEARCH_NAME_PAGE,
+    DB_STMT_SEARCH_EMAIL_PAGE,
+    DB_STMT_SEARCH_PHONE_PAGE,
+    DB_STMT_SEARCH_DIGITS_PAGE,
+    DB_STMT_FTS_NAME_PAGE,
+    DB_STMT_FTS_EMAIL_PAGE,
+    DB_STMT_UPDATE,
+    DB_STMT_DELETE,
+    DB_STMT_SAVE,
+    DB_STMT_LOAD_ONE,
+    DB_STMT_LOG_RANGE,
+    DB_STMT_LOG_READ,
+    DB_STMT_LOG_PRUNE,
+    DB_STMT_COUNT
+} DbStmtId;
+
+#define DB_MAX_CONNECTIONS 8 // connections with a cache; more still work, uncached
+#define DB_SHAPE_CACHE 16    // ad-hoc statements kept per connection, by SQL text
+
+typedef struct {
+    sqlite3 *db;
+    sqlite3_stmt *stmt[DB_STMT_COUNT];
+    bool in_use[DB_STMT_COUNT];
+    // Generated SQL (contact_query): the least recently used idle one
+    // makes room for a new text
+    sqlite3_stmt *shape[DB_SHAPE_CACHE];
+    bool shape_in_use[DB_SHAPE_CACHE];
+    unsigned long shape_used[DB_SHAPE_CACHE];
+} DbStmtCache;
+
+static DbStmtCache stmt_caches[DB_MAX_CONNECTIONS];
+static unsigned long shape_clock;
+static pthread_mutex_t stmt_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Caller holds stmt_cache_lock
+static DbStmtCache *cache_for(sqlite3 *db, bool create) {
+    DbStmtCache *free_slot = NULL;
+    for (int i = 0; i < DB_MAX_CONNECTIONS; i++) {
+        if (stmt_caches[i].db == db) {
+            return &stmt_caches[i];
+        }
+        if (stmt_caches[i].db == NULL && free_slot == NULL) {
+            free_slot = &stmt_caches[i];
+        }
+    }
+    if (create && free_slot != NULL) {
+        free_slot->db = db;
+    }
+    return create ? free_slot : NULL;
+}
+
+static int db_stmt_acquire(sqlite3 *db, DbStmtId id, const char *sql, sqlite3_stmt **stmt) {
+    pthread_mutex_lock(&stmt_cache_lock);
+    DbStmtCache *cache = cache_for(db, true);
+    if (cache != NULL && !cache->in_use[id]) {
+        if (cache->stmt[id] == NULL &&
+            sqlite3_prepare_v2(db, sql, -1, &cache->stmt[id], NULL) != SQLITE_OK) {
+            cache->stmt[id] = NULL;
+            pthread_mutex_unlock(&stmt_cache_lock);
+            *stmt = NULL;
+            return sqlite3_errcode(db);
+        }
+        cache->in_use[id] = true;
+        *stmt = cache->stmt[id];
+        pthread_mutex_unlock(&stmt_cache_lock);
+        return SQLITE_OK;
+    }
+    pthread_mutex_unlock(&stmt_cache_lock);
+
+    // Busy or no cache slot left - a private statement for this call
+    return sqlite3_prepare_v2(db, sql, -1, stmt, NULL);
+}
+
+// Same contract as db_stmt_acquire, keyed by the SQL text itself
+static int db_shape_acquire(sqlite3 *db, const char *sql, sqlite3_stmt **stmt) {
+    pthread_mutex_lock(&stmt_cache_lock);
+    DbStmtCache *cache = cache_for(db, true);
+    int slot = -1, victim = -1;
+    for (int i = 0; cache != NULL && i < DB_SHAPE_CACHE; i++) {
+        if (cache->shape[i] != NULL && strcmp(sqlite3_sql(cache->shape[i]), sql) == 0) {
+            slot = i;
+            break;
+        }
+        if (!cache->shape_in_use[i] &&
+            (victim < 0 || cache->shape_used[i] < cache->shape_used[victim])) {
+            victim = i; // empty slots were never used, so they go first
+        }
+    }
+
+    if (slot < 0 && victim >= 0) {
+        sqlite3_finalize(cache->shape[victim]);
+        cache->shape[victim] = NULL;
+        if (sqlite3_prepare_v2(db, sql, -1, &cache->shape[victim], NULL) != SQLITE_OK) {
+            cache->shape[victim] = NULL;
+            cache->shape_used[victim] = 0;
+            pthread_mutex_unlock(&stmt_cache_lock);
+            *stmt = NULL;
+            return sqlite3_errcode(db);
+        }
+        slot = victim;
+    }
+    if (slot >= 0 && !cache->shape_in_use[slot]) {
+        cache->shape_in_use[slot] = true;
+        cache->shape_used[slot] = ++shape_clock;
+        *stmt = cache->shape[slot];
+        pthread_mutex_unlock(&stmt_cache_lock);
+        return SQLITE_OK;
+    }
+    pthread_mutex_unlock(&stmt_cache_lock);
+
+    return sqlite3_prepare_v2(db, sql, -1, stmt, NULL);
+}
+
+// Caller holds stmt_cache_lock
+static bool release_slot(sqlite3_stmt *const stmts[], bool in_use[], int count, sqlite3_stmt *stmt) {
+    for (int i = 0; i < count; i++) {
+        if (stmts[i] == stmt) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt); // drops pointers to the caller's buffers
+            in_use[i] = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void db_stmt_release(sqlite3 *db, sqlite3_stmt *stmt) {
+    if (stmt == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&stmt_cache_lock);
+    DbStmtCache *cache = cache_for(db, false);
+    bool cached = cache != NULL &&
+                  (release_slot(cache->stmt, cache->in_use, DB_STMT_COUNT, stmt) ||
+                   release_slot(cache->shape, cache->shape_in_use, DB_SHAPE_CACHE, stmt));
+    pthread_mutex_unlock(&stmt_cache_lock);
+    if (!cached) {
+        sqlite3_finalize(stmt);
+    }
+}
+
+static void db_stmt_cache_clear(sqlite3 *db) {
+    pthread_mutex_lock(&stmt_cache_lock);
+    DbStmtCache *cache = cache_for(db, false);
+    if (cache != NULL) {
+        for (int id = 0; id < DB_STMT_COUNT; id++) {
+            sqlite3_finalize(cache->stmt[id]);
+        }
+        for (int i = 0; i < DB_SHAPE_CACHE; i++) {
+            sqlite3_finalize(cache->shape[i]);
+        }
+        memset(cache, 0, sizeof(*cache));
+    }
+    pthread_mutex_unlock(&stmt_cache_lock);
+}
+
+// Ids written through the watched connection while recording is on. Its
+// own commits never move its data_version, so the log alone would not
+// tell db_read_changes to look.
+static struct {
+    sqlite3 *db;
+    bool recording;
+    int *ids;
+    int count;
+    int capacity;
+} own_changes;
+static pthread_mutex_t own_changes_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int exec_sql(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    int rc = sqlite3_exec(db, sql, NULL, NULL, &err_msg);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Error : %s (%s)\n", err_msg ? err_msg : sqlite3_errmsg(db), sql);
+        sqlite3_free(err_msg);
+    }
+    return rc;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Tuning profiles                                                   */
+/* ------------------------------------------------------------------ */
+const DbTuning DB_TUNING_DURABLE = {
+    "durable", 1, 2, 0, -2000, 0, 4096, 5000
+};
+const DbTuning DB_TUNING_BALANCED = {
+    "balanced", 1, 1, 256LL * 1024 * 1024, -16384, 2, 4096, 5000
+};
+const DbTuning DB_TUNING_BULK_LOAD = {
+    "bulk-load", 1, 0, 1024LL * 1024 * 1024, -262144, 2, 8192, 30000
+};
+
+const DbTuning *db_tuning_by_name(const char *name) {
+    const DbTuning *presets[] = {&DB_TUNING_DURABLE, &DB_TUNING_BALANCED, &DB_TUNING_BULK_LOAD};
+    for (size_t i = 0; name != NULL && i < sizeof(presets) / sizeof(presets[0]); i++) {
+        if (strcmp(name, presets[i]->name) == 0) {
+            return presets[i];
+        }
+    }
+    return NULL;
+}
+
+int db_apply_tuning(sqlite3 *db, const DbTuning *tuning) {
+    if (db == NULL) {
+        return SQLITE_MISUSE;
+    }
+    if (tuning == NULL) {
+        tuning = &DB_TUNING_BALANCED;
+    }
+
+    sqlite3_busy_timeout(db, tuning->busy_timeout_ms);
+
+    // page_size first: it only counts before the first table exists, and
+    // cannot change at all once the file is in WAL mode
+    char sql[512];
+    int length = 0;
+    if (tuning->page_size > 0) {
+        length += snprintf(sql + length, sizeof(sql) - length, "PRAGMA page_size=%d;", tuning->page_size);
+    }
+    snprintf(sql + length, sizeof(sql) - length,
+             "PRAGMA journal_mode=%s;"
+             "PRAGMA synchronous=%d;"
+             "PRAGMA cache_size=%d;"
+             "PRAGMA temp_store=%d;"
+             "PRAGMA mmap_size=%lld;",
+             tuning->wal ? "WAL" : "DELETE", tuning->synchronous, tuning->cache_size,
+             tuning->temp_store, tuning->mmap_size);
+
+    char *err_msg = NULL;
+    int rc = sqlite3_exec(db, sql, NULL, NULL, &err_msg);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Error : Applying '%s' profile: %s\n", tuning->name, err_msg);
+        sqlite3_free(err_msg);
+    }
+    return rc;
+}
+
+/* ------------------------------------------------------------------ */
+/*  SQL functions                                                     */
+/* ------------------------------------------------------------------ */
+// The in-memory matchers as SQL, so a query filters exactly as they do:
+//   digits(x)         extract_digits(x)
+//   rdigits(x)        the same digits, reversed
+//   casefold(x)       x with ASCII letters lowered
+//   contains_ci(a, b) contact_name_matches / contact_email_matches: b
+//                     occurs in a, ASCII case ignored; an empty b never
+//                     matches, and '%' / '_' are plain characters
+// Any NULL argument gives NULL.
+static unsigned char ascii_lower(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c - 'A' + 'a') : c;
+}
+
+static bool contains_ignoring_case(const unsigned char *text, int text_len,
+                                   const unsigned char *needle, int needle_len) {
+    if (needle_len == 0 || needle_len > text_len) {
+        return false;
+    }
+    // Candidates by the first byte in either case, then the rest
+    unsigned char first = ascii_lower(needle[0]);
+    unsigned char first_upper = (first >= 'a' && first <= 'z') ? (unsigned char)(first - 'a' + 'A') : first;
+    const unsigned char *last = text + (text_len - needle_len);
+    for (const unsigned char *p = text; p <= last; p++) {
+        if (*p != first && *p != first_upper) {
+            continue;
+        }
+        int i = 1;
+        while (i < needle_len && ascii_lower(p[i]) == ascii_lower(needle[i])) {
+            i++;
+        }
+        if (i == needle_len) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// "digits" reversed, so a suffix of the number becomes a prefix
+static void reverse_digits(char *dst, const char *digits) {
+    size_t n = strlen(digits);
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = digits[n - 1 - i];
+    }
+    dst[n] = '\0';
+}
+
+static void sql_digits(sqlite3_context *ctx, int argc, sqlite3_value **argv) {
+    (void)argc;
+    const char *text = (const char *)sqlite3_value_text(argv[0]);
+    if (text == NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    char digits[20];
+    extract_digits(digits, text);
+    sqlite3_result_text(ctx, digits, -1, SQLITE_TRANSIENT);
+}
+
+static void sql_rdigits(sqlite3_context *ctx, int argc, sqlite3_value **argv) {
+    (void)argc;
+    const char *text = (const char *)sqlite3_value_text(argv[0]);
+    if (text == NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    char digits[20], reversed[20];
+    extract_digits(digits, text);
+    reverse_digits(reversed, digits);
+    sqlite3_result_text(ctx, reversed, -1, SQLITE_TRANSIENT);
+}
+
+static void sql_casefold(sqlite3_context *ctx, int argc, sqlite3_value **argv) {
+    (void)argc;
+    const unsigned char *text = sqlite3_value_text(argv[0]);
+    if (text == NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    int length = sqlite3_value_bytes(argv[0]);
+    unsigned char *folded = sqlite3_malloc(length + 1);
+    if (folded == NULL) {
+        sqlite3_result_error_nomem(ctx);
+        return;
+    }
+    for (int i = 0; i < length; i++) {
+        folded[i] = ascii_lower(text[i]);
+    }
+    folded[length] = '\0';
+    sqlite3_result_text(ctx, (const char *)folded, length, sqlite3_free);
+}
+
+static void sql_contains_ci(sqlite3_context *ctx, int argc, sqlite3_value **argv) {
+    (void)argc;
+    const unsigned char *text = sqlite3_value_text(argv[0]);
+    const unsigned char *needle = sqlite3_value_text(argv[1]);
+    if (text == NULL || needle == NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    sqlite3_result_int(ctx, contains_ignoring_case(text, sqlite3_value_bytes(argv[0]),
+                                                   needle, sqlite3_value_bytes(argv[1])));
+}
+
+int db_register_functions(sqlite3 *db) {
+    const int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS;
+    int rc = sqlite3_create_function(db, "digits", 1, flags, NULL, sql_digits, NULL, NULL);
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_create_function(db, "rdigits", 1, flags, NULL, sql_rdigits, NULL, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_create_function(db, "casefold", 1, flags, NULL, sql_casefold, NULL, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_create_function(db, "contains_ci", 2, flags, NULL, sql_contains_ci, NULL, NULL);
+    }
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Error : Registering SQL functions: %s\n", sqlite3_errmsg(db));
+    }
+    return rc;
+}
 
 /* ------------------------------------------------------------------ */
 /*  db_open                                                           */
 /* ------------------------------------------------------------------ */
-int db_open(sqlite3 **db) {
+int db_open(sqlite3 **db, const DbTuning *tuning) {
     int rc = sqlite3_open(DB_FILENAME, db);
     if (rc != SQLITE_OK){
         fprintf(stderr, "Error : %s\n", sqlite3_errmsg(*db));
@@ -14,6 +395,19 @@ int db_open(sqlite3 **db) {
         sqlite3_close(*db); 
         return rc;
     }
+
+    rc = db_register_functions(*db);
+    if (rc != SQLITE_OK){
+        sqlite3_close(*db);
+        return rc;
+    }
+
+    // Settings before the table: page_size only applies to a new file
+    rc = db_apply_tuning(*db, tuning);
+    if (rc != SQLITE_OK){
+        sqlite3_close(*db);
+        return rc;
+    }
     
     rc = db_create_table(*db);
     if (rc != SQLITE_OK){
@@ -25,11 +419,57 @@ int db_open(sqlite3 **db) {
     return SQLITE_OK; 
 }
 
+/* ------------------------------------------------------------------ */
+/*  db_open_reader                                                    */
+/* ------------------------------------------------------------------ */
+int db_open_reader(sqlite3 **db, const DbTuning *tuning) {
+    // No mutex: the caller hands the connection to one thread at a time
+    int rc = sqlite3_open_v2(DB_FILENAME, db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, NULL);
+    if (rc != SQLITE_OK){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(*db));
+        sqlite3_close(*db);
+        *db = NULL;
+        return rc;
+    }
+    if (tuning == NULL) {
+        tuning = &DB_TUNING_BALANCED;
+    }
+
+    rc = db_register_functions(*db);
+    if (rc != SQLITE_OK){
+        sqlite3_close(*db);
+        *db = NULL;
+        return rc;
+    }
+
+    // journal_mode and page_size belong to the file; the writer set them
+    sqlite3_busy_timeout(*db, tuning->busy_timeout_ms);
+    char sql[256];
+    snprintf(sql, sizeof(sql),
+             "PRAGMA cache_size=%d;"
+             "PRAGMA temp_store=%d;"
+             "PRAGMA mmap_size=%lld;",
+             tuning->cache_size, tuning->temp_store, tuning->mmap_size);
+    rc = exec_sql(*db, sql);
+    if (rc != SQLITE_OK){
+        sqlite3_close(*db);
+        *db = NULL;
+    }
+    return rc;
+}
+
 /* ------------------------------------------------------------------ */
 /*  db_close                                                          */
 /* ------------------------------------------------------------------ */
 void db_close(sqlite3 *db) {
     if (db) {
+        pthread_mutex_lock(&own_changes_lock);
+        bool watched = own_changes.db == db;
+        pthread_mutex_unlock(&own_changes_lock);
+        if (watched) {
+            db_watch_changes(NULL);
+        }
+        db_stmt_cache_clear(db); // open statements would keep the connection alive
         sqlite3_close(db);
     }
 }
@@ -52,9 +492,236 @@ int db_create_table(sqlite3 *db) {
         sqlite3_free(err_msg);
         return rc;
     }
+
+    // Searches still work (by LIKE scan) without the index
+    if (db_create_search_index(db) != SQLITE_OK){
+        fprintf(stderr, "Error : Full-text index unavailable, searching by table scan\n");
+    }
+    if (db_create_phone_index(db) != SQLITE_OK){
+        fprintf(stderr, "Error : Phone digit index unavailable, searching phones as text\n");
+    }
+    if (db_create_change_log(db) != SQLITE_OK){
+        fprintf(stderr, "Error : Change log unavailable, reloads read every contact\n");
+    }
     return SQLITE_OK; 
 }
 
+/* ------------------------------------------------------------------ */
+/*  db_create_phone_index                                             */
+/* ------------------------------------------------------------------ */
+// The generated columns call the registered digits()/rdigits(), so they
+// hold exactly what extract_digits keeps, however long the phone is.
+// Every connection that writes contacts therefore needs
+// db_register_functions: inserting computes the indexed phone_rdigits.
+static const char *const phone_columns =
+    "ALTER TABLE contacts ADD COLUMN phone_digits TEXT GENERATED ALWAYS AS (digits(phone)) VIRTUAL;"
+    "ALTER TABLE contacts ADD COLUMN phone_rdigits TEXT GENERATED ALWAYS AS (rdigits(phone)) VIRTUAL;"
+    "CREATE INDEX contacts_phone_rdigits ON contacts(phone_rdigits);";
+
+// Older databases computed the columns with a fixed-length CASE chain of
+// built-ins that saw only the first characters of the phone. Generated
+// columns cannot be altered, so those are dropped and added again.
+static const char *const drop_phone_columns =
+    "DROP INDEX IF EXISTS contacts_phone_rdigits;"
+    "ALTER TABLE contacts DROP COLUMN phone_rdigits;"
+    "ALTER TABLE contacts DROP COLUMN phone_digits;";
+
+int db_create_phone_index(sqlite3 *db) {
+    // How far along is this database? The column definitions live in the
+    // table's CREATE statement.
+    sqlite3_stmt *stmt = NULL;
+    int rc = sqlite3_prepare_v2(db, "SELECT sql FROM sqlite_master WHERE type = 'table' AND name = 'contacts'",
+                                -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    const char *table_sql = sqlite3_step(stmt) == SQLITE_ROW ? (const char *)sqlite3_column_text(stmt, 0) : NULL;
+    bool has_columns = table_sql != NULL && strstr(table_sql, "phone_rdigits") != NULL;
+    bool current = table_sql != NULL && strstr(table_sql, "rdigits(phone)") != NULL;
+    sqlite3_finalize(stmt);
+
+    if (current) {
+        return exec_sql(db, "CREATE INDEX IF NOT EXISTS contacts_phone_rdigits "
+                            "ON contacts(phone_rdigits);");
+    }
+
+    // VIRTUAL columns cost nothing to add; building the index computes the
+    // reversed digits of every existing row, which is the backfill
+    char sql[1024];
+    snprintf(sql, sizeof(sql), "BEGIN;%s%sCOMMIT;", has_columns ? drop_phone_columns : "", phone_columns);
+    char *err_msg = NULL;
+    rc = sqlite3_exec(db, sql, NULL, NULL, &err_msg);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Error : %s\n", err_msg);
+        sqlite3_free(err_msg);
+        if (!sqlite3_get_autocommit(db)) {
+            exec_sql(db, "ROLLBACK;");
+        }
+    }
+    return rc;
+}
+
+/* ------------------------------------------------------------------ */
+/*  db_create_search_index                                            */
+/* ------------------------------------------------------------------ */
+// contacts_fts holds no text of its own (external content): it indexes
+// the trigrams of contacts.name / contacts.email and reads the values
+// back from contacts. The triggers keep it in step with every write.
+static const char *const fts_triggers =
+    "CREATE TRIGGER contacts_fts_delete AFTER DELETE ON contacts BEGIN "
+    "INSERT INTO contacts_fts(contacts_fts, rowid, name, email) "
+    "VALUES ('delete', old.id, old.name, old.email); "
+    "END;"
+    "CREATE TRIGGER contacts_fts_insert AFTER INSERT ON contacts BEGIN "
+    "INSERT INTO contacts_fts(rowid, name, email) VALUES (new.id, new.name, new.email); "
+    "END;"
+    "CREATE TRIGGER contacts_fts_update AFTER UPDATE OF name, email ON contacts "
+    "WHEN old.name IS NOT new.name OR old.email IS NOT new.email BEGIN "
+    "INSERT INTO contacts_fts(contacts_fts, rowid, name, email) "
+    "VALUES ('delete', old.id, old.name, old.email); "
+    "INSERT INTO contacts_fts(rowid, name, email) VALUES (new.id, new.name, new.email); "
+    "END;";
+
+static bool has_search_index(sqlite3 *db) {
+    sqlite3_stmt *stmt = NULL;
+    bool exists = false;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE name = 'contacts_fts'",
+                           -1, &stmt, NULL) == SQLITE_OK) {
+        exists = sqlite3_step(stmt) == SQLITE_ROW;
+    }
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+int db_create_search_index(sqlite3 *db) {
+    if (has_search_index(db)) {
+        return SQLITE_OK;
+    }
+
+    char *err_msg = NULL;
+    int rc = sqlite3_exec(db,
+        "BEGIN;"
+        "CREATE VIRTUAL TABLE contacts_fts USING fts5("
+        "name, email, content='contacts', content_rowid='id', "
+        "tokenize='trigram case_sensitive 0');",
+        NULL, NULL, &err_msg);
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_exec(db, fts_triggers, NULL, NULL, &err_msg);
+    }
+    if (rc == SQLITE_OK) {
+        // Index rows written before the index existed
+        rc = sqlite3_exec(db,
+            "INSERT INTO contacts_fts(contacts_fts) VALUES ('rebuild');"
+            "COMMIT;",
+            NULL, NULL, &err_msg);
+    }
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Error : %s\n", err_msg);
+        sqlite3_free(err_msg);
+        if (!sqlite3_get_autocommit(db)) {
+            sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        }
+    }
+    return rc;
+}
+
+// Trigrams need three characters; shorter patterns cannot use the index.
+// Nor can '%' or '_' (wildcards to the trigram LIKE, plain characters to
+// contains_ci) or non-ASCII text, whose case the index folds differently.
+static bool use_search_index(const char *pattern) {
+    size_t length = 0;
+    for (const unsigned char *p = (const unsigned char *)pattern; *p != '\0'; p++, length++) {
+        if (*p >= 0x80 || *p == '%' || *p == '_') {
+            return false;
+        }
+    }
+    return length >= 3;
+}
+
+// Acquires the FTS statement when the pattern can use the index and it
+// exists, otherwise the contains_ci scan over contacts
+static int acquire_search(sqlite3 *db, const char *pattern,
+                          DbStmtId fts_id, const char *fts_sql,
+                          DbStmtId scan_id, const char *scan_sql,
+                          sqlite3_stmt **stmt) {
+    if (use_search_index(pattern) && db_stmt_acquire(db, fts_id, fts_sql, stmt) == SQLITE_OK) {
+        return SQLITE_OK;
+    }
+    return db_stmt_acquire(db, scan_id, scan_sql, stmt);
+}
+
+/* ------------------------------------------------------------------ */
+/*  db_create_change_log                                              */
+/* ------------------------------------------------------------------ */
+// Every write to contacts, from any connection or process (a second copy
+// of the program, the sqlite3 shell), appends the id it touched.
+static const char *const log_triggers =
+    "CREATE TRIGGER IF NOT EXISTS contacts_log_insert AFTER INSERT ON contacts BEGIN "
+    "INSERT INTO contacts_changes(id) VALUES (new.id); "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS contacts_log_update AFTER UPDATE ON contacts BEGIN "
+    "INSERT INTO contacts_changes(id) VALUES (new.id); "
+    "INSERT INTO contacts_changes(id) SELECT old.id WHERE old.id IS NOT new.id; "
+    "END;"
+    "CREATE TRIGGER IF NOT EXISTS contacts_log_delete AFTER DELETE ON contacts BEGIN "
+    "INSERT INTO contacts_changes(id) VALUES (old.id); "
+    "END;";
+
+int db_create_change_log(sqlite3 *db) {
+    int rc = exec_sql(db,
+        "CREATE TABLE IF NOT EXISTS contacts_changes ("
+        "seq INTEGER PRIMARY KEY AUTOINCREMENT, id INTEGER NOT NULL);");
+    return rc == SQLITE_OK ? exec_sql(db, log_triggers) : rc;
+}
+
+static void on_update(void *ctx, int op, const char *db_name, const char *table, sqlite3_int64 rowid) {
+    (void)ctx;
+    (void)op;
+    (void)db_name;
+    if (strcmp(table, "contacts") != 0) {
+        return; // contacts_changes, the FTS shadow tables
+    }
+
+    pthread_mutex_lock(&own_changes_lock);
+    if (own_changes.recording) {
+        if (own_changes.count == own_changes.capacity) {
+            int new_capacity = own_changes.capacity > 0 ? own_changes.capacity * 2 : 64;
+            int *new_ids = realloc(own_changes.ids, (size_t)new_capacity * sizeof(int));
+            if (new_ids != NULL) {
+                own_changes.ids = new_ids;
+                own_changes.capacity = new_capacity;
+            }
+        }
+        if (own_changes.count < own_changes.capacity) {
+            own_changes.ids[own_changes.count++] = (int)rowid;
+        }
+    }
+    pthread_mutex_unlock(&own_changes_lock);
+}
+
+void db_watch_changes(sqlite3 *db) {
+    // The hooks are set outside own_changes_lock: sqlite3_update_hook takes
+    // the connection mutex, which on_update already holds when it locks
+    pthread_mutex_lock(&own_changes_lock);
+    sqlite3 *previous = own_changes.db;
+    own_changes.db = db;
+    own_changes.recording = db != NULL;
+    own_changes.count = 0;
+    pthread_mutex_unlock(&own_changes_lock);
+    if (previous != NULL && previous != db) {
+        sqlite3_update_hook(previous, NULL, NULL);
+    }
+    if (db != NULL) {
+        sqlite3_update_hook(db, on_update, NULL);
+    }
+}
+
+void db_record_changes(bool on) {
+    pthread_mutex_lock(&own_changes_lock);
+    own_changes.recording = on && own_changes.db != NULL;
+    pthread_mutex_unlock(&own_changes_lock);
+}
+
 /* ------------------------------------------------------------------ */
 /*  db_insert_contact                                                 */
 /* ------------------------------------------------------------------ */
@@ -64,7 +731,7 @@ int db_insert_contact(sqlite3 *db, const Contact *contact) {
     }
     const char *sql = "INSERT INTO contacts (name, phone, email) VALUES (?1, ?2, ?3);";
     sqlite3_stmt *stmt = NULL;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = db_stmt_acquire(db, DB_STMT_INSERT, sql, &stmt);
     if (rc != SQLITE_OK){
         fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
         return rc;
@@ -75,204 +742,631 @@ int db_insert_contact(sqlite3 *db, const Contact *contact) {
     sqlite3_bind_text(stmt, 2, contact->phone, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 3, contact->email, -1, SQLITE_STATIC);
 
-    // BUGFIX: was sqlite_step (missing '3')
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE){
+    // BUGFIX: was sqlite_step (missing '3')
+    rc = sqlite3_step(stmt);
+    if (rc != SQLITE_DONE){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
+    }
+
+    db_stmt_release(db, stmt);
+    return rc == SQLITE_DONE ? SQLITE_OK : rc;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Row decoding                                                      */
+/* ------------------------------------------------------------------ */
+// Copies column 'col' into a field of 'size' bytes: exactly the bytes
+// SQLite holds plus a terminator, nothing padded
+static void copy_column(char *dst, size_t size, sqlite3_stmt *stmt, int col) {
+    const unsigned char *text = sqlite3_column_text(stmt, col);
+    size_t length = text != NULL ? (size_t)sqlite3_column_bytes(stmt, col) : 0;
+    if (length > size - 1){
+        length = size - 1;
+    }
+    if (length > 0){
+        memcpy(dst, text, length);
+    }
+    dst[length] = '\0';
+}
+
+// Columns id, name, phone, email -> Contact
+static void decode_contact(sqlite3_stmt *stmt, Contact *contact) {
+    contact->id = sqlite3_column_int(stmt, 0);
+    copy_column(contact->name,  MAX_NAME_LEN,  stmt, 1);
+    copy_column(contact->phone, MAX_PHONE_LEN, stmt, 2);
+    copy_column(contact->email, MAX_EMAIL_LEN, stmt, 3);
+}
+
+// Steps a bound search statement into a new list and releases it
+static ContactList *collect_results(sqlite3 *db, sqlite3_stmt *stmt) {
+    ContactList *results = (ContactList *)malloc(sizeof(ContactList));
+    if (results == NULL){
+        db_stmt_release(db, stmt);
+        return NULL;
+    }
+    contact_list_init(results, 10);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW){
+        if (!contact_list_ensure_capacity(results, results->size + 1)){
+            fprintf(stderr, "Error : Failed to add contact (id - %d) to list\n", sqlite3_column_int(stmt, 0));
+            contact_list_free(results);
+            free(results);
+            db_stmt_release(db, stmt);
+            // BUGFIX: must return after cleanup to avoid using freed memory
+            return NULL;
+        }
+        decode_contact(stmt, &results->data[results->size]);
+        contact_list_commit_slots(results, 1);
+    }
+    if (rc != SQLITE_DONE){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
+    }
+    db_stmt_release(db, stmt);
+    return results; 
+}
+
+/* ------------------------------------------------------------------ */
+/*  Cursor                                                            */
+/* ------------------------------------------------------------------ */
+int db_count_contacts(sqlite3 *db) {
+    sqlite3_stmt *stmt = NULL;
+    if (db_stmt_acquire(db, DB_STMT_COUNT_ALL, "SELECT count(*) FROM contacts", &stmt) != SQLITE_OK){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    int count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+    db_stmt_release(db, stmt);
+    return count;
+}
+
+int db_cursor_open(sqlite3 *db, DbCursor *cursor) {
+    const char *sql = "SELECT id, name, phone, email FROM contacts ORDER BY id";
+    cursor->db = db;
+    cursor->rc = db_stmt_acquire(db, DB_STMT_LOAD_ALL, sql, &cursor->stmt);
+    if (cursor->rc != SQLITE_OK){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
+        cursor->stmt = NULL;
+    }
+    return cursor->rc;
+}
+
+int db_cursor_open_sql(sqlite3 *db, DbCursor *cursor, const char *sql) {
+    cursor->db = db;
+    cursor->rc = db_shape_acquire(db, sql, &cursor->stmt);
+    if (cursor->rc != SQLITE_OK){
+        cursor->stmt = NULL;
+    }
+    return cursor->rc;
+}
+
+int db_cursor_step(DbCursor *cursor) {
+    if (cursor->stmt == NULL){
+        return -1;
+    }
+    cursor->rc = sqlite3_step(cursor->stmt);
+    if (cursor->rc == SQLITE_ROW){
+        return 1;
+    }
+    if (cursor->rc != SQLITE_DONE){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(cursor->db));
+        return -1;
+    }
+    return 0;
+}
+
+void db_cursor_read(const DbCursor *cursor, Contact *contact) {
+    decode_contact(cursor->stmt, contact);
+}
+
+int db_cursor_next(DbCursor *cursor, Contact *contact) {
+    int rc = db_cursor_step(cursor);
+    if (rc == 1){
+        db_cursor_read(cursor, contact);
+    }
+    return rc;
+}
+
+void db_cursor_close(DbCursor *cursor) {
+    if (cursor->stmt != NULL){
+        db_stmt_release(cursor->db, cursor->stmt);
+        cursor->stmt = NULL;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  db_load_all_contacts                                              */
+/* ------------------------------------------------------------------ */
+int db_load_all_contacts(sqlite3 *db, ContactList *list) {
+    if (list == NULL) return -1;
+
+    // One allocation up front instead of doubling through the load
+    int expected = db_count_contacts(db);
+    if (expected > 0 && !contact_list_ensure_capacity(list, list->size + expected)){
+        fprintf(stderr, "Error : No memory for %d contacts\n", expected);
+        return -1;
+    }
+
+    DbCursor cursor;
+    if (db_cursor_open(db, &cursor) != SQLITE_OK){
+        // BUGFIX: return -1 on error, not the SQLite code
+        return -1;
+    }
+
+    int count = 0;
+    int rc;
+    while ((rc = db_cursor_step(&cursor)) == 1){
+        // Rows added since the count still fit
+        if (!contact_list_ensure_capacity(list, list->size + 1)){
+            fprintf(stderr, "Error : Failed to add contact (id - %d) to list\n",
+                    sqlite3_column_int(cursor.stmt, 0));
+            break;
+        }
+        // Decoded straight into the list's next slot
+        db_cursor_read(&cursor, &list->data[list->size]);
+        contact_list_commit_slots(list, 1);
+        count++;
+    }
+
+    if (rc < 0){
+        count = -1;
+    }
+    db_cursor_close(&cursor);
+    return count; 
+}
+
+/* ------------------------------------------------------------------ */
+/*  db_search_by_name                                                 */
+/* ------------------------------------------------------------------ */
+ContactList *db_search_by_name(sqlite3 *db, const char *pattern) {
+    if (pattern == NULL) return NULL;
+    
+    char like_pattern[256];
+    snprintf(like_pattern, sizeof(like_pattern), "%%%s%%", pattern);
+
+    // ?1 narrows by trigrams, ?2 decides as contact_name_matches does:
+    // the trigram LIKE reads '%' and '_' as wildcards and folds non-ASCII
+    // case. The scan form needs only ?2.
+    const char *sql = "SELECT id, name, phone, email FROM contacts WHERE contains_ci(name, ?2) ORDER BY id";
+    const char *fts_sql =
+        "SELECT c.id, c.name, c.phone, c.email FROM contacts_fts f "
+        "JOIN contacts c ON c.id = f.rowid WHERE f.name LIKE ?1 AND contains_ci(c.name, ?2) ORDER BY c.id";
+    sqlite3_stmt *stmt = NULL;
+    if (acquire_search(db, pattern, DB_STMT_FTS_NAME, fts_sql,
+                       DB_STMT_SEARCH_NAME, sql, &stmt) != SQLITE_OK){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
+        return NULL;
+    }
+
+    sqlite3_bind_text(stmt, 1, like_pattern, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, pattern, -1, SQLITE_STATIC);
+    return collect_results(db, stmt);
+}
+
+/* ------------------------------------------------------------------ */
+/*  db_search_by_email                                                */
+/* ------------------------------------------------------------------ */
+ContactList *db_search_by_email(sqlite3 *db, const char *pattern) {
+    if (pattern == NULL) return NULL;
+    
+    char like_pattern[256];
+    snprintf(like_pattern, sizeof(like_pattern), "%%%s%%", pattern);
+
+    // BUGFIX: SQL used ?2, must use ?1 if binding index 1
+    // ?1 and ?2 as in db_search_by_name
+    const char *sql = "SELECT id, name, phone, email FROM contacts WHERE contains_ci(email, ?2) ORDER BY id";
+    const char *fts_sql =
+        "SELECT c.id, c.name, c.phone, c.email FROM contacts_fts f "
+        "JOIN contacts c ON c.id = f.rowid WHERE f.email LIKE ?1 AND contains_ci(c.email, ?2) ORDER BY c.id";
+    sqlite3_stmt *stmt = NULL;
+    if (acquire_search(db, pattern, DB_STMT_FTS_EMAIL, fts_sql,
+                       DB_STMT_SEARCH_EMAIL, sql, &stmt) != SQLITE_OK){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
+        return NULL;
+    }
+
+    sqlite3_bind_text(stmt, 1, like_pattern, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, pattern, -1, SQLITE_STATIC);
+    return collect_results(db, stmt);
+}
+
+/* ------------------------------------------------------------------ */
+/*  db_search_by_phone                                                */
+/* ------------------------------------------------------------------ */
+ContactList *db_search_by_phone(sqlite3 *db, const char *pattern) {
+    if (pattern == NULL) return NULL;
+
+    // Digits of the pattern against the digits of each phone, so
+    // "555-1234" finds "5551234" (as contact_phone_matches does in memory)
+    char digits[20], reversed[20];
+    extract_digits(digits, pattern);
+    reverse_digits(reversed, digits);
+    
+    char digits_pattern[24];
+    snprintf(digits_pattern, sizeof(digits_pattern), "%%%s%%", reversed);
+
+    // Without digits in the pattern, or without phone_rdigits, digits()
+    // does the same normalization row by row
+    const char *sql =
+        "SELECT id, name, phone, email FROM contacts WHERE instr(digits(phone), ?1) > 0 ORDER BY id";
+    // Reading phone_rdigits out of its index: recomputing the generated
+    // column for every row of a table scan is far slower
+    const char *digits_sql =
+        "SELECT id, name, phone, email FROM contacts INDEXED BY contacts_phone_rdigits "
+        "WHERE phone_rdigits LIKE ?1 ORDER BY id";
+    sqlite3_stmt *stmt = NULL;
+    if (digits[0] != '\0' &&
+        db_stmt_acquire(db, DB_STMT_SEARCH_DIGITS, digits_sql, &stmt) == SQLITE_OK){
+        sqlite3_bind_text(stmt, 1, digits_pattern, -1, SQLITE_TRANSIENT);
+        return collect_results(db, stmt);
+    }
+    if (db_stmt_acquire(db, DB_STMT_SEARCH_PHONE, sql, &stmt) != SQLITE_OK){
         fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
+        return NULL;
     }
 
-    sqlite3_finalize(stmt);
-    return rc == SQLITE_DONE ? SQLITE_OK : rc;
+    sqlite3_bind_text(stmt, 1, digits, -1, SQLITE_TRANSIENT);
+    return collect_results(db, stmt);
 }
 
 /* ------------------------------------------------------------------ */
-/*  db_load_all_contacts                                              */
+/*  db_find_by_phone                                                  */
 /* ------------------------------------------------------------------ */
-int db_load_all_contacts(sqlite3 *db, ContactList *list) {
-    const char* sql = "SELECT id, name, phone, email FROM contacts ORDER BY id";
-    sqlite3_stmt *stmt = NULL;
+ContactList *db_find_by_phone(sqlite3 *db, const char *phone) {
+    if (phone == NULL) return NULL;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK){
+    char digits[20], reversed[20];
+    extract_digits(digits, phone);
+    reverse_digits(reversed, digits);
+
+    const char *sql =
+        "SELECT id, name, phone, email FROM contacts WHERE phone_rdigits = ?1 ORDER BY id";
+    sqlite3_stmt *stmt = NULL;
+    if (db_stmt_acquire(db, DB_STMT_PHONE_EXACT, sql, &stmt) != SQLITE_OK){
         fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
-        // BUGFIX: return -1 on error, not the SQLite code
-        return -1;
+        return NULL;
     }
 
-    int count = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW){   // BUGFIX: sqlite_step -> sqlite3_step
-        Contact contact;
-        contact.id = sqlite3_column_int(stmt, 0);
-        
-        // BUGFIX: buffer sizes were swapped (phone/email)
-        strncpy(contact.name,  (const char *)sqlite3_column_text(stmt, 1), MAX_NAME_LEN - 1);
-        strncpy(contact.phone, (const char *)sqlite3_column_text(stmt, 2), MAX_PHONE_LEN - 1);
-        strncpy(contact.email, (const char *)sqlite3_column_text(stmt, 3), MAX_EMAIL_LEN - 1);
-
-        contact.name[MAX_NAME_LEN - 1]   = '\0';
-        contact.phone[MAX_PHONE_LEN - 1] = '\0';
-        contact.email[MAX_EMAIL_LEN - 1] = '\0';
-
-        if (!contact_list_add(list, &contact)){
-            fprintf(stderr, "Error : Failed to add contact (id - %d) to list\n", contact.id);
-            break;
-        }
-        count++;
+    sqlite3_bind_text(stmt, 1, reversed, -1, SQLITE_TRANSIENT);
+    return collect_results(db, stmt);
+}
+
+/* ------------------------------------------------------------------ */
+/*  db_search_by_phone_suffix                                         */
+/* ------------------------------------------------------------------ */
+ContactList *db_search_by_phone_suffix(sqlite3 *db, const char *suffix) {
+    if (suffix == NULL) return NULL;
+
+    char digits[20], reversed[20], upper[21];
+    extract_digits(digits, suffix);
+    reverse_digits(reversed, digits);
+    // Every string starting with 'reversed' sorts in [reversed, reversed + ':')
+    // since ':' follows '9'
+    snprintf(upper, sizeof(upper), "%s:", reversed);
+
+    const char *sql =
+        "SELECT id, name, phone, email FROM contacts "
+        "WHERE phone_rdigits >= ?1 AND phone_rdigits < ?2 ORDER BY id";
+    sqlite3_stmt *stmt = NULL;
+    if (db_stmt_acquire(db, DB_STMT_PHONE_SUFFIX, sql, &stmt) != SQLITE_OK){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
+        return NULL;
     }
 
-    sqlite3_finalize(stmt);
-    return count; 
+    sqlite3_bind_text(stmt, 1, reversed, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, upper, -1, SQLITE_TRANSIENT);
+    return collect_results(db, stmt);
 }
 
 /* ------------------------------------------------------------------ */
-/*  db_search_by_name                                                 */
+/*  Paged searches                                                    */
 /* ------------------------------------------------------------------ */
-ContactList *db_search_by_name(sqlite3 *db, const char *pattern) {
+// Binds the keyset (?2 after_id, ?3 limit plus one row of lookahead),
+// collects the page and sets the continuation: the last id shown if the
+// lookahead row exists, else 0 - a full last page is not followed by an
+// empty one
+static ContactList *collect_page(sqlite3 *db, sqlite3_stmt *stmt, int after_id, int limit, int *next_id) {
+    sqlite3_bind_int(stmt, 2, after_id);
+    sqlite3_bind_int(stmt, 3, limit + 1);
+    ContactList *page = collect_results(db, stmt);
+    bool more = page != NULL && page->size > limit;
+    if (more) {
+        page->size = limit;
+    }
+    if (next_id != NULL) {
+        *next_id = more ? page->data[page->size - 1].id : 0;
+    }
+    return page;
+}
+
+// The FTS forms walk contacts_fts in rowid order from after_id, so a page
+// stops after 'limit' matches instead of collecting them all
+ContactList *db_search_by_name_page(sqlite3 *db, const char *pattern, int after_id, int limit, int *next_id) {
     if (pattern == NULL) return NULL;
-    
+    if (limit <= 0) limit = DB_PAGE_SIZE;
+
     char like_pattern[256];
     snprintf(like_pattern, sizeof(like_pattern), "%%%s%%", pattern);
 
-    const char *sql = "SELECT id, name, phone, email FROM contacts WHERE name LIKE ?1 ORDER BY id";
+    const char *sql =
+        "SELECT id, name, phone, email FROM contacts "
+        "WHERE contains_ci(name, ?4) AND id > ?2 ORDER BY id LIMIT ?3";
+    const char *fts_sql =
+        "SELECT c.id, c.name, c.phone, c.email FROM contacts_fts f "
+        "JOIN contacts c ON c.id = f.rowid "
+        "WHERE f.name LIKE ?1 AND contains_ci(c.name, ?4) AND f.rowid > ?2 ORDER BY f.rowid LIMIT ?3";
     sqlite3_stmt *stmt = NULL;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK){
+    if (acquire_search(db, pattern, DB_STMT_FTS_NAME_PAGE, fts_sql,
+                       DB_STMT_SEARCH_NAME_PAGE, sql, &stmt) != SQLITE_OK){
         fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
         return NULL;
     }
 
     sqlite3_bind_text(stmt, 1, like_pattern, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, pattern, -1, SQLITE_STATIC);
+    return collect_page(db, stmt, after_id, limit, next_id);
+}
 
-    ContactList *results = (ContactList *)malloc(sizeof(ContactList));
-    if (results == NULL){
-        sqlite3_finalize(stmt);
+ContactList *db_search_by_email_page(sqlite3 *db, const char *pattern, int after_id, int limit, int *next_id) {
+    if (pattern == NULL) return NULL;
+    if (limit <= 0) limit = DB_PAGE_SIZE;
+
+    char like_pattern[256];
+    snprintf(like_pattern, sizeof(like_pattern), "%%%s%%", pattern);
+
+    const char *sql =
+        "SELECT id, name, phone, email FROM contacts "
+        "WHERE contains_ci(email, ?4) AND id > ?2 ORDER BY id LIMIT ?3";
+    const char *fts_sql =
+        "SELECT c.id, c.name, c.phone, c.email FROM contacts_fts f "
+        "JOIN contacts c ON c.id = f.rowid "
+        "WHERE f.email LIKE ?1 AND contains_ci(c.email, ?4) AND f.rowid > ?2 ORDER BY f.rowid LIMIT ?3";
+    sqlite3_stmt *stmt = NULL;
+    if (acquire_search(db, pattern, DB_STMT_FTS_EMAIL_PAGE, fts_sql,
+                       DB_STMT_SEARCH_EMAIL_PAGE, sql, &stmt) != SQLITE_OK){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
         return NULL;
     }
-    contact_list_init(results, 10);
 
-    while (sqlite3_step(stmt) == SQLITE_ROW){
-        Contact contact;
-        contact.id = sqlite3_column_int(stmt, 0);
+    sqlite3_bind_text(stmt, 1, like_pattern, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, pattern, -1, SQLITE_STATIC);
+    return collect_page(db, stmt, after_id, limit, next_id);
+}
 
-        // BUGFIX: column order and buffer sizes fixed
-        strncpy(contact.name,  (const char *)sqlite3_column_text(stmt, 1), MAX_NAME_LEN - 1);
-        strncpy(contact.phone, (const char *)sqlite3_column_text(stmt, 2), MAX_PHONE_LEN - 1);
-        strncpy(contact.email, (const char *)sqlite3_column_text(stmt, 3), MAX_EMAIL_LEN - 1);
+ContactList *db_search_by_phone_page(sqlite3 *db, const char *pattern, int after_id, int limit, int *next_id) {
+    if (pattern == NULL) return NULL;
+    if (limit <= 0) limit = DB_PAGE_SIZE;
 
-        contact.name[MAX_NAME_LEN - 1]   = '\0';
-        contact.phone[MAX_PHONE_LEN - 1] = '\0';
-        contact.email[MAX_EMAIL_LEN - 1] = '\0';
+    char digits[20], reversed[20];
+    extract_digits(digits, pattern);
+    reverse_digits(reversed, digits);
 
-        if (!contact_list_add(results, &contact)){
-            fprintf(stderr, "Error : Failed to add contact (id - %d) to list\n", contact.id);
-            contact_list_free(results);
-            free(results);
-            sqlite3_finalize(stmt);
-            // BUGFIX: must return after cleanup to avoid using freed memory
-            return NULL;
-        }
+    char digits_pattern[24];
+    snprintf(digits_pattern, sizeof(digits_pattern), "%%%s%%", reversed);
+
+    const char *sql =
+        "SELECT id, name, phone, email FROM contacts "
+        "WHERE instr(digits(phone), ?1) > 0 AND id > ?2 ORDER BY id LIMIT ?3";
+    // Still one scan of the index per page; only the first 'limit' ids
+    // past after_id are kept for the sort
+    const char *digits_sql =
+        "SELECT id, name, phone, email FROM contacts INDEXED BY contacts_phone_rdigits "
+        "WHERE phone_rdigits LIKE ?1 AND id > ?2 ORDER BY id LIMIT ?3";
+    sqlite3_stmt *stmt = NULL;
+    if (digits[0] != '\0' &&
+        db_stmt_acquire(db, DB_STMT_SEARCH_DIGITS_PAGE, digits_sql, &stmt) == SQLITE_OK){
+        sqlite3_bind_text(stmt, 1, digits_pattern, -1, SQLITE_TRANSIENT);
+        return collect_page(db, stmt, after_id, limit, next_id);
     }
-    sqlite3_finalize(stmt);
-    return results; 
+    if (db_stmt_acquire(db, DB_STMT_SEARCH_PHONE_PAGE, sql, &stmt) != SQLITE_OK){
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
+        return NULL;
+    }
+
+    sqlite3_bind_text(stmt, 1, digits, -1, SQLITE_TRANSIENT);
+    return collect_page(db, stmt, after_id, limit, next_id);
 }
 
 /* ------------------------------------------------------------------ */
-/*  db_search_by_email                                                */
+/*  Change log reads                                                  */
 /* ------------------------------------------------------------------ */
-ContactList *db_search_by_email(sqlite3 *db, const char *pattern) {
-    if (pattern == NULL) return NULL;
-    
-    char like_pattern[256];
-    snprintf(like_pattern, sizeof(like_pattern), "%%%s%%", pattern);
-
-    // BUGFIX: SQL used ?2, must use ?1 if binding index 1
-    const char *sql = "SELECT id, name, phone, email FROM contacts WHERE email LIKE ?1 ORDER BY id";
+static int read_data_version(sqlite3 *db, int *version) {
     sqlite3_stmt *stmt = NULL;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK){
-        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
-        return NULL;
+    int rc = sqlite3_prepare_v2(db, "PRAGMA data_version", -1, &stmt, NULL);
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_step(stmt) == SQLITE_ROW ? SQLITE_OK : sqlite3_errcode(db);
+        *version = sqlite3_column_int(stmt, 0);
     }
+    sqlite3_finalize(stmt);
+    return rc;
+}
 
-    sqlite3_bind_text(stmt, 1, like_pattern, -1, SQLITE_STATIC);
-
-    ContactList *results = (ContactList *)malloc(sizeof(ContactList));
-    if (results == NULL){
-        sqlite3_finalize(stmt);
-        return NULL;
+// Oldest and newest seq in contacts_changes (0, 0 if empty)
+static int log_range(sqlite3 *db, sqlite3_int64 *oldest, sqlite3_int64 *newest) {
+    sqlite3_stmt *stmt = NULL;
+    int rc = db_stmt_acquire(db, DB_STMT_LOG_RANGE,
+                             "SELECT coalesce(min(seq), 0), coalesce(max(seq), 0) FROM contacts_changes",
+                             &stmt);
+    if (rc != SQLITE_OK) {
+        return rc;
     }
-    contact_list_init(results, 10);
+    rc = sqlite3_step(stmt) == SQLITE_ROW ? SQLITE_OK : sqlite3_errcode(db);
+    *oldest = sqlite3_column_int64(stmt, 0);
+    *newest = sqlite3_column_int64(stmt, 1);
+    db_stmt_release(db, stmt);
+    return rc;
+}
 
-    while (sqlite3_step(stmt) == SQLITE_ROW){
-        Contact contact;
-        contact.id = sqlite3_column_int(stmt, 0);
+int db_change_log_end(sqlite3 *db, sqlite3_int64 *seq) {
+    sqlite3_int64 oldest;
+    return log_range(db, &oldest, seq);
+}
 
-        strncpy(contact.name,  (const char *)sqlite3_column_text(stmt, 1), MAX_NAME_LEN - 1);
-        strncpy(contact.phone, (const char *)sqlite3_column_text(stmt, 2), MAX_PHONE_LEN - 1);
-        strncpy(contact.email, (const char *)sqlite3_column_text(stmt, 3), MAX_EMAIL_LEN - 1);
+int db_change_mark(sqlite3 *db, DbChangeMark *mark) {
+    sqlite3_int64 oldest;
+    int rc = read_data_version(db, &mark->data_version);
+    if (rc == SQLITE_OK) {
+        rc = log_range(db, &oldest, &mark->seq);
+    }
+    if (rc == SQLITE_OK) {
+        // Earlier writes of our own are in what the caller is loading
+        pthread_mutex_lock(&own_changes_lock);
+        own_changes.count = 0;
+        pthread_mutex_unlock(&own_changes_lock);
+    }
+    return rc;
+}
 
-        contact.name[MAX_NAME_LEN - 1]   = '\0';
-        contact.phone[MAX_PHONE_LEN - 1] = '\0';
-        contact.email[MAX_EMAIL_LEN - 1] = '\0';
+static int compare_ids(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
 
-        if (!contact_list_add(results, &contact)){
-            fprintf(stderr, "Error : Failed to add contact (id - %d) to list\n", contact.id);
-            contact_list_free(results);
-            free(results);
-            sqlite3_finalize(stmt);
-            return NULL;   // BUGFIX: missing return
+static bool push_id(int **ids, int *count, int *capacity, int id) {
+    if (*count == *capacity) {
+        int new_capacity = *capacity > 0 ? *capacity * 2 : 64;
+        int *new_ids = realloc(*ids, (size_t)new_capacity * sizeof(int));
+        if (new_ids == NULL) {
+            return false;
         }
+        *ids = new_ids;
+        *capacity = new_capacity;
     }
-    sqlite3_finalize(stmt);
-    return results; 
+    (*ids)[(*count)++] = id;
+    return true;
 }
 
-/* ------------------------------------------------------------------ */
-/*  db_search_by_phone                                                */
-/* ------------------------------------------------------------------ */
-ContactList *db_search_by_phone(sqlite3 *db, const char *pattern) {
-    if (pattern == NULL) return NULL;
-    
-    char like_pattern[256];
-    snprintf(like_pattern, sizeof(like_pattern), "%%%s%%", pattern);
+// Ids logged after 'since', added to 'ids'
+static int read_logged_ids(sqlite3 *db, sqlite3_int64 since, int **ids, int *count, int *capacity) {
+    sqlite3_stmt *stmt = NULL;
+    int rc = db_stmt_acquire(db, DB_STMT_LOG_READ, "SELECT id FROM contacts_changes WHERE seq > ?1", &stmt);
+    if (rc != SQLITE_OK) {
+        return rc;
+    }
+    sqlite3_bind_int64(stmt, 1, since);
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (!push_id(ids, count, capacity, sqlite3_column_int(stmt, 0))) {
+            rc = SQLITE_NOMEM;
+            break;
+        }
+    }
+    db_stmt_release(db, stmt);
+    return rc == SQLITE_DONE ? SQLITE_OK : rc;
+}
 
-    // BUGFIX: SQL used ?3, must be ?1 if binding index 1
-    const char *sql = "SELECT id, name, phone, email FROM contacts WHERE phone LIKE ?1 ORDER BY id";
+// Current row of each id (sorted, unique): into rows, or removed_ids
+static int fetch_changed(sqlite3 *db, const int ids[], int count, DbChanges *changes) {
     sqlite3_stmt *stmt = NULL;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK){
-        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
-        return NULL;
+    int rc = db_stmt_acquire(db, DB_STMT_LOAD_ONE,
+                             "SELECT id, name, phone, email FROM contacts WHERE id = ?1", &stmt);
+    if (rc != SQLITE_OK) {
+        return rc;
     }
 
-    sqlite3_bind_text(stmt, 1, like_pattern, -1, SQLITE_STATIC);
+    int removed_capacity = 0;
+    for (int i = 0; i < count && rc == SQLITE_OK; i++) {
+        sqlite3_bind_int(stmt, 1, ids[i]);
+        int step = sqlite3_step(stmt);
+        if (step == SQLITE_ROW) {
+            if (!contact_list_ensure_capacity(&changes->rows, changes->rows.size + 1)) {
+                rc = SQLITE_NOMEM;
+            } else {
+                decode_contact(stmt, &changes->rows.data[changes->rows.size]);
+                contact_list_commit_slots(&changes->rows, 1);
+            }
+        } else if (step == SQLITE_DONE) {
+            if (!push_id(&changes->removed_ids, &changes->removed_count, &removed_capacity, ids[i])) {
+                rc = SQLITE_NOMEM;
+            }
+        } else {
+            rc = step;
+        }
+        sqlite3_reset(stmt);
+    }
+    db_stmt_release(db, stmt);
+    return rc;
+}
 
-    ContactList *results = (ContactList *)malloc(sizeof(ContactList));
-    if (results == NULL){
-        sqlite3_finalize(stmt);
-        return NULL;
+int db_read_changes(sqlite3 *db, DbChangeMark *mark, DbChanges *changes) {
+    memset(changes, 0, sizeof(*changes));
+    if (db == NULL || mark == NULL || !contact_list_init(&changes->rows, 10)) {
+        return SQLITE_MISUSE;
+    }
+
+    // Ids written through this connection outside the list's own syncs
+    int *ids = NULL, count = 0, capacity = 0;
+    pthread_mutex_lock(&own_changes_lock);
+    int taken = own_changes.count;
+    bool own_ok = true;
+    for (int i = 0; i < taken && own_ok; i++) {
+        own_ok = push_id(&ids, &count, &capacity, own_changes.ids[i]);
+    }
+    pthread_mutex_unlock(&own_changes_lock);
+    if (!own_ok) {
+        free(ids);
+        return SQLITE_NOMEM;
     }
-    contact_list_init(results, 10);
 
-    while (sqlite3_step(stmt) == SQLITE_ROW){
-        Contact contact;
-        contact.id = sqlite3_column_int(stmt, 0);
+    // Version before the read snapshot: a commit after this point moves
+    // it again, so the next call looks even if this one misses it
+    int version_before, version_now;
+    sqlite3_int64 oldest = 0, newest = 0;
+    int rc = read_data_version(db, &version_before);
+    if (rc == SQLITE_OK) {
+        rc = exec_sql(db, "BEGIN;");
+    }
+    if (rc == SQLITE_OK) {
+        rc = log_range(db, &oldest, &newest);
+        if (rc == SQLITE_OK) {
+            rc = read_data_version(db, &version_now);
+        }
+        if (rc == SQLITE_OK && newest > mark->seq && version_now != mark->data_version) {
+            // Another connection committed. The log has to reach back to
+            // the mark, or rows in between cannot be known
+            if (oldest > mark->seq + 1) {
+                rc = SQLITE_NOTFOUND;
+            } else {
+                rc = read_logged_ids(db, mark->seq, &ids, &count, &capacity);
+            }
+        }
+        if (rc == SQLITE_OK && count > 0) {
+            qsort(ids, (size_t)count, sizeof(int), compare_ids);
+            int unique = 0;
+            for (int i = 0; i < count; i++) {
+                if (unique == 0 || ids[unique - 1] != ids[i]) {
+                    ids[unique++] = ids[i];
+                }
+            }
+            rc = fetch_changed(db, ids, unique, changes);
+        }
+        exec_sql(db, rc == SQLITE_OK ? "COMMIT;" : "ROLLBACK;");
+    }
+    free(ids);
 
-        strncpy(contact.name,  (const char *)sqlite3_column_text(stmt, 1), MAX_NAME_LEN - 1);
-        strncpy(contact.phone, (const char *)sqlite3_column_text(stmt, 2), MAX_PHONE_LEN - 1);
-        strncpy(contact.email, (const char *)sqlite3_column_text(stmt, 3), MAX_EMAIL_LEN - 1);
+    if (rc != SQLITE_OK) {
+        db_changes_free(changes);
+        return rc;
+    }
 
-        contact.name[MAX_NAME_LEN - 1]   = '\0';
-        contact.phone[MAX_PHONE_LEN - 1] = '\0';
-        contact.email[MAX_EMAIL_LEN - 1] = '\0';
+    // Newer entries are either read now or our own list syncs
+    mark->seq = newest > mark->seq ? newest : mark->seq;
+    mark->data_version = version_before;
+    pthread_mutex_lock(&own_changes_lock);
+    if (taken > 0 && taken <= own_changes.count) {
+        own_changes.count -= taken;
+        memmove(own_changes.ids, own_changes.ids + taken, (size_t)own_changes.count * sizeof(int));
+    }
+    pthread_mutex_unlock(&own_changes_lock);
+    return SQLITE_OK;
+}
 
-        if (!contact_list_add(results, &contact)){
-            fprintf(stderr, "Error : Failed to add contact (id - %d) to list\n", contact.id);
-            contact_list_free(results);
-            free(results);
-            sqlite3_finalize(stmt);
-            return NULL;   // BUGFIX: missing return
-        }
+void db_changes_free(DbChanges *changes) {
+    if (changes != NULL) {
+        contact_list_free(&changes->rows);
+        free(changes->removed_ids);
+        changes->removed_ids = NULL;
+        changes->removed_count = 0;
     }
-    sqlite3_finalize(stmt);
-    return results; 
 }
 
 /* ------------------------------------------------------------------ */
@@ -284,7 +1378,7 @@ int db_update_contact(sqlite3 *db, const Contact *contact) {
     const char *sql = "UPDATE contacts SET name=?1, phone=?2, email=?3 WHERE id=?4";
     sqlite3_stmt *stmt = NULL;
     
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (db_stmt_acquire(db, DB_STMT_UPDATE, sql, &stmt) != SQLITE_OK) {
         fprintf(stderr, "Update prepare error: %s\n", sqlite3_errmsg(db));
         return SQLITE_ERROR;
     }
@@ -299,18 +1393,19 @@ int db_update_contact(sqlite3 *db, const Contact *contact) {
         fprintf(stderr, "Update error: %s\n", sqlite3_errmsg(db));
     }
     
-    sqlite3_finalize(stmt);
+    db_stmt_release(db, stmt);
     return rc == SQLITE_DONE ? SQLITE_OK : rc;
 }
 
 /* ------------------------------------------------------------------ */
 /*  db_delete_contact                                                 */
 /* ------------------------------------------------------------------ */
+#define DELETE_CONTACT_SQL "DELETE FROM contacts WHERE id = ?1"
+
 int db_delete_contact(sqlite3 *db, int id) {
-    const char *sql = "DELETE FROM contacts WHERE id = ?1";
     sqlite3_stmt *stmt = NULL;
     
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+    if (db_stmt_acquire(db, DB_STMT_DELETE, DELETE_CONTACT_SQL, &stmt) != SQLITE_OK) {
         fprintf(stderr, "Delete prepare error: %s\n", sqlite3_errmsg(db));
         return SQLITE_ERROR;
     }
@@ -322,6 +1417,309 @@ int db_delete_contact(sqlite3 *db, int id) {
         fprintf(stderr, "Delete error: %s\n", sqlite3_errmsg(db));
     }
     
-    sqlite3_finalize(stmt);
+    db_stmt_release(db, stmt);
+    return rc == SQLITE_DONE ? SQLITE_OK : rc;
+}
+/* ------------------------------------------------------------------ */
+/*  db_save_batch                                                     */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    sqlite3_stmt *upsert;
+    sqlite3_stmt *remove;
+} SaveStmts;
+
+static int step_contact(sqlite3_stmt *stmt, const Contact *contact) {
+    sqlite3_bind_int(stmt,  1, contact->id);
+    sqlite3_bind_text(stmt, 2, contact->name,  -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, contact->phone, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, contact->email, -1, SQLITE_STATIC);
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    return rc;
+}
+
+// Writes one row; the triggers keep contacts_fts and contacts_changes in
+// step. Returns SQLITE_DONE on success.
+static int save_row(const SaveStmts *stmts, const Contact *contact) {
+    return step_contact(stmts->upsert, contact);
+}
+
+// One chunk inside an open transaction. Returns rows written, or -1 if
+// the transaction itself was lost (SQLite rolled it back).
+static int save_chunk(sqlite3 *db, const SaveStmts *stmts, const Contact contacts[], int count) {
+    // Fast path: every row under one savepoint
+    exec_sql(db, "SAVEPOINT chunk;");
+    int i = 0;
+    while (i < count && save_row(stmts, &contacts[i]) == SQLITE_DONE) {
+        i++;
+    }
+    if (i == count) {
+        exec_sql(db, "RELEASE chunk;");
+        return count;
+    }
+
+    fprintf(stderr, "Error : Saving contact ID %d failed (%s), retrying its chunk row by row\n",
+            contacts[i].id, sqlite3_errmsg(db));
+    if (sqlite3_get_autocommit(db)) {
+        return -1; // I/O error, disk full ... - nothing left to retry in
+    }
+    exec_sql(db, "ROLLBACK TO chunk;");
+    exec_sql(db, "RELEASE chunk;");
+
+    // Slow path: one savepoint per row, so a bad row only loses itself
+    int saved = 0;
+    for (i = 0; i < count; i++) {
+        exec_sql(db, "SAVEPOINT row;");
+        if (save_row(stmts, &contacts[i]) == SQLITE_DONE) {
+            exec_sql(db, "RELEASE row;");
+            saved++;
+            continue;
+        }
+        fprintf(stderr, "Failed to save contact ID %d: %s\n", contacts[i].id, sqlite3_errmsg(db));
+        if (sqlite3_get_autocommit(db)) {
+            return -1;
+        }
+        exec_sql(db, "ROLLBACK TO row;");
+        exec_sql(db, "RELEASE row;");
+    }
+    return saved;
+}
+
+// Returns SQLITE_DONE on success (also when the row is not there)
+static int delete_row(const SaveStmts *stmts, int id) {
+    sqlite3_bind_int(stmts->remove, 1, id);
+    int rc = sqlite3_step(stmts->remove);
+    sqlite3_reset(stmts->remove);
+    return rc;
+}
+
+static void release_save_stmts(sqlite3 *db, SaveStmts *stmts) {
+    db_stmt_release(db, stmts->upsert);
+    db_stmt_release(db, stmts->remove);
+}
+
+static int acquire_save_stmts(sqlite3 *db, SaveStmts *stmts) {
+    // An upsert rather than INSERT OR REPLACE: REPLACE deletes the old row
+    // without firing delete triggers, which would leave contacts_fts stale.
+    // Rows that are already up to date are not rewritten (nor reindexed
+    // or logged).
+    const char *sql =
+        "INSERT INTO contacts (id, name, phone, email) VALUES (?1, ?2, ?3, ?4) "
+        "ON CONFLICT(id) DO UPDATE SET "
+        "name = excluded.name, phone = excluded.phone, email = excluded.email "
+        "WHERE name IS NOT excluded.name OR phone IS NOT excluded.phone "
+        "OR email IS NOT excluded.email;";
+    memset(stmts, 0, sizeof(*stmts));
+    if (db_stmt_acquire(db, DB_STMT_SAVE, sql, &stmts->upsert) != SQLITE_OK ||
+        db_stmt_acquire(db, DB_STMT_DELETE, DELETE_CONTACT_SQL, &stmts->remove) != SQLITE_OK) {
+        fprintf(stderr, "Save prepare error: %s\n", sqlite3_errmsg(db));
+        release_save_stmts(db, stmts);
+        return SQLITE_ERROR;
+    }
+    return SQLITE_OK;
+}
+
+// The triggers stay in place: dropping and recreating them would change
+// the schema and invalidate every prepared statement on every connection,
+// in this process and others. They cost a bulk save (FTS5 flushes a
+// segment per row statement), a price paid once per changed row.
+static int begin_save(sqlite3 *db) {
+    return exec_sql(db, "BEGIN IMMEDIATE;") == SQLITE_OK ? SQLITE_OK : SQLITE_ERROR;
+}
+
+// Readers whose mark falls behind the kept entries reload in full
+static void prune_change_log(sqlite3 *db) {
+    sqlite3_stmt *stmt = NULL;
+    if (db_stmt_acquire(db, DB_STMT_LOG_PRUNE,
+                        "DELETE FROM contacts_changes "
+                        "WHERE seq <= (SELECT max(seq) FROM contacts_changes) - ?1", &stmt) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, DB_CHANGE_LOG_KEEP);
+        sqlite3_step(stmt); // no log table is fine
+        db_stmt_release(db, stmt);
+    }
+}
+
+// Commits; rolls back if that fails
+static int finish_save(sqlite3 *db) {
+    prune_change_log(db);
+    if (exec_sql(db, "COMMIT;") == SQLITE_OK) {
+        return SQLITE_OK;
+    }
+    if (!sqlite3_get_autocommit(db)) {
+        exec_sql(db, "ROLLBACK;");
+    }
+    return SQLITE_ERROR;
+}
+
+int db_save_batch(sqlite3 *db, const Contact contacts[], int count, int chunk_size,
+                  DbProgressFn progress, void *ctx) {
+    if (db == NULL || (contacts == NULL && count > 0) || count < 0) {
+        return -1;
+    }
+    if (chunk_size <= 0) {
+        chunk_size = DB_BATCH_CHUNK;
+    }
+
+    // Prepared once, reset per row
+    SaveStmts stmts;
+    if (acquire_save_stmts(db, &stmts) != SQLITE_OK) {
+        return -1;
+    }
+
+    // One transaction (one journal sync) per chunk instead of per row
+    int saved = 0;
+    for (int first = 0; first < count; first += chunk_size) {
+        int n = (count - first < chunk_size) ? count - first : chunk_size;
+
+        if (begin_save(db) != SQLITE_OK) {
+            saved = -1;
+            break;
+        }
+        int chunk_saved = save_chunk(db, &stmts, contacts + first, n);
+        if (chunk_saved < 0 || finish_save(db) != SQLITE_OK) {
+            saved = -1;
+            break;
+        }
+
+        saved += chunk_saved;
+        if (progress != NULL) {
+            progress(first + n, count, ctx);
+        }
+    }
+
+    release_save_stmts(db, &stmts);
+    return saved;
+}
+
+/* ------------------------------------------------------------------ */
+/*  db_sync                                                           */
+/* ------------------------------------------------------------------ */
+int db_sync(sqlite3 *db, const Contact changed[], int changed_count,
+            const int deleted_ids[], int deleted_count, DbChangeMark *mark) {
+    if (db == NULL || changed_count < 0 || deleted_count < 0 ||
+        (changed == NULL && changed_count > 0) || (deleted_ids == NULL && deleted_count > 0)) {
+        return -1;
+    }
+
+    SaveStmts stmts;
+    if (acquire_save_stmts(db, &stmts) != SQLITE_OK) {
+        return -1;
+    }
+    if (begin_save(db) != SQLITE_OK) {
+        release_save_stmts(db, &stmts);
+        return -1;
+    }
+
+    // The log's end before and after our writes; nobody else can write
+    // in between (BEGIN IMMEDIATE holds the write lock)
+    sqlite3_int64 oldest, seq_before = 0, seq_after = 0;
+    bool track_mark = mark != NULL && log_range(db, &oldest, &seq_before) == SQLITE_OK;
+
+    // All or nothing: a caller keeps its change set if this fails
+    int written = 0;
+    for (int i = 0; i < changed_count; i++) {
+        if (save_row(&stmts, &changed[i]) != SQLITE_DONE) {
+            fprintf(stderr, "Error : Syncing contact ID %d failed: %s\n", changed[i].id, sqlite3_errmsg(db));
+            written = -1;
+            break;
+        }
+        written++;
+    }
+    for (int i = 0; written >= 0 && i < deleted_count; i++) {
+        if (delete_row(&stmts, deleted_ids[i]) != SQLITE_DONE) {
+            fprintf(stderr, "Error : Deleting contact ID %d failed: %s\n", deleted_ids[i], sqlite3_errmsg(db));
+            written = -1;
+            break;
+        }
+        written++;
+    }
+
+    track_mark = track_mark && written >= 0 && log_range(db, &oldest, &seq_after) == SQLITE_OK;
+
+    if (written < 0) {
+        if (!sqlite3_get_autocommit(db)) {
+            exec_sql(db, "ROLLBACK;");
+        }
+    } else if (finish_save(db) != SQLITE_OK) {
+        written = -1;
+    } else if (track_mark && mark->seq == seq_before) {
+        mark->seq = seq_after; // nothing foreign in between
+    }
+    release_save_stmts(db, &stmts);
+    return written;
+}
+
+/* ------------------------------------------------------------------ */
+/*  db_upsert_contact                                                 */
+/* ------------------------------------------------------------------ */
+int db_upsert_contact(sqlite3 *db, const Contact *contact) {
+    if (contact == NULL) {
+        return SQLITE_ERROR;
+    }
+    SaveStmts stmts;
+    if (acquire_save_stmts(db, &stmts) != SQLITE_OK) {
+        return SQLITE_ERROR;
+    }
+    int rc = save_row(&stmts, contact);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error : Saving contact ID %d failed: %s\n", contact->id, sqlite3_errmsg(db));
+    }
+    release_save_stmts(db, &stmts);
     return rc == SQLITE_DONE ? SQLITE_OK : rc;
-}
\ No newline at end of file
+}
+
+/* ------------------------------------------------------------------ */
+/*  db_delete_missing                                                 */
+/* ------------------------------------------------------------------ */
+int db_delete_missing(sqlite3 *db, const Contact contacts[], int count) {
+    if (db == NULL || count < 0 || (contacts == NULL && count > 0)) {
+        return -1;
+    }
+
+    int *keep = malloc((size_t)(count > 0 ? count : 1) * sizeof(int));
+    if (keep == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        keep[i] = contacts[i].id;
+    }
+    qsort(keep, (size_t)count, sizeof(int), compare_ids);
+
+    // Merge the sorted ids against the table, which is read in id order
+    int *missing = NULL;
+    int missing_count = 0, missing_capacity = 0;
+    sqlite3_stmt *stmt = NULL;
+    int rc = sqlite3_prepare_v2(db, "SELECT id FROM contacts ORDER BY id", -1, &stmt, NULL);
+    int k = 0;
+    while (rc == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+        while (k < count && keep[k] < id) {
+            k++;
+        }
+        if (k < count && keep[k] == id) {
+            continue;
+        }
+        if (missing_count == missing_capacity) {
+            int new_capacity = missing_capacity > 0 ? missing_capacity * 2 : 64;
+            int *grown = realloc(missing, (size_t)new_capacity * sizeof(int));
+            if (grown == NULL) {
+                rc = SQLITE_NOMEM;
+                break;
+            }
+            missing = grown;
+            missing_capacity = new_capacity;
+        }
+        missing[missing_count++] = id;
+    }
+    sqlite3_finalize(stmt);
+    free(keep);
+
+    int deleted = -1;
+    if (rc == SQLITE_OK) {
+        deleted = missing_count > 0 ? db_sync(db, NULL, 0, missing, missing_count, NULL) : 0;
+    } else {
+        fprintf(stderr, "Error : %s\n", sqlite3_errmsg(db));
+    }
+    free(missing);
+    return deleted;
+}
@@ -6,32 +6,184 @@
 
 #define DB_FILENAME "contacts.db"
 
-// Opens the database and ensures the contacts table exists.
+// Connection settings applied by db_open. Three presets trade durability
+// for speed:
+//   durable    WAL, synchronous=FULL   - every commit survives power loss
+//   balanced   WAL, synchronous=NORMAL - survives crashes; a power cut may
+//              drop the last commits, never corrupts (the default)
+//   bulk-load  WAL, synchronous=OFF, big cache - for imports; a power cut
+//              may corrupt the database
+typedef struct DbTuning {
+    const char *name;
+    int wal;              // 1 = journal_mode=WAL, 0 = rollback journal (DELETE)
+    int synchronous;      // 0 OFF, 1 NORMAL, 2 FULL, 3 EXTRA
+    long long mmap_size;  // bytes of the file read through mmap, 0 = off
+    int cache_size;       // PRAGMA cache_size: pages, or -KiB if negative
+    int temp_store;       // 0 default, 1 file, 2 memory
+    int page_size;        // bytes; only takes effect for a new database, 0 = default
+    int busy_timeout_ms;  // wait this long for a lock before SQLITE_BUSY
+} DbTuning;
+
+extern const DbTuning DB_TUNING_DURABLE;
+extern const DbTuning DB_TUNING_BALANCED;
+extern const DbTuning DB_TUNING_BULK_LOAD;
+
+// Preset by name ("durable", "balanced", "bulk-load"), or NULL.
+const DbTuning *db_tuning_by_name(const char *name);
+
+// Opens the database with 'tuning' (NULL = balanced) and ensures the
+// contacts table exists.
 // Returns SQLITE_OK on success, otherwise an error code.
-int db_open(sqlite3 **db);
+int db_open(sqlite3 **db, const DbTuning *tuning);
+
+// Opens a read-only connection to a database db_open has set up, with
+// the cache settings of 'tuning' (NULL = balanced). It is opened without
+// a mutex, so it must be used by one thread at a time. In WAL mode it
+// reads alongside a writing connection without blocking it.
+int db_open_reader(sqlite3 **db, const DbTuning *tuning);
+
+// Adds the SQL functions digits(x), rdigits(x) (digits reversed),
+// casefold(x) and contains_ci(a, b), which normalize and match as
+// extract_digits and the contact_*_matches functions do. db_open and
+// db_open_reader call it; other connections to the file need it before
+// using them - the phone columns are generated by digits() and rdigits().
+// Returns SQLITE_OK on success.
+int db_register_functions(sqlite3 *db);
+
+// Applies 'tuning' to an open connection. Returns SQLITE_OK on success.
+int db_apply_tuning(sqlite3 *db, const DbTuning *tuning);
 
 // Closes the database connection.
 void db_close(sqlite3 *db);
 
-// Creates the contacts table if it doesn't already exist.
+// Creates the contacts table if it doesn't already exist, with its
+// search index.
 int db_create_table(sqlite3 *db);
 
+// Adds the generated columns phone_digits (digits(phone)) and
+// phone_rdigits (rdigits(phone)) and indexes phone_rdigits; the index
+// build fills in existing rows. Columns an older version generated from
+// built-ins are rebuilt. No-op once done. Returns SQLITE_OK on success.
+int db_create_phone_index(sqlite3 *db);
+
+// Creates contacts_fts, an FTS5 trigram index over name and email kept in
+// sync by triggers, and indexes existing rows. No-op if it exists.
+// Needs SQLite built with SQLITE_ENABLE_FTS5. Returns SQLITE_OK on success.
+int db_create_search_index(sqlite3 *db);
+
+// Change log: triggers append the id of every contact inserted, updated or
+// deleted to contacts_changes, whichever connection or process writes it.
+// Saves trim it to the newest DB_CHANGE_LOG_KEEP entries. No-op once done.
+int db_create_change_log(sqlite3 *db);
+
+#define DB_CHANGE_LOG_KEEP 100000
+
+// Where a loaded copy of the table stands in the log.
+typedef struct DbChangeMark {
+    sqlite3_int64 seq; // newest log entry the copy reflects
+    int data_version;  // PRAGMA data_version when it was taken
+} DbChangeMark;
+
+// What changed since a mark: current rows, and ids that are gone.
+typedef struct DbChanges {
+    ContactList rows;  // ascending id
+    int *removed_ids;  // ascending
+    int removed_count;
+} DbChanges;
+
+// Registers sqlite3_update_hook on 'db' (NULL = stop) to note the ids it
+// writes itself - its own commits leave its data_version alone. One
+// connection at a time; db_close unregisters it.
+void db_watch_changes(sqlite3 *db);
+
+// Pauses (false) or resumes noting writes, for writes that come from the
+// copy being kept up to date anyway.
+void db_record_changes(bool on);
+
+// Current end of the log. Take it in the same transaction as the load.
+int db_change_mark(sqlite3 *db, DbChangeMark *mark);
+
+// Newest seq in the change log (0 if empty), without touching the own-
+// changes record. Inside a write transaction it brackets what that
+// transaction logs.
+int db_change_log_end(sqlite3 *db, sqlite3_int64 *seq);
+
+// Rows changed since 'mark' - by other connections (data_version moved)
+// or noted by the update hook - read in one transaction, and moves
+// 'mark' forward. Returns SQLITE_OK, SQLITE_NOTFOUND if the log was
+// trimmed past the mark (reload instead) or an error code.
+int db_read_changes(sqlite3 *db, DbChangeMark *mark, DbChanges *changes);
+void db_changes_free(DbChanges *changes);
+
 // Inserts a single contact. The id is assigned by SQLite.
 // Returns SQLITE_OK on success.
 int db_insert_contact(sqlite3 *db, const Contact *contact);
 
-// Loads all contacts from the DB into the given ContactList.
+// Loads all contacts from the DB into the given ContactList, sized once
+// from db_count_contacts and decoded straight into its slots.
 // Returns the number of contacts loaded, or -1 on error.
 int db_load_all_contacts(sqlite3 *db, ContactList *list);
 
-// Searches for contacts by name (LIKE %pattern%).
+// Number of rows in contacts, or -1 on error.
+int db_count_contacts(sqlite3 *db);
+
+// Streams every contact in id order. Each field is copied once, from
+// SQLite's buffer into the caller's Contact (sqlite3_column_bytes long,
+// not padded), so rows can be decoded directly into list storage.
+typedef struct DbCursor {
+    sqlite3 *db;
+    sqlite3_stmt *stmt;
+    int rc; // last sqlite3_step result
+} DbCursor;
+
+int db_cursor_open(sqlite3 *db, DbCursor *cursor);          // SQLITE_OK on success
+// Cursor over any "SELECT id, name, phone, email ..." (the query builder's).
+// The statement is cached per connection by its SQL text; bind parameters
+// on cursor->stmt before the first step. Prints nothing on failure -
+// see sqlite3_errmsg.
+int db_cursor_open_sql(sqlite3 *db, DbCursor *cursor, const char *sql);
+int db_cursor_step(DbCursor *cursor);                       // 1 = row, 0 = done, -1 = error
+void db_cursor_read(const DbCursor *cursor, Contact *contact); // Decodes the current row
+int db_cursor_next(DbCursor *cursor, Contact *contact);    // Step + read
+void db_cursor_close(DbCursor *cursor);                     // Always call, also after errors
+
+// Contacts whose name contains 'pattern', ignoring ASCII case - decided by
+// contains_ci, so '%' and '_' are plain characters and an empty pattern
+// matches nothing (as contact_name_matches). ASCII patterns of 3+ characters
+// without '%' or '_' are narrowed through the contacts_fts trigram index
+// first; any other pattern scans the table.
 // Returns a newly allocated ContactList (caller must free), or NULL on error.
 ContactList *db_search_by_name(sqlite3 *db, const char *pattern);
 
+// Same as db_search_by_name, on email.
 ContactList *db_search_by_email(sqlite3 *db, const char *pattern);
 
+// Contacts whose phone digits contain the digits of 'pattern', formatting
+// ignored. Scans the phone_rdigits index; a pattern without digits tests
+// digits(phone) row by row and, like contact_phone_matches, matches every phone.
 ContactList *db_search_by_phone(sqlite3 *db, const char *pattern);
 
+// Contacts whose phone has exactly the digits of 'phone', whatever the
+// formatting. An index lookup on phone_rdigits.
+ContactList *db_find_by_phone(sqlite3 *db, const char *phone);
+
+// Contacts whose phone digits end with the digits of 'suffix'. An index
+// range scan on phone_rdigits.
+ContactList *db_search_by_phone_suffix(sqlite3 *db, const char *suffix);
+
+// Paged forms of the three searches: at most 'limit' matches with an id
+// above 'after_id', in id order (limit <= 0 means DB_PAGE_SIZE). Start
+// with after_id = 0; *next_id (may be NULL) receives the after_id of the
+// following page, or 0 once this page was the last (one row past 'limit'
+// is read to tell, so an exactly full last page says so). Memory stays at one
+// page however broad the pattern, and rows written between pages are
+// picked up if their id is past the position.
+#define DB_PAGE_SIZE 100
+
+ContactList *db_search_by_name_page(sqlite3 *db, const char *pattern, int after_id, int limit, int *next_id);
+ContactList *db_search_by_email_page(sqlite3 *db, const char *pattern, int after_id, int limit, int *next_id);
+ContactList *db_search_by_phone_page(sqlite3 *db, const char *pattern, int after_id, int limit, int *next_id);
+
 // Updates a contact by id.
 // Returns SQLITE_OK on success.
 int db_update_contact(sqlite3 *db, const Contact *contact);
@@ -40,4 +192,36 @@ int db_update_contact(sqlite3 *db, const Contact *contact);
 // Returns SQLITE_OK on success.
 int db_delete_contact(sqlite3 *db, int id);
 
+// Called after each committed chunk of db_save_batch.
+typedef void (*DbProgressFn)(int done, int total, void *ctx);
+
+#define DB_BATCH_CHUNK 10000 // rows per transaction when chunk_size <= 0
+
+// Inserts or replaces 'count' contacts, keeping their ids. Each chunk of
+// 'chunk_size' rows is one transaction; a row that fails is retried on
+// its own (savepoints), so only that row is lost. Rows already up to date
+// are skipped; every other row fires the contacts_fts and change-log
+// triggers, which cost several times the insert itself (see README).
+// Returns the number of rows written, or -1 if a chunk could not be
+// committed (earlier chunks stay committed).
+int db_save_batch(sqlite3 *db, const Contact contacts[], int count, int chunk_size,
+                  DbProgressFn progress, void *ctx);
+
+// Inserts 'contact' under its own id, or overwrites the row with that id
+// (an upsert: the FTS and change-log triggers fire as for an update, and
+// an unchanged row is not rewritten). Returns SQLITE_OK on success.
+int db_upsert_contact(sqlite3 *db, const Contact *contact);
+
+// Upserts 'changed' and deletes 'deleted_ids' in a single transaction.
+// If 'mark' (may be NULL) was at the end of the change log when the
+// transaction began, it is moved past the entries this sync logs, so a
+// later db_read_changes does not return rows the caller wrote itself.
+// Returns the number of rows written and deleted, or -1 (nothing written).
+int db_sync(sqlite3 *db, const Contact changed[], int changed_count,
+            const int deleted_ids[], int deleted_count, DbChangeMark *mark);
+
+// Deletes every row whose id is not in 'contacts', in one transaction.
+// Returns the number deleted, or -1 on error.
+int db_delete_missing(sqlite3 *db, const Contact contacts[], int count);
+
 #endif
\ No newline at end of file
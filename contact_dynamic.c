@@ -16,7 +16,7 @@
 // GLOBAL VARIABLES - FOR DYNAMIC
 // ============================================================================
 int next_contact_id = 1;
-ContactList contact_list = {NULL, 0, 0};
+ContactList contact_list = {NULL, 0, 0, NULL, NULL, 0, 0};
 
 // ============================================================================
 // DYNAMIC ARRAY IMPLEMENTATION
@@ -42,6 +42,10 @@ bool contact_list_init(ContactList *list, int initial_capacity)
 
     list->size = 0;
     list->capacity = initial_capacity;
+    list->state = NULL; // No change tracking until asked for
+    list->deleted_ids = NULL;
+    list->deleted_count = 0;
+    list->deleted_capacity = 0;
     return true; // Successful
 }
 
@@ -72,8 +76,20 @@ bool contact_list_ensure_capacity(ContactList *list, int min_capacity)
         return false; // Fail
     }
 
-    // Success
     list->data = new_data;
+
+    // Tracked list -> state array grows alongside
+    if (list->state != NULL)
+    {
+        unsigned char *new_state = realloc(list->state, new_capacity);
+        if (new_state == NULL)
+        {
+            return false; // data grew, capacity did not -> still consistent
+        }
+        list->state = new_state;
+    }
+
+    // Success
     list->capacity = new_capacity;
     return true;
 }
@@ -89,6 +105,8 @@ void contact_list_free(ContactList *list)
     list->data = NULL;
     list->capacity = 0;
     list->size = 0;
+
+    contact_list_stop_tracking(list);
 }
 
 bool contact_list_add(ContactList *list, const Contact *contact)
@@ -107,8 +125,50 @@ bool contact_list_add(ContactList *list, const Contact *contact)
     }
 
     list->data[list->size] = *contact; // list->size is index
-    list->size++;                      // Index increment
-    return true;                       // Sucess
+    if (list->state != NULL)
+    {
+        list->state[list->size] = CONTACT_STATE_NEW;
+    }
+    list->size++; // Index increment
+    return true;  // Sucess
+}
+
+bool contact_list_add_batch(ContactList *list, const Contact contacts[], int count)
+{
+    if (list == NULL || contacts == NULL || count < 0)
+    {
+        return false;
+    }
+
+    // Grow once for the whole batch instead of once per contact
+    if (!contact_list_ensure_capacity(list, list->size + count))
+    {
+        return false;
+    }
+
+    memcpy(&list->data[list->size], contacts, (size_t)count * sizeof(Contact));
+    if (list->state != NULL)
+    {
+        memset(&list->state[list->size], CONTACT_STATE_NEW, (size_t)count);
+    }
+    list->size += count;
+    return true;
+}
+
+// For callers that fill data[size..] themselves (after ensuring capacity),
+// e.g. decoding database rows in place: no second copy of each contact
+void contact_list_commit_slots(ContactList *list, int count)
+{
+    if (list == NULL || count <= 0 || list->size + count > list->capacity)
+    {
+        return;
+    }
+
+    if (list->state != NULL)
+    {
+        memset(&list->state[list->size], CONTACT_STATE_NEW, (size_t)count);
+    }
+    list->size += count;
 }
 
 bool contact_list_remove_by_id(ContactList *list, int id)
@@ -124,19 +184,42 @@ bool contact_list_remove_by_id(ContactList *list, int id)
         return false;
     }
 
-    // Shift Everything after removed contact by 1
-    for (int i = index; i < list->size - 1; i++)
+    return contact_list_remove_by_index(list, index);
+}
+
+// Remembers a removed id for the next sync. A contact added since the
+// last sync was never written, so there is nothing to delete.
+static bool record_removal(ContactList *list, int index)
+{
+    if (list->state[index] & CONTACT_STATE_NEW)
     {
-        list->data[i] = list->data[i + 1];
+        return true;
     }
 
-    list->size--; // Decrement
+    if (list->deleted_count == list->deleted_capacity)
+    {
+        int new_capacity = list->deleted_capacity > 0 ? list->deleted_capacity * 2 : 16;
+        int *new_ids = realloc(list->deleted_ids, (size_t)new_capacity * sizeof(int));
+        if (new_ids == NULL)
+        {
+            return false;
+        }
+        list->deleted_ids = new_ids;
+        list->deleted_capacity = new_capacity;
+    }
+    list->deleted_ids[list->deleted_count++] = list->data[index].id;
     return true;
 }
 
 bool contact_list_remove_by_index(ContactList* list, int index) {
     if (list == NULL || index < 0 || index >= list->size) 
         return false;
+
+    if (list->state != NULL) {
+        if (!record_removal(list, index))
+            return false; // Out of memory -> keep the contact rather than lose the delete
+        memmove(&list->state[index], &list->state[index + 1], (size_t)(list->size - index - 1));
+    }
     
     for (int i = index; i < list->size - 1; i++) {
         list->data[i] = list->data[i + 1];
@@ -145,6 +228,225 @@ bool contact_list_remove_by_index(ContactList* list, int index) {
     list->size--;
     return true;
 }
+
+static bool ids_ascending(const int ids[], int count)
+{
+    for (int i = 1; i < count; i++)
+    {
+        if (ids[i - 1] >= ids[i])
+            return false;
+    }
+    return true;
+}
+
+bool contact_list_apply_rows(ContactList *list, const Contact rows[], int row_count,
+                             const int removed_ids[], int removed_count)
+{
+    if (list == NULL || row_count < 0 || removed_count < 0 ||
+        (rows == NULL && row_count > 0) || (removed_ids == NULL && removed_count > 0) ||
+        !ids_ascending(removed_ids, removed_count))
+    {
+        return false;
+    }
+    for (int i = 1; i < row_count; i++)
+    {
+        if (rows[i - 1].id >= rows[i].id)
+            return false;
+    }
+    for (int i = 1; i < list->size; i++)
+    {
+        if (list->data[i - 1].id >= list->data[i].id)
+            return false; // not in id order - caller reloads instead
+    }
+
+    // Room for every row as an insert, so nothing fails halfway
+    if (!contact_list_ensure_capacity(list, list->size + row_count))
+    {
+        return false;
+    }
+
+    // Pass 1, forward: drop removed ids, overwrite rows that exist
+    int kept = 0, r = 0, d = 0;
+    for (int i = 0; i < list->size; i++)
+    {
+        int id = list->data[i].id;
+        while (d < removed_count && removed_ids[d] < id)
+            d++;
+        if (d < removed_count && removed_ids[d] == id)
+            continue;
+
+        while (r < row_count && rows[r].id < id)
+            r++;
+        list->data[kept] = (r < row_count && rows[r].id == id) ? rows[r] : list->data[i];
+        if (list->state != NULL)
+        {
+            list->state[kept] = (r < row_count && rows[r].id == id) ? 0 : list->state[i];
+        }
+        kept++;
+    }
+
+    // Pass 2, backward: merge in the rows that did not exist
+    int inserts = 0;
+    for (int i = 0, j = 0; i < row_count; i++)
+    {
+        while (j < kept && list->data[j].id < rows[i].id)
+            j++;
+        if (j == kept || list->data[j].id != rows[i].id)
+            inserts++;
+    }
+
+    int i = kept - 1, k = kept + inserts - 1;
+    for (r = row_count - 1; r >= 0; r--)
+    {
+        while (i >= 0 && list->data[i].id > rows[r].id)
+        {
+            list->data[k] = list->data[i];
+            if (list->state != NULL)
+                list->state[k] = list->state[i];
+            i--;
+            k--;
+        }
+        if (i >= 0 && list->data[i].id == rows[r].id)
+            continue; // updated in pass 1
+        list->data[k] = rows[r];
+        if (list->state != NULL)
+            list->state[k] = 0;
+        k--;
+    }
+    list->size = kept + inserts;
+    return true;
+}
+
+// ============================================================================
+// CHANGE TRACKING
+// ============================================================================
+
+bool contact_list_track_changes(ContactList *list)
+{
+    if (list == NULL)
+    {
+        return false;
+    }
+
+    if (list->state == NULL)
+    {
+        list->state = malloc(list->capacity > 0 ? (size_t)list->capacity : 1);
+        if (list->state == NULL)
+        {
+            return false;
+        }
+    }
+    contact_list_clear_changes(list);
+    return true;
+}
+
+void contact_list_stop_tracking(ContactList *list)
+{
+    if (list == NULL)
+    {
+        return;
+    }
+    free(list->state);
+    free(list->deleted_ids);
+    list->state = NULL;
+    list->deleted_ids = NULL;
+    list->deleted_count = 0;
+    list->deleted_capacity = 0;
+}
+
+bool contact_list_copy(ContactList *dst, const ContactList *src)
+{
+    if (dst == NULL || src == NULL)
+    {
+        return false;
+    }
+
+    if (src->state == NULL)
+    {
+        contact_list_stop_tracking(dst);
+    }
+    else if (dst->state == NULL && !contact_list_track_changes(dst))
+    {
+        return false;
+    }
+
+    if (!contact_list_ensure_capacity(dst, src->size))
+    {
+        return false;
+    }
+    if (src->size > 0)
+    {
+        memcpy(dst->data, src->data, (size_t)src->size * sizeof(Contact));
+    }
+    dst->size = src->size;
+
+    if (src->state != NULL)
+    {
+        if (src->deleted_count > dst->deleted_capacity)
+        {
+            int *new_ids = realloc(dst->deleted_ids, (size_t)src->deleted_count * sizeof(int));
+            if (new_ids == NULL)
+            {
+                return false;
+            }
+            dst->deleted_ids = new_ids;
+            dst->deleted_capacity = src->deleted_count;
+        }
+        if (src->size > 0)
+        {
+            memcpy(dst->state, src->state, (size_t)src->size);
+        }
+        if (src->deleted_count > 0)
+        {
+            memcpy(dst->deleted_ids, src->deleted_ids, (size_t)src->deleted_count * sizeof(int));
+        }
+        dst->deleted_count = src->deleted_count;
+    }
+    return true;
+}
+
+void contact_list_mark_dirty(ContactList *list, int index)
+{
+    if (list == NULL || list->state == NULL || index < 0 || index >= list->size)
+    {
+        return;
+    }
+    list->state[index] |= CONTACT_STATE_DIRTY;
+}
+
+bool contact_list_has_changes(const ContactList *list)
+{
+    return list != NULL && list->state != NULL &&
+           (list->deleted_count > 0 || contact_list_changed_count(list) > 0);
+}
+
+int contact_list_changed_count(const ContactList *list)
+{
+    if (list == NULL || list->state == NULL)
+    {
+        return 0;
+    }
+
+    int count = 0;
+    for (int i = 0; i < list->size; i++)
+    {
+        count += list->state[i] != 0;
+    }
+    return count;
+}
+
+void contact_list_clear_changes(ContactList *list)
+{
+    if (list == NULL || list->state == NULL)
+    {
+        return;
+    }
+    if (list->capacity > 0)
+    {
+        memset(list->state, 0, (size_t)list->capacity);
+    }
+    list->deleted_count = 0;
+}
 // ============================================================================
 // CONTACT CREATION - DONE
 // ============================================================================
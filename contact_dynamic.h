@@ -32,11 +32,21 @@ typedef struct
     int id;
 } Contact;
 
+// Change tracking bits in ContactList.state
+#define CONTACT_STATE_NEW 0x01   // added since the last sync
+#define CONTACT_STATE_DIRTY 0x02 // edited since the last sync
+
 typedef struct
 {
     Contact *data; // Dynamic array
     int size;      // Contacts stored
     int capacity;  // Memory allocated
+
+    // Change tracking - all NULL / 0 until contact_list_track_changes()
+    unsigned char *state; // CONTACT_STATE_* per contact, parallel to data
+    int *deleted_ids;     // removed since the last sync
+    int deleted_count;
+    int deleted_capacity;
 } ContactList;
 
 // ============================================================================
@@ -57,10 +67,31 @@ void contact_list_free(ContactList *list);
 
 // CRUD for ContactList
 bool contact_list_add(ContactList *list, const Contact *contact);
+bool contact_list_add_batch(ContactList *list, const Contact contacts[], int count); // One grow + copy
+void contact_list_commit_slots(ContactList *list, int count); // Counts contacts written in place past size
 bool contact_list_remove_by_id(ContactList *list, int id);
 bool contact_list_update_by_id(ContactList *list, int id, const Contact *updates);
 bool contact_list_remove_by_index(ContactList *list, int index);
 
+// Brings a list in ascending id order (as loaded from the database) up to
+// date with stored rows: each row replaces the contact with its id or is
+// inserted in order; removed ids are dropped. Not recorded as changes.
+// Both arrays ascend by id. Returns false, list untouched, if the list is
+// not in id order or out of memory.
+bool contact_list_apply_rows(ContactList *list, const Contact rows[], int row_count,
+                             const int removed_ids[], int removed_count);
+
+// Change tracking (what a database sync has to write). Once on, adds are
+// marked new and removals remember their id; direct edits to data[] must
+// call contact_list_mark_dirty.
+bool contact_list_track_changes(ContactList *list); // Starts with every contact clean
+void contact_list_stop_tracking(ContactList *list);
+bool contact_list_copy(ContactList *dst, const ContactList *src); // Contacts + change set
+void contact_list_mark_dirty(ContactList *list, int index);
+bool contact_list_has_changes(const ContactList *list);
+int contact_list_changed_count(const ContactList *list); // New + dirty contacts
+void contact_list_clear_changes(ContactList *list);
+
 // Search in ContactList (NEW)
 int contact_find_by_id_in_list(const ContactList *list, int id);
 int contact_find_by_name_in_list(const ContactList *list, const char *name, int results[]);
@@ -1,7 +1,12 @@
 #include "contact_file.h"
+#include "contact_compress.h"
+#include "contact_index.h"
+#include "contact_reader.h"
+#include "file_io.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h> // offsetof
 
 uint32_t fletcher32(const void *data, size_t length)
 {
@@ -45,79 +50,105 @@ uint32_t fletcher32(const void *data, size_t length)
 
 static bool write_contact(FILE *file, const Contact *contact)
 {
-    if (fwrite(contact->name, 1, MAX_NAME_LEN, file) != MAX_NAME_LEN)
-    {
-        return false;
-    }
+    uint8_t packed[CONTACT_PACKED_SIZE];
+    contact_pack(contact, packed);
+    return fwrite(packed, 1, CONTACT_PACKED_SIZE, file) == CONTACT_PACKED_SIZE;
+} // 323 Bytes - No padding
 
-    if (fwrite(contact->phone, 1, MAX_PHONE_LEN, file) != MAX_PHONE_LEN)
-    {
-        return false;
-    }
+// Bytes past the terminator are zeroed rather than copied: contacts
+// decoded from the database leave them uninitialized
+static void pack_field(uint8_t *out, const char *field, size_t size)
+{
+    const char *end = memchr(field, '\0', size);
+    size_t length = end != NULL ? (size_t)(end - field) : size;
+    memcpy(out, field, length);
+    memset(out + length, 0, size - length);
+}
 
-    if (fwrite(contact->email, 1, MAX_EMAIL_LEN, file) != MAX_EMAIL_LEN)
-    {
-        return false;
-    }
+void contact_pack(const Contact *contact, uint8_t out[CONTACT_PACKED_SIZE])
+{
+    pack_field(out, contact->name, MAX_NAME_LEN);
+    pack_field(out + MAX_NAME_LEN, contact->phone, MAX_PHONE_LEN);
+    pack_field(out + MAX_NAME_LEN + MAX_PHONE_LEN, contact->email, MAX_EMAIL_LEN);
+    memcpy(out + MAX_NAME_LEN + MAX_PHONE_LEN + MAX_EMAIL_LEN, &contact->id, sizeof(int));
+}
 
-    if (fwrite(&contact->id, sizeof(int), 1, file) != 1)
-    {
-        return false;
-    }
-    return true;
-} // 323 Bytes - No padding
+void contact_unpack(Contact *contact, const uint8_t in[CONTACT_PACKED_SIZE])
+{
+    memcpy(contact->name, in, MAX_NAME_LEN);
+    memcpy(contact->phone, in + MAX_NAME_LEN, MAX_PHONE_LEN);
+    memcpy(contact->email, in + MAX_NAME_LEN + MAX_PHONE_LEN, MAX_EMAIL_LEN);
+    memcpy(&contact->id, in + MAX_NAME_LEN + MAX_PHONE_LEN + MAX_EMAIL_LEN, sizeof(int));
+
+    // Never trust NUL termination coming from disk
+    contact->name[MAX_NAME_LEN - 1] = '\0';
+    contact->phone[MAX_PHONE_LEN - 1] = '\0';
+    contact->email[MAX_EMAIL_LEN - 1] = '\0';
+}
+
+uint32_t contact_file_checksum_update(uint32_t checksum, const void *data, size_t length)
+{
+    uint32_t sum1 = checksum & 0xFFFF;
+    uint32_t sum2 = checksum >> 16;
+    fletcher32_update_stream(&sum1, &sum2, data, length);
+    return (sum2 << 16) | sum1;
+}
 
 static uint32_t calculate_packed_checksum_stream(const ContactList *list)
 {
     uint32_t sum1 = 0;
     uint32_t sum2 = 0;
+    uint8_t packed[CONTACT_PACKED_SIZE];
 
     for (int i = 0; i < list->size; i++)
     {
-        const Contact *c = &list->data[i];
-
         // Process in EXACT same order as file write
-        fletcher32_update_stream(&sum1, &sum2, c->name, MAX_NAME_LEN);
-        fletcher32_update_stream(&sum1, &sum2, c->phone, MAX_PHONE_LEN);
-        fletcher32_update_stream(&sum1, &sum2, c->email, MAX_EMAIL_LEN);
-        fletcher32_update_stream(&sum1, &sum2, &c->id, sizeof(int));
+        contact_pack(&list->data[i], packed);
+        fletcher32_update_stream(&sum1, &sum2, packed, CONTACT_PACKED_SIZE);
     }
 
     return (sum2 << 16) | sum1;
 }
 
-bool contact_file_save(const ContactList *list, const char *filename)
+// Writes a complete snapshot to 'path' and forces it to disk.
+// Callers write to a temp name and publish it with file_replace().
+// 'timestamp' 0 stamps it with the current time.
+static bool write_snapshot(const ContactList *list, const char *path, bool compressed,
+                           uint32_t next_id, time_t timestamp,
+                           ContactFileHeader *header_out, long *size_out)
 {
-    if (list == NULL || filename == NULL)
-    {
-        printf("SAVE ERROR: NULL parameters\n");
-        return false;
-    }
-
     // Declare variables at top (C89 style)
     FILE *file = NULL;
     ContactFileHeader header = {0};
+    uint8_t *payload = NULL;
     bool success = false;
 
+    // Compressed body is built up front - its size goes into the header
+    if (compressed && !contact_compress_encode(list, &payload, &header.payload_size))
+    {
+        printf("SAVE ERROR: Cannot compress %d contacts\n", list->size);
+        goto cleanup;
+    }
+
     // === STEP 1: Open file for binary writing ===
-    file = fopen(filename, "wb");
+    file = fopen(path, "wb");
     if (file == NULL)
     {
-        printf("SAVE ERROR: Cannot open '%s' for writing\n", filename);
+        printf("SAVE ERROR: Cannot open '%s' for writing\n", path);
         goto cleanup;
     }
 
     // === STEP 2: Fill header structure ===
     header.magic = FILE_MAGIC_LRBT;       // "LRBT"
-    header.version = FILE_FORMAT_VERSION; // 1
+    header.version = compressed ? FILE_FORMAT_VERSION_COMPRESSED : FILE_FORMAT_VERSION;
     header.contact_count = list->size;
-    header.next_contact_id = next_contact_id; // GLOBAL - from contact_dynamic.c
-    header.timestamp = time(NULL);            // Current Unix time
+    header.next_contact_id = next_id;
+    header.timestamp = timestamp != 0 ? timestamp : time(NULL); // Current Unix time
     header.header_size = sizeof(ContactFileHeader);
     header.contact_size = 323; // MANUAL PACKED SIZE: 50+15+254+4
 
     // === STEP 3: Calculate checksums ===
-    // Data checksum (all packed contacts)
+    // Data checksum (all packed contacts, whichever body carries them)
     header.data_checksum = calculate_packed_checksum_stream(list);
     header.header_checksum = fletcher32(
         &header.data_checksum,
@@ -130,8 +161,16 @@ bool contact_file_save(const ContactList *list, const char *filename)
         goto cleanup;
     }
 
-    // === STEP 5: Write all contacts (MANUAL PACKING) ===
-    for (int i = 0; i < list->size; i++)
+    // === STEP 5: Write all contacts (MANUAL PACKING or compressed payload) ===
+    if (compressed)
+    {
+        if (fwrite(payload, 1, header.payload_size, file) != header.payload_size)
+        {
+            printf("SAVE ERROR: Failed to write compressed contacts\n");
+            goto cleanup;
+        }
+    }
+    for (int i = 0; !compressed && i < list->size; i++)
     {
         if (!write_contact(file, &list->data[i]))
         {
@@ -155,33 +194,103 @@ bool contact_file_save(const ContactList *list, const char *filename)
         goto cleanup;
     }
 
-    // === STEP 7: Success! ===
-    printf("SAVE SUCCESS: Saved %d contacts to '%s'\n",
-           list->size, filename);
-    printf("  File size: %ld bytes (header: %zu, data: %d, footer: %zu)\n",
-           ftell(file), // Current position = total size
-           sizeof(ContactFileHeader),
-           list->size * 323, // 323 bytes per packed contact
-           sizeof(uint32_t) + sizeof(time_t));
+    // === STEP 7: Durable before anyone can see it under the real name ===
+    *size_out = ftell(file); // Current position = total size
+    if (!file_sync(file))
+    {
+        printf("SAVE ERROR: fsync of '%s' failed\n", path);
+        goto cleanup;
+    }
 
+    *header_out = header;
     success = true;
 
 cleanup:
-    if (file != NULL)
+    free(payload);
+    if (file != NULL && fclose(file) != 0)
     {
-        fclose(file);
+        success = false;
+    }
+    if (!success)
+    {
+        remove(path);
     }
     return success;
 }
 
-bool contact_file_load(ContactList *list, const char *filename)
+static void temp_name_for(char *buffer, size_t size, const char *filename)
+{
+    snprintf(buffer, size, "%s.tmp", filename);
+}
+
+static void report_saved(const ContactList *list, const char *filename, long file_size)
+{
+    printf("SAVE SUCCESS: Saved %d contacts to '%s'\n",
+           list->size, filename);
+    printf("  File size: %ld bytes (header: %zu, data: %ld, footer: %zu)\n",
+           file_size,
+           sizeof(ContactFileHeader),
+           file_size - (long)(sizeof(ContactFileHeader) + sizeof(uint32_t) + sizeof(time_t)),
+           sizeof(uint32_t) + sizeof(time_t));
+}
+
+static bool save_published(const ContactList *list, const char *filename, bool compressed)
 {
     if (list == NULL || filename == NULL)
     {
-        printf("LOAD ERROR: NULL parameters\n");
+        printf("SAVE ERROR: NULL parameters\n");
+        return false;
+    }
+
+    ContactFileHeader header;
+    long file_size = 0;
+    char temp_name[256];
+    temp_name_for(temp_name, sizeof(temp_name), filename);
+
+    // Temp file + fsync, then one atomic rename is the commit point:
+    // a crash leaves either the old file or the new one under 'filename'
+    if (!write_snapshot(list, temp_name, compressed, (uint32_t)next_contact_id, 0, &header, &file_size))
+    {
+        return false;
+    }
+    if (!file_replace(temp_name, filename))
+    {
+        printf("SAVE ERROR: Cannot replace '%s'\n", filename);
+        remove(temp_name);
         return false;
     }
+    file_sync_dir(filename);
+
+    report_saved(list, filename, file_size);
+
+    // Keep the id -> slot index in step so readers never rescan
+    // (compressed records have no fixed slots)
+    if (!compressed && !contact_reader_write_slots(filename, list, &header))
+    {
+        printf("WARNING: Could not write slot index for '%s'\n", filename);
+    }
+    if (!contact_index_write(filename, list, &header))
+    {
+        printf("WARNING: Could not write search index for '%s'\n", filename);
+    }
+    return true;
+}
+
+bool contact_file_save(const ContactList *list, const char *filename)
+{
+    return save_published(list, filename, false);
+}
+
+bool contact_file_save_compressed(const ContactList *list, const char *filename)
+{
+    return save_published(list, filename, true);
+}
 
+// Reads and verifies one snapshot without touching next_contact_id.
+// 'verbose' prints progress; errors are always printed.
+static bool load_snapshot(ContactList *list, const char *filename,
+                          ContactFileHeader *header_out, bool verbose)
+{
     FILE *file = NULL;
     ContactFileHeader header = {0};
     uint32_t checksum_sum1 = 0;
@@ -212,7 +321,8 @@ bool contact_file_load(ContactList *list, const char *filename)
     }
 
     // 4. Verify version
-    if (header.version > FILE_FORMAT_VERSION)
+    bool compressed = (header.version == FILE_FORMAT_VERSION_COMPRESSED);
+    if (header.version > FILE_FORMAT_VERSION && !compressed)
     {
         printf("LOAD ERROR: File version %u is newer than supported %u\n",
                header.version, FILE_FORMAT_VERSION);
@@ -234,8 +344,11 @@ bool contact_file_load(ContactList *list, const char *filename)
         goto cleanup;
     }
 
-    printf("LOAD: Found %u contacts, next ID: %u\n",
-           header.contact_count, header.next_contact_id);
+    if (verbose)
+    {
+        printf("LOAD: Found %u contacts, next ID: %u\n",
+               header.contact_count, header.next_contact_id);
+    }
 
     // Allocate memory
     contact_list_free(list);
@@ -247,8 +360,27 @@ bool contact_file_load(ContactList *list, const char *filename)
         goto cleanup;
     }
 
+    // Compressed: decode in one go, then checksum the records as v1 would pack them
+    if (compressed)
+    {
+        uint8_t *payload = malloc(header.payload_size > 0 ? header.payload_size : 1);
+        bool decoded = payload != NULL &&
+                       fread(payload, 1, header.payload_size, file) == header.payload_size &&
+                       contact_compress_decode(payload, header.payload_size, header.contact_count, list);
+        free(payload);
+        if (!decoded)
+        {
+            printf("LOAD ERROR: Failed to read compressed contacts\n");
+            goto cleanup;
+        }
+
+        uint32_t packed_checksum = calculate_packed_checksum_stream(list);
+        checksum_sum1 = packed_checksum & 0xFFFF;
+        checksum_sum2 = packed_checksum >> 16;
+    }
+
     // Read contacts WITH CHECKSUM CALCULATION
-    for (uint32_t i = 0; i < header.contact_count; i++)
+    for (uint32_t i = 0; !compressed && i < header.contact_count; i++)
     {
         Contact *contact = &list->data[i];
 
@@ -295,7 +427,17 @@ bool contact_file_load(ContactList *list, const char *filename)
     // Checksum
     uint32_t calculated_checksum = (checksum_sum2 << 16) | checksum_sum1;
 
-    if (calculated_checksum != header.data_checksum)
+    // An interrupted in-place update leaves either the old or the announced new data
+    uint32_t expected_checksum = header.data_checksum;
+    if (calculated_checksum != expected_checksum &&
+        header.pending_flag == FILE_PATCH_PENDING &&
+        calculated_checksum == header.pending_checksum)
+    {
+        printf("LOAD: Accepting data of an interrupted in-place update\n");
+        expected_checksum = calculated_checksum;
+    }
+
+    if (calculated_checksum != expected_checksum)
     {
         printf("LOAD ERROR: DATA CHECKSUM FAILED! File corrupted.\n");
         printf("  Expected: 0x%08X\n", header.data_checksum);
@@ -305,7 +447,10 @@ bool contact_file_load(ContactList *list, const char *filename)
         goto cleanup;
     }
 
-    printf("CHECKSUM VERIFIED: 0x%08X\n", calculated_checksum);
+    if (verbose)
+    {
+        printf("CHECKSUM VERIFIED: 0x%08X\n", calculated_checksum);
+    }
 
     // Verify header checksum
     uint32_t header_checksum = fletcher32(
@@ -346,13 +491,11 @@ bool contact_file_load(ContactList *list, const char *filename)
         }
     }
 
-    // Update global next_contact_id
-    extern int next_contact_id;
-    next_contact_id = header.next_contact_id;
-
     list->size = header.contact_count;
-    printf("LOAD SUCCESS: Loaded %u contacts, next ID: %u\n",
-           header.contact_count, header.next_contact_id);
+    if (header_out != NULL)
+    {
+        *header_out = header;
+    }
 
     success = true;
 
@@ -370,6 +513,28 @@ cleanup:
     return success;
 }
 
+bool contact_file_load(ContactList *list, const char *filename)
+{
+    if (list == NULL || filename == NULL)
+    {
+        printf("LOAD ERROR: NULL parameters\n");
+        return false;
+    }
+
+    ContactFileHeader header;
+    if (!load_snapshot(list, filename, &header, true))
+    {
+        return false;
+    }
+
+    // Update global next_contact_id
+    next_contact_id = header.next_contact_id;
+
+    printf("LOAD SUCCESS: Loaded %u contacts, next ID: %u\n",
+           header.contact_count, header.next_contact_id);
+    return true;
+}
+
 bool contact_file_validate(const char *filename)
 {
     FILE *file = fopen(filename, "rb");
@@ -382,7 +547,8 @@ bool contact_file_validate(const char *filename)
     if (fread(&header, sizeof(header), 1, file) == 1)
     {
         if (header.magic == FILE_MAGIC_LRBT &&
-            header.version <= FILE_FORMAT_VERSION &&
+            (header.version <= FILE_FORMAT_VERSION ||
+             header.version == FILE_FORMAT_VERSION_COMPRESSED) &&
             header.header_size == sizeof(ContactFileHeader))
         {
             valid = true;
@@ -404,63 +570,1031 @@ static void fletcher32_update_stream(uint32_t *sum1, uint32_t *sum2, const void
     }
 }
 
-bool rotate_backups(void)
+// ============================================================================
+// DELTA BACKUPS
+// ============================================================================
+// contacts.dat is a full snapshot and a save keeps the previous one whole
+// as .bak1. Above that, contacts.dat.bakN holds the record-level difference
+// between generation N-1 (newer) and N (older): ids to remove and the older
+// contents of records to restore. Older generations are rebuilt by applying
+// the deltas to the nearest full generation below them; every
+// BACKUP_KEYFRAME_INTERVAL generations one is kept whole, so a single bad
+// snapshot only costs the chain resting on it.
+//
+// A save reads the previous contacts.dat once and diffs the new list
+// against it into BACKUP_NEXT_DELTA_FILE. One save later that delta stands
+// in for the full .bak1 as it moves up to .bak2, so old generations are
+// never re-read. An in-place patch pushes a delta of the records it
+// overwrites as the new .bak1.
+
+typedef enum
+{
+    BACKUP_KIND_NONE,  // missing or unrecognised
+    BACKUP_KIND_FULL,  // "LRBT" snapshot (also pre-delta .bak files)
+    BACKUP_KIND_DELTA  // "LRBD" delta
+} BackupKind;
+
+static void backup_name(char *buffer, size_t size, int generation)
 {
-    FILE *fp;
-    fp = fopen("contacts.dat.bak3", "rb");
-    if (fp != NULL)
+    if (generation == 0)
     {
-        fclose(fp);
-        remove("contacts.dat.bak3");
+        snprintf(buffer, size, "%s", BACKUP_PRIMARY_FILE);
     }
+    else
+    {
+        snprintf(buffer, size, "%s.bak%d", BACKUP_PRIMARY_FILE, generation);
+    }
+}
 
-    fp = fopen("contacts.dat.bak2", "rb");
-    if (fp != NULL)
+static BackupKind backup_kind(const char *filename)
+{
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
     {
-        fclose(fp);
-        rename("contacts.dat.bak2", "contacts.dat.bak3");
+        return BACKUP_KIND_NONE;
     }
 
-    fp = fopen("contacts.dat.bak1", "rb");
-    if (fp != NULL)
+    uint32_t magic = 0;
+    size_t got = fread(&magic, sizeof(magic), 1, file);
+    fclose(file);
+
+    if (got != 1)
+        return BACKUP_KIND_NONE;
+    if (magic == FILE_MAGIC_LRBT)
+        return BACKUP_KIND_FULL;
+    if (magic == FILE_MAGIC_LRBD)
+        return BACKUP_KIND_DELTA;
+    return BACKUP_KIND_NONE;
+}
+
+static int compare_contact_ptr_id(const void *a, const void *b)
+{
+    const Contact *contact_a = *(const Contact *const *)a;
+    const Contact *contact_b = *(const Contact *const *)b;
+    return (contact_a->id > contact_b->id) - (contact_a->id < contact_b->id);
+}
+
+// Returns a malloc'd array of pointers into list->data, sorted by id
+static const Contact **sorted_by_id(const ContactList *list)
+{
+    const Contact **sorted = malloc((list->size > 0 ? list->size : 1) * sizeof(Contact *));
+    if (sorted == NULL)
     {
-        fclose(fp);
-        rename("contacts.dat.bak1", "contacts.dat.bak2");
+        return NULL;
     }
 
-    fp = fopen("contacts.dat", "rb");
-    if (fp != NULL)
+    for (int i = 0; i < list->size; i++)
     {
-        fclose(fp);
-        rename("contacts.dat", "contacts.dat.bak1");
+        sorted[i] = &list->data[i];
     }
-    fp = NULL;
-    return true;
+    qsort(sorted, list->size, sizeof(Contact *), compare_contact_ptr_id);
+    return sorted;
 }
 
-bool contact_file_load_backup(ContactList *list)
+static bool contacts_equal(const Contact *a, const Contact *b)
+{
+    return a->id == b->id &&
+           strcmp(a->name, b->name) == 0 &&
+           strcmp(a->phone, b->phone) == 0 &&
+           strcmp(a->email, b->email) == 0;
+}
+
+// Writes a delta file. 'base' supplies next_contact_id and timestamp of
+// the older generation and the newer one's base_checksum; restores are
+// packed in the given order.
+static bool write_delta_file(const char *filename, const ContactDeltaHeader *base,
+                             const int *removes, uint32_t remove_count,
+                             const Contact *const *restores, uint32_t restore_count, bool verbose)
 {
-    const char *files[] = {
-        "contacts.dat",
-        "contacts.dat.bak1",
-        "contacts.dat.bak2",
-        "contacts.dat.bak3"};
+    FILE *file = NULL;
+    ContactDeltaHeader header = {0};
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+    bool success = false;
+
+    // === STEP 1: Checksum the body exactly as it is written ===
+    uint8_t packed[CONTACT_PACKED_SIZE];
+    for (uint32_t k = 0; k < remove_count; k++)
+    {
+        fletcher32_update_stream(&sum1, &sum2, &removes[k], sizeof(int));
+    }
+    for (uint32_t k = 0; k < restore_count; k++)
+    {
+        contact_pack(restores[k], packed);
+        fletcher32_update_stream(&sum1, &sum2, packed, CONTACT_PACKED_SIZE);
+    }
+
+    header.magic = FILE_MAGIC_LRBD;
+    header.version = FILE_FORMAT_VERSION;
+    header.data_checksum = (sum2 << 16) | sum1;
+    header.remove_count = remove_count;
+    header.restore_count = restore_count;
+    header.next_contact_id = base->next_contact_id;
+    header.timestamp = base->timestamp;
+    header.header_size = sizeof(ContactDeltaHeader);
+    header.contact_size = CONTACT_PACKED_SIZE;
+    header.base_checksum = base->base_checksum;
+    header.header_checksum = fletcher32(
+        &header.data_checksum,
+        sizeof(ContactDeltaHeader) - offsetof(ContactDeltaHeader, data_checksum));
+
+    // === STEP 2: Write header, body, footer ===
+    file = fopen(filename, "wb");
+    if (file == NULL)
+    {
+        printf("BACKUP ERROR: Cannot open '%s' for writing\n", filename);
+        goto cleanup;
+    }
+
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        (remove_count > 0 && fwrite(removes, sizeof(int), remove_count, file) != remove_count))
+    {
+        printf("BACKUP ERROR: Failed to write delta '%s'\n", filename);
+        goto cleanup;
+    }
 
-    for (int i = 0; i < 4; i++)
+    for (uint32_t k = 0; k < restore_count; k++)
     {
-        if (contact_file_load(list, files[i]))
+        contact_pack(restores[k], packed);
+        if (fwrite(packed, 1, CONTACT_PACKED_SIZE, file) != CONTACT_PACKED_SIZE)
         {
-            printf("Successfully loaded from %s\n", files[i]);
-            return true;
+            printf("BACKUP ERROR: Failed to write delta '%s'\n", filename);
+            goto cleanup;
         }
     }
 
-    printf("All backups exhausted. No valid contacts file found.\n");
-    return false;
+    uint32_t footer_magic = FILE_MAGIC_TRBL;
+    if (fwrite(&footer_magic, sizeof(footer_magic), 1, file) != 1 ||
+        fwrite(&header.timestamp, sizeof(time_t), 1, file) != 1)
+    {
+        printf("BACKUP ERROR: Failed to write delta footer\n");
+        goto cleanup;
+    }
+
+    if (!file_sync(file))
+    {
+        printf("BACKUP ERROR: fsync of '%s' failed\n", filename);
+        goto cleanup;
+    }
+
+    if (verbose)
+    {
+        printf("BACKUP: %s = %u removed, %u restored (%ld bytes)\n",
+               filename, remove_count, restore_count, ftell(file));
+    }
+    success = true;
+
+cleanup:
+    if (file != NULL && fclose(file) != 0)
+    {
+        success = false;
+    }
+    if (!success)
+    {
+        remove(filename); // never leave a half-written delta in the chain
+    }
+    return success;
 }
 
-bool contact_file_save_backup(const ContactList *list)
+// Writes the delta that turns 'newer' (saved with 'newer_checksum') back into 'older'
+static bool write_delta(const ContactList *newer, uint32_t newer_checksum, const ContactList *older,
+                        const ContactFileHeader *older_header, const char *filename, bool verbose)
 {
-    rotate_backups();
-    return contact_file_save(list, "contacts.dat");
-}
\ No newline at end of file
+    const Contact **new_sorted = sorted_by_id(newer);
+    const Contact **old_sorted = sorted_by_id(older);
+    int *removes = malloc((newer->size > 0 ? newer->size : 1) * sizeof(int));
+    const Contact **restores = malloc((older->size > 0 ? older->size : 1) * sizeof(Contact *));
+    uint32_t remove_count = 0;
+    uint32_t restore_count = 0;
+    bool success = false;
+
+    if (new_sorted == NULL || old_sorted == NULL || removes == NULL || restores == NULL)
+    {
+        printf("BACKUP ERROR: Out of memory while computing delta\n");
+        goto cleanup;
+    }
+
+    // Merge both id-sorted lists
+    int i = 0, j = 0;
+    while (i < older->size || j < newer->size)
+    {
+        if (j >= newer->size || (i < older->size && old_sorted[i]->id < new_sorted[j]->id))
+        {
+            restores[restore_count++] = old_sorted[i++]; // deleted since
+        }
+        else if (i >= older->size || new_sorted[j]->id < old_sorted[i]->id)
+        {
+            removes[remove_count++] = new_sorted[j++]->id; // added since
+        }
+        else
+        {
+            if (!contacts_equal(old_sorted[i], new_sorted[j]))
+            {
+                restores[restore_count++] = old_sorted[i]; // edited since
+            }
+            i++;
+            j++;
+        }
+    }
+
+    ContactDeltaHeader base = {0};
+    base.next_contact_id = older_header->next_contact_id;
+    base.timestamp = older_header->timestamp;
+    base.base_checksum = newer_checksum;
+    success = write_delta_file(filename, &base, removes, remove_count, restores, restore_count, verbose);
+
+cleanup:
+    free(new_sorted);
+    free(old_sorted);
+    free(removes);
+    free(restores);
+    return success;
+}
+
+// Reads and verifies a whole delta. Caller frees *removes and *restores.
+static bool read_delta(const char *filename, ContactDeltaHeader *header,
+                       int **removes, Contact **restores)
+{
+    FILE *file = NULL;
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+    bool success = false;
+
+    *removes = NULL;
+    *restores = NULL;
+
+    file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        printf("BACKUP ERROR: Cannot open delta '%s'\n", filename);
+        goto cleanup;
+    }
+
+    // === STEP 1: Header ===
+    if (fread(header, sizeof(*header), 1, file) != 1 ||
+        header->magic != FILE_MAGIC_LRBD ||
+        header->version > FILE_FORMAT_VERSION ||
+        header->header_size != sizeof(ContactDeltaHeader) ||
+        header->contact_size != CONTACT_PACKED_SIZE)
+    {
+        printf("BACKUP ERROR: '%s' is not a valid delta\n", filename);
+        goto cleanup;
+    }
+
+    uint32_t header_checksum = fletcher32(
+        &header->data_checksum,
+        sizeof(ContactDeltaHeader) - offsetof(ContactDeltaHeader, data_checksum));
+    if (header_checksum != header->header_checksum)
+    {
+        printf("BACKUP ERROR: Delta header checksum failed for '%s'\n", filename);
+        goto cleanup;
+    }
+
+    // === STEP 2: Body (checksummed while reading) ===
+    *removes = malloc((header->remove_count > 0 ? header->remove_count : 1) * sizeof(int));
+    *restores = malloc((header->restore_count > 0 ? header->restore_count : 1) * sizeof(Contact));
+    if (*removes == NULL || *restores == NULL)
+    {
+        printf("BACKUP ERROR: Out of memory reading '%s'\n", filename);
+        goto cleanup;
+    }
+
+    if (fread(*removes, sizeof(int), header->remove_count, file) != header->remove_count)
+    {
+        printf("BACKUP ERROR: Delta '%s' is truncated\n", filename);
+        goto cleanup;
+    }
+    for (uint32_t k = 0; k < header->remove_count; k++)
+    {
+        fletcher32_update_stream(&sum1, &sum2, &(*removes)[k], sizeof(int));
+    }
+
+    uint8_t packed[CONTACT_PACKED_SIZE];
+    for (uint32_t k = 0; k < header->restore_count; k++)
+    {
+        if (fread(packed, 1, CONTACT_PACKED_SIZE, file) != CONTACT_PACKED_SIZE)
+        {
+            printf("BACKUP ERROR: Delta '%s' is truncated\n", filename);
+            goto cleanup;
+        }
+        fletcher32_update_stream(&sum1, &sum2, packed, CONTACT_PACKED_SIZE);
+        contact_unpack(&(*restores)[k], packed);
+    }
+
+    if (((sum2 << 16) | sum1) != header->data_checksum)
+    {
+        printf("BACKUP ERROR: DELTA CHECKSUM FAILED for '%s'\n", filename);
+        goto cleanup;
+    }
+
+    success = true;
+
+cleanup:
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    if (!success)
+    {
+        free(*removes);
+        free(*restores);
+        *removes = NULL;
+        *restores = NULL;
+    }
+    return success;
+}
+
+// Turns generation N-1 (in 'list') into generation N using .bakN
+static bool apply_delta(ContactList *list, const char *filename, ContactDeltaHeader *header_out)
+{
+    ContactDeltaHeader header;
+    int *removes = NULL;
+    Contact *restores = NULL;
+    bool success = false;
+
+    if (!read_delta(filename, &header, &removes, &restores))
+    {
+        return false;
+    }
+
+    // Sort by id, drop removals, upsert restores
+    qsort(list->data, list->size, sizeof(Contact), contact_compare_id);
+
+    for (uint32_t k = 0; k < header.remove_count; k++)
+    {
+        Contact key;
+        key.id = removes[k];
+        Contact *found = bsearch(&key, list->data, list->size, sizeof(Contact), contact_compare_id);
+        if (found != NULL)
+        {
+            found->id = 0; // tombstone, compacted below (real ids start at 1)
+        }
+    }
+
+    int kept = 0;
+    for (int k = 0; k < list->size; k++)
+    {
+        if (list->data[k].id != 0)
+        {
+            list->data[kept++] = list->data[k];
+        }
+    }
+    list->size = kept;
+
+    int sorted_size = list->size; // restores appended past this stay unsorted
+    for (uint32_t k = 0; k < header.restore_count; k++)
+    {
+        Contact *found = bsearch(&restores[k], list->data, sorted_size, sizeof(Contact), contact_compare_id);
+        if (found != NULL)
+        {
+            *found = restores[k];
+        }
+        else if (!contact_list_add(list, &restores[k]))
+        {
+            printf("BACKUP ERROR: Out of memory applying '%s'\n", filename);
+            goto cleanup;
+        }
+    }
+    qsort(list->data, list->size, sizeof(Contact), contact_compare_id);
+
+    if (header_out != NULL)
+    {
+        *header_out = header;
+    }
+    success = true;
+
+cleanup:
+    free(removes);
+    free(restores);
+    return success;
+}
+
+// Magic and header checksum of a snapshot, without reading its records
+static bool read_snapshot_header(const char *filename, ContactFileHeader *header)
+{
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool got = fread(header, sizeof(*header), 1, file) == 1;
+    fclose(file);
+
+    return got && header->magic == FILE_MAGIC_LRBT &&
+           header->header_checksum == fletcher32(&header->data_checksum,
+                                                 sizeof(ContactFileHeader) - offsetof(ContactFileHeader, data_checksum));
+}
+
+// Number of consecutive delta generations right above 'generation'
+static int deltas_above(int generation)
+{
+    char filename[64];
+    int count = 0;
+    for (int g = generation + 1; g <= BACKUP_GENERATIONS; g++)
+    {
+        backup_name(filename, sizeof(filename), g);
+        if (backup_kind(filename) != BACKUP_KIND_DELTA)
+            break;
+        count++;
+    }
+    return count;
+}
+
+// True if BACKUP_NEXT_DELTA_FILE still turns contacts.dat into .bak1: a
+// patch, a crash between renames or a save that could not diff all leave
+// one that belongs to other files.
+static bool next_delta_fits(void)
+{
+    char bak1[64];
+    ContactFileHeader primary;
+    ContactFileHeader older;
+    ContactDeltaHeader delta;
+    int *removes = NULL;
+    Contact *restores = NULL;
+    backup_name(bak1, sizeof(bak1), 1);
+
+    if (!read_snapshot_header(BACKUP_PRIMARY_FILE, &primary) ||
+        primary.pending_flag == FILE_PATCH_PENDING ||
+        !read_snapshot_header(bak1, &older) ||
+        backup_kind(BACKUP_NEXT_DELTA_FILE) != BACKUP_KIND_DELTA ||
+        !read_delta(BACKUP_NEXT_DELTA_FILE, &delta, &removes, &restores))
+    {
+        return false;
+    }
+    free(removes);
+    free(restores);
+
+    return delta.base_checksum == primary.data_checksum &&
+           delta.timestamp == older.timestamp &&
+           delta.next_contact_id == older.next_contact_id;
+}
+
+typedef enum
+{
+    BAK1_MOVES_AS_IS,   // a delta already, missing, or kept as it is
+    BAK1_BECOMES_DELTA, // replaced by BACKUP_NEXT_DELTA_FILE
+    BAK1_COMPRESSED     // a keyframe, replaced by its compressed copy
+} Bak1Move;
+
+// Decides what a full .bak1 turns into when it moves up to .bak2, where
+// 'deltas_below' deltas will separate it from the full generation it rests
+// on. Only a keyframe is read (and compressed), once per chain.
+static Bak1Move prepare_bak1_move(int deltas_below, const char *keyframe_temp, bool verbose)
+{
+    char bak1[64];
+    backup_name(bak1, sizeof(bak1), 1);
+    if (backup_kind(bak1) != BACKUP_KIND_FULL)
+    {
+        return BAK1_MOVES_AS_IS;
+    }
+
+    if (deltas_below + 1 + deltas_above(1) < BACKUP_KEYFRAME_INTERVAL && next_delta_fits())
+    {
+        return BAK1_BECOMES_DELTA;
+    }
+
+    // Stays whole - the keyframe, or no delta can stand in for it
+    ContactList keyframe = {NULL, 0, 0, NULL, NULL, 0, 0};
+    ContactFileHeader header;
+    ContactFileHeader written;
+    long size = 0;
+    bool compressed = read_snapshot_header(bak1, &header) &&
+                      header.version == FILE_FORMAT_VERSION &&
+                      load_snapshot(&keyframe, bak1, &header, false) &&
+                      write_snapshot(&keyframe, keyframe_temp, true, header.next_contact_id,
+                                     header.timestamp, &written, &size);
+    contact_list_free(&keyframe);
+
+    if (compressed && verbose)
+    {
+        printf("BACKUP: %s = %u contacts compressed (%ld bytes)\n", keyframe_temp, written.contact_count, size);
+    }
+    return compressed ? BAK1_COMPRESSED : BAK1_MOVES_AS_IS;
+}
+
+// Runs right after rotate_backups(), when the old .bak1 is .bak2
+static void finish_bak1_move(Bak1Move move, const char *keyframe_temp)
+{
+    char bak2[64];
+    backup_name(bak2, sizeof(bak2), 2);
+
+    // A failed replace leaves .bak2 whole, which is still a valid generation
+    if (move == BAK1_BECOMES_DELTA)
+    {
+        file_replace(BACKUP_NEXT_DELTA_FILE, bak2);
+    }
+    else if (move == BAK1_COMPRESSED && !file_replace(keyframe_temp, bak2))
+    {
+        remove(keyframe_temp);
+    }
+    remove(BACKUP_NEXT_DELTA_FILE); // unused, it would match no later .bak1
+}
+
+// Before contacts.dat is patched, what it holds now becomes generation 1:
+// a delta restoring the 'old_count' records about to be overwritten.
+// 'header' is the file's, 'patched_checksum' its data checksum afterwards.
+static bool push_patch_generation(const Contact *old, int old_count, const ContactFileHeader *header,
+                                  uint32_t patched_checksum, bool verbose)
+{
+    if (1 + deltas_above(0) >= BACKUP_KEYFRAME_INTERVAL)
+    {
+        if (verbose)
+            printf("UPDATE: Backup chain is full, a full save is needed\n");
+        return false;
+    }
+
+    char bak1[64];
+    char delta_temp[72];
+    char keyframe_temp[72];
+    backup_name(bak1, sizeof(bak1), 1);
+    temp_name_for(delta_temp, sizeof(delta_temp), bak1);
+    backup_name(keyframe_temp, sizeof(keyframe_temp), 2);
+    strcat(keyframe_temp, ".tmp");
+
+    const Contact **restores = malloc((old_count > 0 ? old_count : 1) * sizeof(Contact *));
+    if (restores == NULL)
+    {
+        return false;
+    }
+    for (int k = 0; k < old_count; k++)
+    {
+        restores[k] = &old[k];
+    }
+
+    ContactDeltaHeader base = {0};
+    base.next_contact_id = header->next_contact_id;
+    base.timestamp = header->timestamp;
+    base.base_checksum = patched_checksum;
+    bool written = write_delta_file(delta_temp, &base, NULL, 0, restores, (uint32_t)old_count, verbose);
+    free(restores);
+    if (!written)
+    {
+        return false;
+    }
+
+    Bak1Move move = prepare_bak1_move(1, keyframe_temp, verbose);
+    rotate_backups();
+    finish_bak1_move(move, keyframe_temp);
+    if (!file_replace(delta_temp, bak1))
+    {
+        printf("UPDATE ERROR: Cannot replace '%s'\n", bak1);
+        remove(delta_temp);
+        return false; // the full save that follows fills .bak1 again
+    }
+    file_sync_dir(bak1);
+    return true;
+}
+
+// ============================================================================
+// IN-PLACE UPDATE
+// ============================================================================
+
+// Fletcher sums over N bytes are sum1 = sum(b[i]) and
+// sum2 = sum(b[i] * (N - i)) (mod 65535), so changing bytes at a known
+// offset only needs the old and new values of those bytes.
+static uint32_t fletcher32_patch(uint32_t checksum, const uint8_t *old_bytes,
+                                 const uint8_t *new_bytes, size_t length,
+                                 uint64_t offset, uint64_t total)
+{
+    int64_t sum1 = checksum & 0xFFFF;
+    int64_t sum2 = checksum >> 16;
+
+    for (size_t k = 0; k < length; k++)
+    {
+        int64_t diff = (int64_t)new_bytes[k] - (int64_t)old_bytes[k];
+        if (diff == 0)
+        {
+            continue;
+        }
+        int64_t weight = (int64_t)((total - (offset + k)) % 65535);
+        sum1 = ((sum1 + diff) % 65535 + 65535) % 65535;
+        sum2 = ((sum2 + diff * weight) % 65535 + 65535) % 65535;
+    }
+
+    return ((uint32_t)sum2 << 16) | (uint32_t)sum1;
+}
+
+static bool write_header_at_start(FILE *file, ContactFileHeader *header)
+{
+    header->header_checksum = fletcher32(
+        &header->data_checksum,
+        sizeof(ContactFileHeader) - offsetof(ContactFileHeader, data_checksum));
+
+    // One small write at offset 0 - a single sector on any real device
+    return file_pwrite(file, header, sizeof(*header), 0) && file_sync(file);
+}
+
+static bool patch_record(const char *filename, const Contact *contact, bool verbose)
+{
+    if (filename == NULL || contact == NULL)
+    {
+        return false;
+    }
+
+    ContactFileReader reader;
+    FILE *file = NULL;
+    bool success = false;
+
+    // === STEP 1: Locate the slot through the id index ===
+    if (!contact_reader_open(&reader, filename))
+    {
+        return false;
+    }
+
+    ContactFileHeader header = reader.header;
+    if (header.pending_flag == FILE_PATCH_PENDING)
+    {
+        if (verbose)
+            printf("UPDATE: Earlier in-place update never finished, a full save is needed\n");
+        goto cleanup;
+    }
+
+    long slot = contact_reader_slot_of(&reader, contact->id);
+    if (slot < 0)
+    {
+        goto cleanup; // not in the file - caller falls back to a full save
+    }
+
+    uint8_t old_bytes[CONTACT_PACKED_SIZE];
+    uint8_t new_bytes[CONTACT_PACKED_SIZE];
+    long long offset = (long long)header.header_size + (long long)slot * CONTACT_PACKED_SIZE;
+    if (!file_pread(reader.file, old_bytes, CONTACT_PACKED_SIZE, offset))
+    {
+        goto cleanup;
+    }
+    contact_pack(contact, new_bytes);
+
+    if (memcmp(old_bytes, new_bytes, CONTACT_PACKED_SIZE) == 0)
+    {
+        success = true; // nothing changed
+        goto cleanup;
+    }
+
+    // === STEP 2: Patch the data checksum from the old and new bytes ===
+    uint64_t total = (uint64_t)header.contact_count * CONTACT_PACKED_SIZE;
+    uint32_t new_checksum = fletcher32_patch(header.data_checksum, old_bytes, new_bytes,
+                                             CONTACT_PACKED_SIZE,
+                                             (uint64_t)slot * CONTACT_PACKED_SIZE, total);
+
+    file = fopen(filename, "r+b");
+    if (file == NULL)
+    {
+        printf("UPDATE ERROR: Cannot open '%s' for writing\n", filename);
+        goto cleanup;
+    }
+
+    // === STEP 3: Announce -> write slot -> commit header ===
+    // A crash in between leaves data matching either data_checksum or
+    // pending_checksum, and the loader accepts both.
+    header.pending_flag = FILE_PATCH_PENDING;
+    header.pending_checksum = new_checksum;
+    if (!write_header_at_start(file, &header))
+    {
+        printf("UPDATE ERROR: Failed to announce update\n");
+        goto cleanup;
+    }
+
+    if (!file_pwrite(file, new_bytes, CONTACT_PACKED_SIZE, offset) || !file_sync(file))
+    {
+        printf("UPDATE ERROR: Failed to write slot %ld\n", slot);
+        goto cleanup;
+    }
+
+    header.data_checksum = new_checksum;
+    header.pending_flag = 0;
+    header.pending_checksum = 0;
+    header.timestamp = time(NULL);
+    if (!write_header_at_start(file, &header))
+    {
+        printf("UPDATE ERROR: Failed to commit header\n");
+        goto cleanup;
+    }
+
+    // Footer timestamp only produces a warning when stale, so it goes last
+    long long footer_timestamp_offset = (long long)header.header_size + (long long)total + sizeof(uint32_t);
+    if (!file_pwrite(file, &header.timestamp, sizeof(time_t), footer_timestamp_offset))
+    {
+        printf("WARNING: Could not update footer timestamp\n");
+    }
+
+    // === STEP 4: Slots keep their ids, just re-bind the index ===
+    contact_reader_restamp_slots(&reader, filename, &header);
+
+    if (verbose)
+    {
+        printf("UPDATE SUCCESS: Contact %d patched in place (slot %ld)\n", contact->id, slot);
+    }
+    success = true;
+
+cleanup:
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    contact_reader_close(&reader);
+    return success;
+}
+
+// True if 'list' is the snapshot in 'filename' apart from the records in
+// 'ids': undoing those edits on the list's checksum must give the file's.
+// Checked before anything is written, so a mismatch costs nothing. The
+// file's versions of those records go to 'old', each id once.
+static bool list_is_snapshot(const char *filename, const ContactList *list,
+                             const int ids[], int count, uint32_t *list_checksum,
+                             Contact old[], int *old_count, ContactFileHeader *header)
+{
+    ContactFileReader reader;
+    if (!contact_reader_open(&reader, filename))
+    {
+        return false;
+    }
+
+    bool same = reader.header.pending_flag != FILE_PATCH_PENDING &&
+                reader.header.contact_count == (uint32_t)list->size;
+    uint64_t total = (uint64_t)list->size * CONTACT_PACKED_SIZE;
+    uint32_t checksum = same ? calculate_packed_checksum_stream(list) : 0;
+    *list_checksum = checksum;
+    *old_count = 0;
+    *header = reader.header;
+
+    uint8_t old_bytes[CONTACT_PACKED_SIZE];
+    uint8_t new_bytes[CONTACT_PACKED_SIZE];
+    for (int i = 0; i < count && same; i++)
+    {
+        bool repeated = false;
+        for (int j = 0; j < i && !repeated; j++)
+            repeated = (ids[j] == ids[i]);
+        if (repeated)
+        {
+            continue; // edited twice, one slot
+        }
+
+        // Slots follow list order, so the record must sit at its list index
+        int index = contact_find_by_id_in_list(list, ids[i]);
+        long slot = contact_reader_slot_of(&reader, ids[i]);
+        long long offset = (long long)reader.header.header_size + (long long)slot * CONTACT_PACKED_SIZE;
+        same = index != -1 && slot == index &&
+               file_pread(reader.file, old_bytes, CONTACT_PACKED_SIZE, offset);
+        if (same)
+        {
+            contact_unpack(&old[(*old_count)++], old_bytes);
+            contact_pack(&list->data[index], new_bytes);
+            checksum = fletcher32_patch(checksum, new_bytes, old_bytes, CONTACT_PACKED_SIZE,
+                                        (uint64_t)slot * CONTACT_PACKED_SIZE, total);
+        }
+    }
+
+    same = same && checksum == reader.header.data_checksum;
+    contact_reader_close(&reader);
+    return same;
+}
+
+bool contact_file_update_records(const char *filename, const ContactList *list,
+                                 const int ids[], int count, bool verbose)
+{
+    if (filename == NULL || list == NULL || ids == NULL)
+    {
+        return false;
+    }
+
+    // === STEP 1: A list that did not start out as this snapshot needs the full rewrite ===
+    uint32_t list_checksum;
+    ContactFileHeader file_header;
+    int old_count = 0;
+    Contact *old = malloc((count > 0 ? count : 1) * sizeof(Contact));
+    if (old == NULL ||
+        !list_is_snapshot(filename, list, ids, count, &list_checksum, old, &old_count, &file_header))
+    {
+        free(old);
+        return false;
+    }
+
+    // === STEP 2: The unpatched contacts.dat stays reachable as .bak1 ===
+    bool pushed = strcmp(filename, BACKUP_PRIMARY_FILE) != 0 ||
+                  push_patch_generation(old, old_count, &file_header, list_checksum, verbose);
+    free(old);
+    if (!pushed)
+    {
+        return false;
+    }
+
+    // === STEP 3: Patch the slots ===
+    for (int i = 0; i < count; i++)
+    {
+        int index = contact_find_by_id_in_list(list, ids[i]);
+        if (index == -1 || !patch_record(filename, &list->data[index], verbose))
+        {
+            return false;
+        }
+    }
+
+    // The file must now be exactly 'list'
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    ContactFileHeader header;
+    bool same = fread(&header, sizeof(header), 1, file) == 1 &&
+                header.contact_count == (uint32_t)list->size &&
+                header.data_checksum == list_checksum;
+    fclose(file);
+
+    // The persisted id order still holds - only its binding moves
+    if (same)
+    {
+        contact_index_restamp(filename, &file_header, &header);
+    }
+    return same;
+}
+
+bool rotate_backups(void)
+{
+    char from[64];
+    char to[64];
+
+    // Oldest generation falls off the end
+    backup_name(to, sizeof(to), BACKUP_GENERATIONS);
+    remove(to);
+
+    // .bak(N-1) -> .bakN ... .bak1 -> .bak2 (contacts.dat itself stays put)
+    for (int generation = BACKUP_GENERATIONS; generation > 1; generation--)
+    {
+        backup_name(from, sizeof(from), generation - 1);
+        backup_name(to, sizeof(to), generation);
+        rename(from, to); // Fails harmlessly when 'from' does not exist yet
+    }
+    return true;
+}
+
+// Nearest full generation at or below 'generation', or -1 past a hole
+static int backup_base(int generation)
+{
+    char filename[64];
+    int base = generation;
+    while (base > 0)
+    {
+        backup_name(filename, sizeof(filename), base);
+        BackupKind kind = backup_kind(filename);
+        if (kind == BACKUP_KIND_FULL)
+            return base;
+        if (kind != BACKUP_KIND_DELTA)
+            return -1;
+        base--;
+    }
+    return 0;
+}
+
+bool contact_file_load_generation(ContactList *list, int generation)
+{
+    if (list == NULL || generation < 0 || generation > BACKUP_GENERATIONS)
+    {
+        return false;
+    }
+
+    // === STEP 1: Find the nearest full snapshot at or below 'generation' ===
+    char filename[64];
+    int base = backup_base(generation);
+    if (base < 0)
+    {
+        return false; // hole in the chain
+    }
+
+    backup_name(filename, sizeof(filename), base);
+    ContactFileHeader header;
+    if (!load_snapshot(list, filename, &header, false))
+    {
+        return false;
+    }
+    uint32_t next_id = header.next_contact_id;
+
+    // === STEP 2: Walk the deltas back in time ===
+    for (int g = base + 1; g <= generation; g++)
+    {
+        ContactDeltaHeader delta;
+        backup_name(filename, sizeof(filename), g);
+        if (!apply_delta(list, filename, &delta))
+        {
+            contact_list_free(list);
+            return false;
+        }
+        next_id = delta.next_contact_id;
+    }
+
+    next_contact_id = next_id;
+    return true;
+}
+
+bool contact_file_load_backup(ContactList *list)
+{
+    char filename[64];
+    bool failed[BACKUP_GENERATIONS + 1] = {false}; // by base generation
+
+    for (int generation = 0; generation <= BACKUP_GENERATIONS; generation++)
+    {
+        // Every later generation on a failed base needs what just failed
+        int base = backup_base(generation);
+        if (base < 0 || failed[base])
+        {
+            continue;
+        }
+
+        backup_name(filename, sizeof(filename), generation);
+        if (contact_file_load_generation(list, generation))
+        {
+            printf("Successfully loaded from %s (%d contacts)\n", filename, list->size);
+            return true;
+        }
+        failed[base] = true;
+    }
+
+    printf("All backups exhausted. No valid contacts file found.\n");
+    return false;
+}
+
+bool contact_file_save_backup(const ContactList *list)
+{
+    return contact_file_save_backup_snapshot(list, (uint32_t)next_contact_id, true); // GLOBAL - from contact_dynamic.c
+}
+
+bool contact_file_save_backup_snapshot(const ContactList *list, uint32_t next_id, bool verbose)
+{
+    if (list == NULL)
+    {
+        return false;
+    }
+
+    // The one read of an older generation: the previous contacts.dat, to
+    // diff the new list against. It moves to .bak1 as it is.
+    ContactList previous = {NULL, 0, 0, NULL, NULL, 0, 0};
+    ContactFileHeader previous_header;
+    bool have_previous = backup_kind(BACKUP_PRIMARY_FILE) == BACKUP_KIND_FULL &&
+                         load_snapshot(&previous, BACKUP_PRIMARY_FILE, &previous_header, false);
+
+    // === STEP 1: New snapshot and the delta back to the previous one ===
+    // Written under temp names - nothing visible has changed yet, so any
+    // failure here is harmless.
+    char primary_temp[64];
+    char delta_temp[64];
+    char bak1[64];
+    char bak2_temp[72];
+    ContactFileHeader header;
+    long file_size = 0;
+    temp_name_for(primary_temp, sizeof(primary_temp), BACKUP_PRIMARY_FILE);
+    temp_name_for(delta_temp, sizeof(delta_temp), BACKUP_NEXT_DELTA_FILE);
+    backup_name(bak1, sizeof(bak1), 1);
+    backup_name(bak2_temp, sizeof(bak2_temp), 2);
+    strcat(bak2_temp, ".tmp");
+
+    if (!write_snapshot(list, primary_temp, false, next_id, 0, &header, &file_size))
+    {
+        contact_list_free(&previous);
+        return false;
+    }
+    bool have_delta = have_previous &&
+                      write_delta(list, header.data_checksum, &previous, &previous_header, delta_temp, verbose);
+    contact_list_free(&previous);
+
+    // === STEP 2: What the old .bak1 becomes as it moves up ===
+    Bak1Move move = prepare_bak1_move(0, bak2_temp, verbose);
+
+    // === STEP 3: Publish - only renames from here on ===
+    rotate_backups();
+    finish_bak1_move(move, bak2_temp);
+
+    // A hard link leaves contacts.dat in place until the replace below;
+    // both calls fail harmlessly on the very first save
+    if (!file_link(BACKUP_PRIMARY_FILE, bak1))
+    {
+        rename(BACKUP_PRIMARY_FILE, bak1); // file system without links
+    }
+
+    if (!file_replace(primary_temp, BACKUP_PRIMARY_FILE))
+    {
+        printf("SAVE ERROR: Cannot replace '%s'\n", BACKUP_PRIMARY_FILE);
+        remove(primary_temp);
+        remove(delta_temp);
+        return false;
+    }
+
+    // Only once its base is contacts.dat; a crash before leaves none
+    if (have_delta && !file_replace(delta_temp, BACKUP_NEXT_DELTA_FILE))
+    {
+        remove(delta_temp);
+    }
+    file_sync_dir(BACKUP_PRIMARY_FILE); // one directory flush covers every rename above
+
+    if (verbose)
+    {
+        report_saved(list, BACKUP_PRIMARY_FILE, file_size);
+    }
+    if (!contact_reader_write_slots(BACKUP_PRIMARY_FILE, list, &header))
+    {
+        printf("WARNING: Could not write slot index for '%s'\n", BACKUP_PRIMARY_FILE);
+    }
+    if (!contact_index_write(BACKUP_PRIMARY_FILE, list, &header))
+    {
+        printf("WARNING: Could not write search index for '%s'\n", BACKUP_PRIMARY_FILE);
+    }
+    return true;
+}
@@ -10,31 +10,84 @@
 
 #define FILE_MAGIC_LRBT 0x4C524254 // "LRBT"
 #define FILE_MAGIC_TRBL 0x5452424C // "TRBL"
+#define FILE_MAGIC_LRBD 0x4C524244 // "LRBD" - delta backup
+#define FILE_PATCH_PENDING 0x50544348 // "PTCH"
 #define FILE_FORMAT_VERSION 1
+#define FILE_FORMAT_VERSION_COMPRESSED 2 // body is a contact_compress payload
+#define CONTACT_PACKED_SIZE 323 // 50 + 15 + 254 + 4, no padding
+#define BACKUP_PRIMARY_FILE "contacts.dat"
+#define BACKUP_GENERATIONS 30 // contacts.dat.bak1 ... contacts.dat.bak30
+#define BACKUP_KEYFRAME_INTERVAL 10 // at most this many generations per delta chain
+#define BACKUP_NEXT_DELTA_FILE "contacts.dat.delta" // contacts.dat -> .bak1, becomes .bak2 on the next save
 
 typedef struct
 {
     uint32_t magic;   // "LRBT"
-    uint32_t version; // 1
+    uint32_t version; // 1, or 2 = compressed
     uint32_t header_checksum;
-    uint32_t data_checksum;
+    uint32_t data_checksum; // over the packed records (fields zero-padded past the NUL)
     uint32_t contact_count;
     uint32_t next_contact_id;
     time_t timestamp;
     uint32_t header_size;  // sizeof(ContactFileHeader)
     uint32_t contact_size; // sizeof(Contact)
-    uint32_t reserved[4];
+    uint32_t pending_flag;     // FILE_PATCH_PENDING while an in-place update runs
+    uint32_t pending_checksum; // data_checksum the file will have after it
+    uint32_t payload_size;     // version 2: compressed bytes between header and footer
+    uint32_t reserved;
 } ContactFileHeader;
 
+// Header of a delta backup (.bakN). Body: remove_count ids, then
+// restore_count packed contacts. Footer is the same as contacts.dat.
+typedef struct
+{
+    uint32_t magic;   // "LRBD"
+    uint32_t version; // 1
+    uint32_t header_checksum;
+    uint32_t data_checksum;
+    uint32_t remove_count;    // ids added since this generation
+    uint32_t restore_count;   // records changed/deleted since
+    uint32_t next_contact_id; // of this (older) generation
+    time_t timestamp;         // save time of this generation
+    uint32_t header_size;     // sizeof(ContactDeltaHeader)
+    uint32_t contact_size;    // CONTACT_PACKED_SIZE
+    uint32_t base_checksum;   // data_checksum of the newer generation it applies to
+    uint32_t reserved[3];
+} ContactDeltaHeader;
+
 // Function prototypes
 bool contact_file_save(const ContactList *list, const char *filename);
 bool contact_file_load(ContactList *list, const char *filename);
+// Same as contact_file_save, but writes a compressed (version 2) snapshot.
+// Every loader accepts it; in-place updates and slot reads do not.
+bool contact_file_save_compressed(const ContactList *list, const char *filename);
 uint32_t fletcher32(const void *data, size_t length);
+// Continues a data checksum (start from 0) over the next 'length' bytes,
+// for callers that read a snapshot's records in pieces
+uint32_t contact_file_checksum_update(uint32_t checksum, const void *data, size_t length);
 static void fletcher32_update_stream(uint32_t *sum1, uint32_t *sum2, const void *data, size_t length);
 static bool write_contact(FILE *file, const Contact *contact);
 static uint32_t calculate_packed_checksum_stream(const ContactList *list);
 bool contact_file_validate(const char *filename);
 bool rotate_backups(void);
 bool contact_file_save_backup(const ContactList *list);
+// Same, with next_contact_id passed in - touches no globals, so a private
+// copy of the list can be saved from another thread. verbose = false keeps
+// a successful save silent (errors are still printed).
+bool contact_file_save_backup_snapshot(const ContactList *list, uint32_t next_id, bool verbose);
 bool contact_file_load_backup(ContactList *list);
+bool contact_file_load_generation(ContactList *list, int generation); // 0 = contacts.dat
+
+// Patches every listed id in place: each slot is overwritten and the
+// checksums are updated incrementally instead of rewriting the file. First
+// checks that 'list' is the snapshot in 'filename' apart from those
+// records; for contacts.dat the unpatched file then becomes backup
+// generation 1. Adds and deletes are not patchable. False means a full
+// save is required (nothing was written if the check failed).
+bool contact_file_update_records(const char *filename, const ContactList *list,
+                                 const int ids[], int count, bool verbose);
+
+// Packed record helpers (same byte layout as write_contact)
+void contact_pack(const Contact *contact, uint8_t out[CONTACT_PACKED_SIZE]);
+void contact_unpack(Contact *contact, const uint8_t in[CONTACT_PACKED_SIZE]);
 #endif
\ No newline at end of file
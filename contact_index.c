@@ -0,0 +1,549 @@
+#include "contact_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h> // offsetof
+
+// ============================================================================
+// ORDERING
+// ============================================================================
+
+static const char *field_text(const Contact *contact, IndexField field)
+{
+    switch (field)
+    {
+    case INDEX_BY_NAME:
+        return contact->name;
+    case INDEX_BY_PHONE:
+        return contact->phone;
+    default:
+        return contact->email;
+    }
+}
+
+static int compare_positions(const ContactList *list, IndexField field, uint32_t a, uint32_t b)
+{
+    const Contact *contact_a = &list->data[a];
+    const Contact *contact_b = &list->data[b];
+    if (field == INDEX_BY_ID)
+    {
+        return (contact_a->id > contact_b->id) - (contact_a->id < contact_b->id);
+    }
+    return strcmp(field_text(contact_a, field), field_text(contact_b, field));
+}
+
+// Stable merge sort - qsort has no context pointer, and a static one would
+// race with the background saver building its own index
+static void merge_sort(uint32_t *order, uint32_t *scratch, uint32_t count,
+                       const ContactList *list, IndexField field)
+{
+    if (count < 2)
+    {
+        return;
+    }
+
+    uint32_t half = count / 2;
+    merge_sort(order, scratch, half, list, field);
+    merge_sort(order + half, scratch, count - half, list, field);
+
+    if (compare_positions(list, field, order[half - 1], order[half]) <= 0)
+    {
+        return; // already in order (common for ids)
+    }
+
+    memcpy(scratch, order, half * sizeof(uint32_t));
+    uint32_t i = 0, j = half, k = 0;
+    while (i < half && j < count)
+    {
+        if (compare_positions(list, field, order[j], scratch[i]) < 0)
+            order[k++] = order[j++];
+        else
+            order[k++] = scratch[i++];
+    }
+    while (i < half)
+    {
+        order[k++] = scratch[i++];
+    }
+}
+
+static uint32_t *build_order(const ContactList *list, IndexField field)
+{
+    uint32_t count = (uint32_t)list->size;
+    uint32_t *order = malloc((count > 0 ? count : 1) * sizeof(uint32_t));
+    uint32_t *scratch = malloc((count / 2 + 1) * sizeof(uint32_t));
+    if (order == NULL || scratch == NULL)
+    {
+        free(order);
+        free(scratch);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        order[i] = i;
+    }
+    merge_sort(order, scratch, count, list, field);
+    free(scratch);
+    return order;
+}
+
+static void index_path(char *buffer, size_t size, const char *data_filename)
+{
+    // "contacts.dat" -> "contacts.idx", anything else gets the suffix appended
+    size_t length = strlen(data_filename);
+    if (length > 4 && strcmp(data_filename + length - 4, ".dat") == 0)
+    {
+        snprintf(buffer, size, "%.*s%s", (int)(length - 4), data_filename, INDEX_SUFFIX);
+    }
+    else
+    {
+        snprintf(buffer, size, "%s%s", data_filename, INDEX_SUFFIX);
+    }
+}
+
+static uint32_t index_header_checksum(const ContactIndexHeader *header)
+{
+    return fletcher32(&header->count, sizeof(ContactIndexHeader) - offsetof(ContactIndexHeader, count));
+}
+
+// ============================================================================
+// PERSISTENCE
+// ============================================================================
+
+bool contact_index_write(const char *data_filename, const ContactList *list,
+                         const ContactFileHeader *header)
+{
+    if (data_filename == NULL || list == NULL || header == NULL)
+    {
+        return false;
+    }
+
+    char path[256];
+    char temp_name[264];
+    index_path(path, sizeof(path), data_filename);
+    snprintf(temp_name, sizeof(temp_name), "%s.tmp", path);
+
+    ContactIndexHeader index_header = {0};
+    FILE *file = NULL;
+    bool success = false;
+
+    // === STEP 1: Sort (ids are usually ascending already - one pass) ===
+    uint32_t *order = build_order(list, INDEX_BY_ID);
+    if (order == NULL)
+    {
+        printf("INDEX ERROR: Out of memory sorting %d contacts\n", list->size);
+        goto cleanup;
+    }
+
+    // === STEP 2: Header bound to the snapshot ===
+    index_header.magic = INDEX_MAGIC;
+    index_header.version = INDEX_VERSION;
+    index_header.count = (uint32_t)list->size;
+    index_header.data_checksum = header->data_checksum;
+    index_header.data_timestamp = header->timestamp;
+    index_header.column_checksum = fletcher32(order, (size_t)list->size * sizeof(uint32_t));
+    index_header.header_checksum = index_header_checksum(&index_header);
+
+    // === STEP 3: Temp file + rename, like the snapshot itself ===
+    file = fopen(temp_name, "wb");
+    if (file == NULL)
+    {
+        goto cleanup;
+    }
+    success = fwrite(&index_header, sizeof(index_header), 1, file) == 1 &&
+              (list->size == 0 ||
+               fwrite(order, sizeof(uint32_t), (size_t)list->size, file) == (size_t)list->size) &&
+              file_sync(file);
+
+cleanup:
+    if (file != NULL && fclose(file) != 0)
+    {
+        success = false;
+    }
+    if (success && !file_replace(temp_name, path))
+    {
+        success = false; // e.g. still mapped by a reader on Windows
+    }
+    if (!success && file != NULL)
+    {
+        remove(temp_name);
+    }
+    free(order);
+    return success;
+}
+
+bool contact_index_restamp(const char *data_filename, const ContactFileHeader *old_header,
+                           const ContactFileHeader *header)
+{
+    if (data_filename == NULL || old_header == NULL || header == NULL)
+    {
+        return false;
+    }
+
+    char path[256];
+    index_path(path, sizeof(path), data_filename);
+    FILE *file = fopen(path, "r+b");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    ContactIndexHeader index_header;
+    bool bound = fread(&index_header, sizeof(index_header), 1, file) == 1 &&
+                 index_header.magic == INDEX_MAGIC &&
+                 index_header.version == INDEX_VERSION &&
+                 index_header.header_checksum == index_header_checksum(&index_header) &&
+                 index_header.count == header->contact_count &&
+                 index_header.data_checksum == old_header->data_checksum &&
+                 index_header.data_timestamp == old_header->timestamp;
+
+    // Same positions in the same id order - only the binding moves
+    bool success = false;
+    if (bound)
+    {
+        index_header.data_checksum = header->data_checksum;
+        index_header.data_timestamp = header->timestamp;
+        index_header.header_checksum = index_header_checksum(&index_header);
+        success = fseek(file, 0, SEEK_SET) == 0 &&
+                  fwrite(&index_header, sizeof(index_header), 1, file) == 1 &&
+                  file_sync(file);
+    }
+    if (fclose(file) != 0)
+    {
+        success = false;
+    }
+    return success;
+}
+
+bool contact_index_open(ContactIndex *index, const char *data_filename, const ContactList *list)
+{
+    if (index == NULL || data_filename == NULL || list == NULL)
+    {
+        return false;
+    }
+    memset(index, 0, sizeof(*index));
+
+    // === STEP 1: Header of the snapshot the list came from ===
+    FILE *data_file = fopen(data_filename, "rb");
+    if (data_file == NULL)
+    {
+        return false;
+    }
+    ContactFileHeader data_header;
+    bool have_header = fread(&data_header, sizeof(data_header), 1, data_file) == 1;
+    fclose(data_file);
+    if (!have_header)
+    {
+        return false;
+    }
+
+    // === STEP 2: Map the index and check it belongs to that snapshot ===
+    char path[256];
+    index_path(path, sizeof(path), data_filename);
+    if (!file_map(path, &index->map))
+    {
+        return false;
+    }
+
+    const ContactIndexHeader *header = (const ContactIndexHeader *)index->map.data;
+    size_t expected_size = sizeof(ContactIndexHeader) + (size_t)list->size * sizeof(uint32_t);
+    if (index->map.size != expected_size ||
+        header->magic != INDEX_MAGIC ||
+        header->version != INDEX_VERSION ||
+        header->header_checksum != index_header_checksum(header) ||
+        header->count != (uint32_t)list->size ||
+        header->data_checksum != data_header.data_checksum ||
+        header->data_timestamp != data_header.timestamp)
+    {
+        contact_index_close(index);
+        return false; // stale or foreign - lookups rebuild
+    }
+
+    // The column is checked on first use, so an unused index costs nothing
+    index->order[INDEX_BY_ID] = (const uint32_t *)(index->map.data + sizeof(ContactIndexHeader));
+    index->id_checksum = header->column_checksum;
+    index->count = header->count;
+    return true;
+}
+
+void contact_index_close(ContactIndex *index)
+{
+    if (index == NULL)
+    {
+        return;
+    }
+
+    file_unmap(&index->map);
+    for (int field = 0; field < INDEX_FIELD_COUNT; field++)
+    {
+        free(index->owned[field]);
+    }
+    memset(index, 0, sizeof(*index));
+}
+
+void contact_index_invalidate(ContactIndex *index)
+{
+    contact_index_close(index); // also releases the file for the next save
+}
+
+// ============================================================================
+// LOOKUPS
+// ============================================================================
+
+static bool is_mapped(const ContactIndex *index, IndexField field)
+{
+    return index->order[field] != NULL && index->owned[field] == NULL;
+}
+
+// The mapped id order is used only if it is intact and really sorts this list
+static bool verify_order(const ContactIndex *index, const ContactList *list)
+{
+    const uint32_t *order = index->order[INDEX_BY_ID];
+    uint32_t count = index->count;
+
+    if (fletcher32(order, (size_t)count * sizeof(uint32_t)) != index->id_checksum)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (order[i] >= count)
+            return false;
+        if (i > 0 && compare_positions(list, INDEX_BY_ID, order[i - 1], order[i]) > 0)
+            return false;
+    }
+    return true;
+}
+
+static void drop_order(ContactIndex *index, IndexField field)
+{
+    free(index->owned[field]);
+    index->owned[field] = NULL;
+    index->order[field] = NULL;
+}
+
+static const uint32_t *order_for(ContactIndex *index, const ContactList *list, IndexField field)
+{
+    if (index->count != (uint32_t)list->size)
+    {
+        contact_index_invalidate(index); // list changed behind our back
+    }
+
+    if (field == INDEX_BY_ID && is_mapped(index, field) && !index->id_verified)
+    {
+        index->id_verified = verify_order(index, list);
+        if (!index->id_verified)
+        {
+            printf("INDEX WARNING: Persisted id order does not match, rebuilding\n");
+            index->order[field] = NULL;
+            file_unmap(&index->map);
+        }
+    }
+
+    if (index->order[field] == NULL)
+    {
+        index->owned[field] = build_order(list, field);
+        index->order[field] = index->owned[field];
+        index->count = (uint32_t)list->size;
+    }
+    return index->order[field];
+}
+
+const uint32_t *contact_index_order(ContactIndex *index, const ContactList *list, IndexField field)
+{
+    if (index == NULL || list == NULL || field >= INDEX_FIELD_COUNT)
+    {
+        return NULL;
+    }
+    return order_for(index, list, field);
+}
+
+int contact_index_find_id(ContactIndex *index, const ContactList *list, int id)
+{
+    if (index == NULL || list == NULL)
+    {
+        return -1;
+    }
+
+    const uint32_t *order = order_for(index, list, INDEX_BY_ID);
+    if (order == NULL)
+    {
+        return contact_find_by_id_in_list(list, id); // out of memory - plain scan
+    }
+
+    uint32_t low = 0, high = index->count;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        if (list->data[order[mid]].id < id)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return (low < index->count && list->data[order[low]].id == id) ? (int)order[low] : -1;
+}
+
+// ============================================================================
+// UPDATES
+// ============================================================================
+
+// Updates work on owned orders with room for 'extra' more positions. The
+// mapped id order is copied after a checksum check - the list may already
+// have moved under it, so its sort is not re-checked - and the file is
+// released for the next save. False (orders dropped) if out of memory.
+static bool own_orders(ContactIndex *index, uint32_t extra)
+{
+    if (is_mapped(index, INDEX_BY_ID))
+    {
+        const uint32_t *mapped = index->order[INDEX_BY_ID];
+        size_t bytes = (size_t)index->count * sizeof(uint32_t);
+        uint32_t *copy = NULL;
+        if (index->id_verified || fletcher32(mapped, bytes) == index->id_checksum)
+        {
+            copy = malloc(bytes > 0 ? bytes : 1);
+        }
+        if (copy != NULL)
+        {
+            memcpy(copy, mapped, bytes);
+        }
+        index->owned[INDEX_BY_ID] = copy;
+        index->order[INDEX_BY_ID] = copy; // NULL: rebuilt on the next lookup
+        file_unmap(&index->map);
+    }
+
+    for (int field = 0; extra > 0 && field < INDEX_FIELD_COUNT; field++)
+    {
+        if (index->owned[field] == NULL)
+            continue;
+        uint32_t *grown = realloc(index->owned[field], (index->count + extra) * sizeof(uint32_t));
+        if (grown == NULL)
+        {
+            contact_index_invalidate(index);
+            return false;
+        }
+        index->owned[field] = grown;
+        index->order[field] = grown;
+    }
+    return true;
+}
+
+// Puts 'position' into 'order' (of 'length') where a full sort would: ties
+// stay in list order
+static void insert_position(uint32_t *order, uint32_t length, const ContactList *list,
+                            IndexField field, uint32_t position)
+{
+    uint32_t low = 0, high = length;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        int cmp = compare_positions(list, field, order[mid], position);
+        if (cmp < 0 || (cmp == 0 && order[mid] < position))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    memmove(&order[low + 1], &order[low], (length - low) * sizeof(uint32_t));
+    order[low] = position;
+}
+
+void contact_index_appended(ContactIndex *index, const ContactList *list, uint32_t first)
+{
+    if (index == NULL || list == NULL)
+    {
+        return;
+    }
+    if (index->count != first || first > (uint32_t)list->size)
+    {
+        contact_index_invalidate(index);
+        return;
+    }
+
+    uint32_t added = (uint32_t)list->size - first;
+    if (added == 0 || !own_orders(index, added))
+    {
+        return;
+    }
+
+    for (int field = 0; field < INDEX_FIELD_COUNT; field++)
+    {
+        if (index->owned[field] == NULL)
+            continue;
+        if (field != INDEX_BY_ID && added > 1)
+        {
+            drop_order(index, (IndexField)field); // one sort beats a memmove per imported row
+            continue;
+        }
+        for (uint32_t position = first; position < (uint32_t)list->size; position++)
+        {
+            insert_position(index->owned[field], position, list, (IndexField)field, position);
+        }
+    }
+    index->count = (uint32_t)list->size;
+}
+
+void contact_index_removed(ContactIndex *index, const ContactList *list, uint32_t position)
+{
+    if (index == NULL || list == NULL)
+    {
+        return;
+    }
+    if (index->count != (uint32_t)list->size + 1 || position >= index->count)
+    {
+        contact_index_invalidate(index);
+        return;
+    }
+    if (!own_orders(index, 0))
+    {
+        return;
+    }
+
+    // Relative order of the rest is unchanged - drop the entry, renumber
+    for (int field = 0; field < INDEX_FIELD_COUNT; field++)
+    {
+        uint32_t *order = index->owned[field];
+        if (order == NULL)
+            continue;
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < index->count; i++)
+        {
+            if (order[i] != position)
+                order[kept++] = order[i] > position ? order[i] - 1 : order[i];
+        }
+    }
+    index->count--;
+}
+
+void contact_index_edited(ContactIndex *index, const ContactList *list, uint32_t position,
+                          IndexField field)
+{
+    if (index == NULL || list == NULL || field >= INDEX_FIELD_COUNT)
+    {
+        return;
+    }
+    if (index->count != (uint32_t)list->size || position >= index->count)
+    {
+        contact_index_invalidate(index);
+        return;
+    }
+
+    // Ids never change; a text order is only ever built in memory
+    uint32_t *order = index->owned[field];
+    if (field == INDEX_BY_ID || order == NULL)
+    {
+        return;
+    }
+
+    // Take the entry out, then back in at its new place
+    uint32_t at = 0;
+    while (at < index->count && order[at] != position)
+    {
+        at++;
+    }
+    if (at == index->count)
+    {
+        drop_order(index, field);
+        return;
+    }
+    memmove(&order[at], &order[at + 1], (index->count - at - 1) * sizeof(uint32_t));
+    insert_position(order, index->count - 1, list, field, position);
+}
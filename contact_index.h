@@ -0,0 +1,94 @@
+#ifndef CONTACT_INDEX_H
+#define CONTACT_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "contact_dynamic.h"
+#include "contact_file.h"
+#include "file_io.h"
+
+// Sorted search orders over a ContactList: for each field, the list
+// positions ordered by that field. Saves persist the id order next to the
+// snapshot ("contacts.dat" -> "contacts.idx") so startup can map it instead
+// of sorting; the file is only trusted for the snapshot it was written with.
+// The name/phone/email orders are built in memory by the first query that
+// sorts on them.
+//
+// Layout: ContactIndexHeader, then uint32_t position[count] in id order.
+
+#define INDEX_MAGIC 0x4C524249 // "LRBI"
+#define INDEX_VERSION 2
+#define INDEX_SUFFIX ".idx"
+
+typedef enum
+{
+    INDEX_BY_ID,
+    INDEX_BY_NAME,
+    INDEX_BY_PHONE,
+    INDEX_BY_EMAIL,
+    INDEX_FIELD_COUNT
+} IndexField;
+
+typedef struct
+{
+    uint32_t magic;   // "LRBI"
+    uint32_t version; // 2
+    uint32_t header_checksum;
+    uint32_t count;
+    uint32_t data_checksum;   // of the snapshot it indexes
+    uint32_t column_checksum; // of the id order
+    time_t data_timestamp;    // of the snapshot it indexes
+    uint32_t reserved[4];
+} ContactIndexHeader;
+
+typedef struct
+{
+    FileMap map;                              // persisted id order, if any
+    const uint32_t *order[INDEX_FIELD_COUNT]; // NULL = not available
+    uint32_t *owned[INDEX_FIELD_COUNT];       // orders built in memory
+    bool id_verified;                         // mapped id order checked against the list
+    uint32_t id_checksum;
+    uint32_t count;
+} ContactIndex;
+
+// Writes the index for a snapshot of 'list' that was just saved as
+// 'data_filename' with 'header'.
+bool contact_index_write(const char *data_filename, const ContactList *list,
+                         const ContactFileHeader *header);
+
+// After an in-place update from 'old_header' to 'header': edits never move
+// ids, so an index bound to the old snapshot is re-bound to the new one
+// (header only). Returns false if it was not bound to the old snapshot.
+bool contact_index_restamp(const char *data_filename, const ContactFileHeader *old_header,
+                           const ContactFileHeader *header);
+
+// Maps the persisted index of 'data_filename' if it was written for that
+// file's current header and matches 'list' in size. Returns false (and
+// leaves the index empty) otherwise - lookups then rebuild in memory.
+bool contact_index_open(ContactIndex *index, const char *data_filename, const ContactList *list);
+void contact_index_close(ContactIndex *index);
+
+// The list changed in some unknown way - drop every order (and the mapping).
+void contact_index_invalidate(ContactIndex *index);
+
+// The list changed in a known way - the built orders are updated in place
+// (a binary search and a memmove each) rather than dropped:
+//   appended: rows [first, list->size) were added at the end. New contacts
+//             get ids above every existing one, so the id order only grows
+//             at its tail; a bulk append drops the other orders instead.
+//   removed:  the row at 'position' is gone and the ones after moved down.
+//   edited:   'field' of the row at 'position' changed (ids never do).
+void contact_index_appended(ContactIndex *index, const ContactList *list, uint32_t first);
+void contact_index_removed(ContactIndex *index, const ContactList *list, uint32_t position);
+void contact_index_edited(ContactIndex *index, const ContactList *list, uint32_t position,
+                          IndexField field);
+
+// Positions of 'list' (list->size of them) sorted by 'field' - ties in
+// list order. Builds the order if needed; NULL if out of memory.
+const uint32_t *contact_index_order(ContactIndex *index, const ContactList *list, IndexField field);
+
+// Position of 'id' in 'list', or -1. Builds the id order if needed.
+int contact_index_find_id(ContactIndex *index, const ContactList *list, int id);
+
+#endif
@@ -0,0 +1,332 @@
+#include "contact_journal.h"
+#include "file_io.h"
+#include <stdio.h>
+#include <string.h>
+
+// Module state - one journal per process, like contact_list
+static FILE *journal_file = NULL;
+static uint32_t journal_seq = 1;  // seq of the next entry
+static int journal_pending = 0;   // entries written since the last fsync
+
+// ============================================================================
+// ENTRY ENCODING
+// ============================================================================
+
+static void journal_encode(uint8_t entry[JOURNAL_ENTRY_SIZE], uint32_t op,
+                           uint32_t seq, const Contact *contact)
+{
+    uint32_t fields[4];
+    fields[0] = JOURNAL_MAGIC;
+    fields[1] = op;
+    fields[2] = seq;
+    fields[3] = (uint32_t)next_contact_id;
+
+    memcpy(entry, fields, sizeof(fields));
+    contact_pack(contact, entry + sizeof(fields));
+
+    uint32_t checksum = fletcher32(entry, JOURNAL_ENTRY_SIZE - sizeof(uint32_t));
+    memcpy(entry + JOURNAL_ENTRY_SIZE - sizeof(uint32_t), &checksum, sizeof(uint32_t));
+}
+
+// Returns false for anything a torn or corrupted write could leave behind
+static bool journal_decode(const uint8_t entry[JOURNAL_ENTRY_SIZE], uint32_t fields[4],
+                           Contact *contact)
+{
+    uint32_t stored_checksum;
+    memcpy(&stored_checksum, entry + JOURNAL_ENTRY_SIZE - sizeof(uint32_t), sizeof(uint32_t));
+    if (stored_checksum != fletcher32(entry, JOURNAL_ENTRY_SIZE - sizeof(uint32_t)))
+    {
+        return false;
+    }
+
+    memcpy(fields, entry, 4 * sizeof(uint32_t));
+    if (fields[0] != JOURNAL_MAGIC ||
+        fields[1] < JOURNAL_OP_ADD || fields[1] > JOURNAL_OP_DELETE)
+    {
+        return false;
+    }
+
+    contact_unpack(contact, entry + 4 * sizeof(uint32_t));
+    return true;
+}
+
+// Ops are idempotent (add/edit = upsert, delete of a missing id = no-op), so
+// replaying a journal that was already folded into the snapshot is harmless.
+static bool journal_apply(ContactList *list, uint32_t op, const Contact *contact)
+{
+    int index = contact_find_by_id_in_list(list, contact->id);
+
+    if (op == JOURNAL_OP_DELETE)
+    {
+        if (index != -1)
+        {
+            contact_list_remove_by_index(list, index);
+        }
+        return true;
+    }
+
+    if (index != -1)
+    {
+        list->data[index] = *contact;
+        contact_list_mark_dirty(list, index);
+        return true;
+    }
+    return contact_list_add(list, contact);
+}
+
+// Walks the journal from the start. Applies entries to 'list' when given.
+// Returns the byte offset where the valid entries end.
+static long journal_scan(FILE *file, ContactList *list, uint32_t *last_seq, int *applied)
+{
+    uint8_t entry[JOURNAL_ENTRY_SIZE];
+    uint32_t fields[4];
+    Contact contact;
+    long valid_end = 0;
+
+    rewind(file);
+    while (fread(entry, 1, JOURNAL_ENTRY_SIZE, file) == JOURNAL_ENTRY_SIZE)
+    {
+        if (!journal_decode(entry, fields, &contact))
+        {
+            break; // torn tail - everything after this is garbage
+        }
+
+        if (list != NULL)
+        {
+            if (!journal_apply(list, fields[1], &contact))
+            {
+                break;
+            }
+            if ((int)fields[3] > next_contact_id)
+            {
+                next_contact_id = (int)fields[3];
+            }
+            (*applied)++;
+        }
+
+        *last_seq = fields[2];
+        valid_end += (long)JOURNAL_ENTRY_SIZE;
+    }
+
+    return valid_end;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+bool contact_journal_open(void)
+{
+    if (journal_file != NULL)
+    {
+        return true;
+    }
+
+    journal_file = fopen(JOURNAL_FILENAME, "r+b");
+    if (journal_file == NULL)
+    {
+        journal_file = fopen(JOURNAL_FILENAME, "w+b"); // first run
+    }
+    if (journal_file == NULL)
+    {
+        printf("JOURNAL ERROR: Cannot open '%s'\n", JOURNAL_FILENAME);
+        return false;
+    }
+
+    uint32_t last_seq = 0;
+    long valid_end = journal_scan(journal_file, NULL, &last_seq, NULL);
+
+    fseek(journal_file, 0, SEEK_END);
+    if (ftell(journal_file) != valid_end)
+    {
+        printf("JOURNAL WARNING: Dropping torn tail (%ld bytes)\n",
+               ftell(journal_file) - valid_end);
+        if (!file_truncate(journal_file, valid_end))
+        {
+            printf("JOURNAL ERROR: Cannot truncate '%s'\n", JOURNAL_FILENAME);
+            fclose(journal_file);
+            journal_file = NULL;
+            return false;
+        }
+    }
+
+    fseek(journal_file, valid_end, SEEK_SET);
+    journal_seq = last_seq + 1;
+    journal_pending = 0;
+    return true;
+}
+
+void contact_journal_close(void)
+{
+    if (journal_file == NULL)
+    {
+        return;
+    }
+
+    contact_journal_sync();
+    fclose(journal_file);
+    journal_file = NULL;
+}
+
+bool contact_journal_append(JournalOp op, const Contact *contact)
+{
+    if (journal_file == NULL || contact == NULL)
+    {
+        return false;
+    }
+
+    uint8_t entry[JOURNAL_ENTRY_SIZE];
+    journal_encode(entry, (uint32_t)op, journal_seq, contact);
+
+    if (fwrite(entry, 1, JOURNAL_ENTRY_SIZE, journal_file) != JOURNAL_ENTRY_SIZE ||
+        fflush(journal_file) != 0)
+    {
+        printf("JOURNAL ERROR: Failed to append entry %u\n", journal_seq);
+        return false;
+    }
+
+    journal_seq++;
+    journal_pending++;
+
+    // Group commit: one fsync covers the whole group
+    if (journal_pending >= JOURNAL_GROUP_SIZE)
+    {
+        return contact_journal_sync();
+    }
+    return true;
+}
+
+bool contact_journal_sync(void)
+{
+    if (journal_file == NULL)
+    {
+        return false;
+    }
+    if (journal_pending == 0)
+    {
+        return true;
+    }
+
+    if (!file_sync(journal_file))
+    {
+        printf("JOURNAL ERROR: fsync failed\n");
+        return false;
+    }
+    journal_pending = 0;
+    return true;
+}
+
+int contact_journal_replay(ContactList *list)
+{
+    if (list == NULL)
+    {
+        return -1;
+    }
+
+    FILE *file = fopen(JOURNAL_FILENAME, "rb");
+    if (file == NULL)
+    {
+        return 0; // No journal = nothing to replay
+    }
+
+    uint32_t last_seq = 0;
+    int applied = 0;
+    journal_scan(file, list, &last_seq, &applied);
+    fclose(file);
+
+    if (applied > 0)
+    {
+        printf("JOURNAL: Replayed %d change(s) on top of the snapshot\n", applied);
+    }
+    return applied;
+}
+
+int contact_journal_edited_ids(int ids[], int max)
+{
+    uint8_t entry[JOURNAL_ENTRY_SIZE];
+    uint32_t fields[4];
+    Contact contact;
+    int count = 0;
+
+    if (journal_file == NULL || ids == NULL)
+    {
+        return -1;
+    }
+
+    rewind(journal_file);
+    while (fread(entry, 1, JOURNAL_ENTRY_SIZE, journal_file) == JOURNAL_ENTRY_SIZE &&
+           journal_decode(entry, fields, &contact))
+    {
+        if (fields[1] != JOURNAL_OP_EDIT || count == max)
+        {
+            count = -1;
+            break;
+        }
+        ids[count++] = contact.id;
+    }
+
+    fseek(journal_file, 0, SEEK_END); // appends continue at the end
+    return count;
+}
+
+bool contact_journal_compact(const ContactList *list, bool from_snapshot)
+{
+    // Step 1: fresh snapshot - the journal stays valid until this succeeds.
+    // Edits alone are patched into their slots; anything else (or a list
+    // that did not come from contacts.dat) needs the full rewrite.
+    uint32_t seq = contact_journal_last_seq();
+    int ids[JOURNAL_PATCH_LIMIT];
+    int edited = from_snapshot ? contact_journal_edited_ids(ids, JOURNAL_PATCH_LIMIT) : -1;
+    bool patched = edited > 0 &&
+                   contact_file_update_records(BACKUP_PRIMARY_FILE, list, ids, edited, true);
+
+    if (!patched && !contact_file_save_backup(list))
+    {
+        return false;
+    }
+
+    // Step 2: the snapshot now holds every op, so empty the journal
+    return contact_journal_checkpoint(seq);
+}
+
+bool contact_journal_is_empty(void)
+{
+    FILE *file = fopen(JOURNAL_FILENAME, "rb");
+    if (file == NULL)
+    {
+        return true; // first run
+    }
+
+    uint32_t last_seq = 0;
+    long valid_end = journal_scan(file, NULL, &last_seq, NULL);
+    fclose(file);
+    return valid_end == 0; // a torn tail alone holds nothing to replay
+}
+
+uint32_t contact_journal_last_seq(void)
+{
+    return journal_seq - 1;
+}
+
+bool contact_journal_checkpoint(uint32_t seq)
+{
+    if (journal_file == NULL)
+    {
+        remove(JOURNAL_FILENAME);
+        return true;
+    }
+
+    if (seq != journal_seq - 1)
+    {
+        return true; // newer entries still needed - keep the whole journal
+    }
+
+    if (!file_truncate(journal_file, 0))
+    {
+        printf("JOURNAL ERROR: Cannot truncate '%s' after compaction\n", JOURNAL_FILENAME);
+        return false;
+    }
+    rewind(journal_file);
+    journal_pending = 0;
+    return file_sync(journal_file);
+}
@@ -0,0 +1,63 @@
+#ifndef CONTACT_JOURNAL_H
+#define CONTACT_JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "contact_dynamic.h"
+#include "contact_file.h"
+
+#define JOURNAL_FILENAME "contacts.dat.wal"
+#define JOURNAL_MAGIC 0x4C52424A // "LRBJ"
+#define JOURNAL_GROUP_SIZE 16    // entries per fsync
+#define JOURNAL_PATCH_LIMIT 64   // more edits than this and a full rewrite is cheaper
+
+// On-disk entry: magic, op, seq, next_contact_id, packed contact, checksum
+#define JOURNAL_ENTRY_SIZE (4 * sizeof(uint32_t) + CONTACT_PACKED_SIZE + sizeof(uint32_t))
+
+typedef enum
+{
+    JOURNAL_OP_ADD = 1,
+    JOURNAL_OP_EDIT = 2,
+    JOURNAL_OP_DELETE = 3
+} JournalOp;
+
+// Opens the journal for appending. A torn tail left by a crash is cut off.
+bool contact_journal_open(void);
+
+// Syncs any pending group and closes the journal.
+void contact_journal_close(void);
+
+// Appends one op. The entry reaches the OS immediately; fsync happens
+// once every JOURNAL_GROUP_SIZE entries or on contact_journal_sync().
+bool contact_journal_append(JournalOp op, const Contact *contact);
+
+// Forces the pending group to disk.
+bool contact_journal_sync(void);
+
+// Applies every valid journal entry on top of an already loaded snapshot.
+// Returns the number of entries applied, or -1 on error.
+int contact_journal_replay(ContactList *list);
+
+// Folds the journal into a fresh snapshot (contacts.dat + backups) and
+// empties it. Edits are patched in place only when 'from_snapshot' says
+// the list was loaded from contacts.dat (not from the database).
+bool contact_journal_compact(const ContactList *list, bool from_snapshot);
+
+// True if the journal file holds no valid entry (or does not exist).
+// Works without contact_journal_open.
+bool contact_journal_is_empty(void);
+
+// Sequence number of the newest entry (0 = none yet this session).
+uint32_t contact_journal_last_seq(void);
+
+// Ids touched by a journal made only of edits - these can be patched in
+// place. Returns -1 if it holds adds/deletes, more than 'max' edits, or
+// the journal is not open.
+int contact_journal_edited_ids(int ids[], int max);
+
+// Call after a snapshot covering every entry up to 'seq' is durable.
+// Empties the journal unless newer entries were appended meanwhile (those
+// are kept; replaying the older ones again is harmless).
+bool contact_journal_checkpoint(uint32_t seq);
+
+#endif
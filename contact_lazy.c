@@ -0,0 +1,194 @@
+#include "contact_lazy.h"
+#include "file_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INDEX_CHUNK 256 // records per read while building the index
+
+// One sequential pass: keep id + name, skip decoding phone/email. The
+// bytes are checksummed as they stream past, so a bad file is refused
+// here instead of showing up record by record.
+static bool build_index(LazyContactFile *lazy)
+{
+    const ContactFileHeader *header = &lazy->reader.header;
+    uint32_t count = header->contact_count;
+    uint32_t checksum = 0;
+    uint8_t *chunk = malloc((size_t)INDEX_CHUNK * CONTACT_PACKED_SIZE);
+
+    lazy->index = malloc((count > 0 ? count : 1) * sizeof(LazyIndexEntry));
+    if (chunk == NULL || lazy->index == NULL)
+    {
+        printf("LAZY ERROR: Out of memory for %u index entries\n", count);
+        free(chunk);
+        return false;
+    }
+
+    const size_t id_offset = MAX_NAME_LEN + MAX_PHONE_LEN + MAX_EMAIL_LEN;
+    for (uint32_t first = 0; first < count; first += INDEX_CHUNK)
+    {
+        uint32_t n = (count - first < INDEX_CHUNK) ? count - first : INDEX_CHUNK;
+        long long offset = (long long)header->header_size + (long long)first * CONTACT_PACKED_SIZE;
+        if (!file_pread(lazy->reader.file, chunk, (size_t)n * CONTACT_PACKED_SIZE, offset))
+        {
+            printf("LAZY ERROR: Snapshot is shorter than its header claims\n");
+            free(chunk);
+            return false;
+        }
+        checksum = contact_file_checksum_update(checksum, chunk, (size_t)n * CONTACT_PACKED_SIZE);
+
+        for (uint32_t k = 0; k < n; k++)
+        {
+            const uint8_t *record = chunk + (size_t)k * CONTACT_PACKED_SIZE;
+            LazyIndexEntry *entry = &lazy->index[first + k];
+            memcpy(entry->name, record, MAX_NAME_LEN);
+            entry->name[MAX_NAME_LEN - 1] = '\0';
+            memcpy(&entry->id, record + id_offset, sizeof(int32_t));
+        }
+    }
+    free(chunk);
+
+    if (checksum != header->data_checksum)
+    {
+        printf("LAZY ERROR: DATA CHECKSUM FAILED\n");
+        return false;
+    }
+
+    lazy->count = count;
+    return true;
+}
+
+bool contact_lazy_open(LazyContactFile *lazy, const char *filename)
+{
+    if (lazy == NULL || filename == NULL)
+    {
+        return false;
+    }
+    memset(lazy, 0, sizeof(*lazy));
+
+    // === STEP 1: Header + id -> slot index (no records decoded) ===
+    if (!contact_reader_open(&lazy->reader, filename))
+    {
+        return false;
+    }
+
+    // An interrupted in-place update leaves two valid checksums; the full
+    // loader settles which one holds
+    if (lazy->reader.header.pending_flag == FILE_PATCH_PENDING)
+    {
+        contact_lazy_close(lazy);
+        return false;
+    }
+
+    // === STEP 2: Compact id/name index ===
+    if (!build_index(lazy))
+    {
+        contact_lazy_close(lazy);
+        return false;
+    }
+
+    for (int i = 0; i < LAZY_CACHE_SIZE; i++)
+    {
+        lazy->cache[i].slot = UINT32_MAX;
+    }
+    return true;
+}
+
+void contact_lazy_close(LazyContactFile *lazy)
+{
+    if (lazy == NULL)
+    {
+        return;
+    }
+
+    contact_reader_close(&lazy->reader);
+    free(lazy->index);
+    memset(lazy, 0, sizeof(*lazy));
+}
+
+uint32_t contact_lazy_count(const LazyContactFile *lazy)
+{
+    return lazy != NULL ? lazy->count : 0;
+}
+
+uint32_t contact_lazy_next_id(const LazyContactFile *lazy)
+{
+    return lazy != NULL ? lazy->reader.header.next_contact_id : 0;
+}
+
+const Contact *contact_lazy_get(LazyContactFile *lazy, uint32_t position)
+{
+    if (lazy == NULL || position >= lazy->count)
+    {
+        return NULL;
+    }
+
+    lazy->tick++;
+
+    // Hit: refresh its age. Miss: remember the least recently used entry.
+    LazyCacheEntry *victim = &lazy->cache[0];
+    for (int i = 0; i < LAZY_CACHE_SIZE; i++)
+    {
+        LazyCacheEntry *entry = &lazy->cache[i];
+        if (entry->slot == position)
+        {
+            entry->used = lazy->tick;
+            lazy->hits++;
+            return &entry->contact;
+        }
+        if (entry->used < victim->used)
+        {
+            victim = entry;
+        }
+    }
+
+    // Fault in: one positional read of one record
+    lazy->misses++;
+    if (!contact_reader_read_slot(&lazy->reader, position, &victim->contact))
+    {
+        victim->slot = UINT32_MAX;
+        victim->used = 0;
+        return NULL;
+    }
+    victim->slot = position;
+    victim->used = lazy->tick;
+    return &victim->contact;
+}
+
+const Contact *contact_lazy_find_id(LazyContactFile *lazy, int id)
+{
+    if (lazy == NULL)
+    {
+        return NULL;
+    }
+
+    // contacts.dat.slots - a binary search, no scan of the index
+    long slot = contact_reader_slot_of(&lazy->reader, id);
+    if (slot < 0)
+    {
+        return NULL;
+    }
+    return contact_lazy_get(lazy, (uint32_t)slot);
+}
+
+int contact_lazy_find_by_name(const LazyContactFile *lazy, const char *name,
+                              uint32_t results[], int max_results)
+{
+    if (lazy == NULL || name == NULL || results == NULL)
+    {
+        return -1;
+    }
+
+    // contact_name_matches only looks at ->name
+    Contact probe;
+    int found = 0;
+    for (uint32_t i = 0; i < lazy->count && found < max_results; i++)
+    {
+        memcpy(probe.name, lazy->index[i].name, MAX_NAME_LEN);
+        if (contact_name_matches(&probe, name))
+        {
+            results[found++] = i;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,59 @@
+#ifndef CONTACT_LAZY_H
+#define CONTACT_LAZY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "contact_dynamic.h"
+#include "contact_reader.h"
+
+// Lazy view of a contacts.dat snapshot. Opening builds a compact id/name
+// index in one streaming pass (verifying the data checksum on the way);
+// phone and email stay on disk until a record is actually accessed, and
+// the last LAZY_CACHE_SIZE decoded records are kept in an LRU cache.
+
+#define LAZY_CACHE_SIZE 64
+
+typedef struct
+{
+    int32_t id;
+    char name[MAX_NAME_LEN];
+} LazyIndexEntry;
+
+typedef struct
+{
+    uint32_t slot;       // UINT32_MAX = empty
+    unsigned long used;  // LRU tick of the last access
+    Contact contact;
+} LazyCacheEntry;
+
+typedef struct
+{
+    ContactFileReader reader; // positional reads + id -> slot index
+    LazyIndexEntry *index;    // one per record, in file order
+    uint32_t count;
+    LazyCacheEntry cache[LAZY_CACHE_SIZE];
+    unsigned long tick;
+    unsigned long hits;
+    unsigned long misses;
+} LazyContactFile;
+
+// Fails (nothing stays open) for a compressed, half-patched or corrupted
+// file - those need contact_file_load and its fallbacks.
+bool contact_lazy_open(LazyContactFile *lazy, const char *filename);
+void contact_lazy_close(LazyContactFile *lazy);
+
+// Index-only accessors - never touch the disk
+uint32_t contact_lazy_count(const LazyContactFile *lazy);
+uint32_t contact_lazy_next_id(const LazyContactFile *lazy); // next_contact_id saved with the file
+
+// Full record at 'position' / with 'id', faulted in on a cache miss.
+// The pointer stays valid until LAZY_CACHE_SIZE further accesses.
+const Contact *contact_lazy_get(LazyContactFile *lazy, uint32_t position);
+const Contact *contact_lazy_find_id(LazyContactFile *lazy, int id);
+
+// Name search on the index alone (same matching as contact_name_matches).
+// Fills 'results' with positions; returns the number found.
+int contact_lazy_find_by_name(const LazyContactFile *lazy, const char *name,
+                              uint32_t results[], int max_results);
+
+#endif
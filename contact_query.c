@@ -0,0 +1,748 @@
+#include "contact_query.h"
+#include "contact_db.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+
+// ============================================================================
+// BUILDING
+// ============================================================================
+
+void contact_query_init(ContactQuery *query)
+{
+    memset(query, 0, sizeof(*query));
+    query->order_by = INDEX_BY_ID;
+}
+
+bool contact_query_where(ContactQuery *query, QueryField field, QueryOp op, const char *value)
+{
+    if (query == NULL || value == NULL || query->count >= QUERY_MAX_PREDICATES ||
+        field == QUERY_ID || op == QUERY_LESS || op == QUERY_GREATER ||
+        strlen(value) >= QUERY_MAX_VALUE)
+    {
+        return false;
+    }
+
+    QueryPredicate *predicate = &query->where[query->count++];
+    predicate->field = field;
+    predicate->op = op;
+    predicate->number = 0;
+    if (field == QUERY_PHONE)
+    {
+        extract_digits(predicate->text, value); // compared as digits on both sides
+    }
+    else
+    {
+        strcpy(predicate->text, value);
+    }
+    return true;
+}
+
+bool contact_query_where_id(ContactQuery *query, QueryOp op, int id)
+{
+    if (query == NULL || query->count >= QUERY_MAX_PREDICATES ||
+        (op != QUERY_EQUALS && op != QUERY_LESS && op != QUERY_GREATER))
+    {
+        return false;
+    }
+
+    QueryPredicate *predicate = &query->where[query->count++];
+    predicate->field = QUERY_ID;
+    predicate->op = op;
+    predicate->number = id;
+    predicate->text[0] = '\0';
+    return true;
+}
+
+void contact_query_order_by(ContactQuery *query, IndexField field)
+{
+    query->order_by = field < INDEX_FIELD_COUNT ? field : INDEX_BY_ID;
+}
+
+void contact_query_limit(ContactQuery *query, int limit)
+{
+    query->limit = limit > 0 ? limit : 0;
+}
+
+void contact_query_after(ContactQuery *query, const QueryCursor *cursor)
+{
+    if (cursor != NULL && cursor->valid)
+    {
+        query->after = *cursor;
+    }
+    else
+    {
+        memset(&query->after, 0, sizeof(query->after));
+    }
+}
+
+// ============================================================================
+// MATCHING
+// ============================================================================
+
+static bool equal_ignoring_case(const char *a, const char *b, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i]))
+            return false;
+    }
+    return true;
+}
+
+// What SQLite's LIKE does for the same operator (ASCII case folding)
+static bool text_matches(const char *text, QueryOp op, const char *value)
+{
+    size_t text_length = strlen(text);
+    size_t value_length = strlen(value);
+    if (value_length > text_length)
+    {
+        return false;
+    }
+
+    switch (op)
+    {
+    case QUERY_EQUALS:
+        return text_length == value_length && equal_ignoring_case(text, value, value_length);
+    case QUERY_PREFIX:
+        return equal_ignoring_case(text, value, value_length);
+    case QUERY_SUFFIX:
+        return equal_ignoring_case(text + text_length - value_length, value, value_length);
+    case QUERY_CONTAINS:
+        for (size_t i = 0; i + value_length <= text_length; i++)
+        {
+            if (equal_ignoring_case(text + i, value, value_length))
+                return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+static const char *email_domain(const char *email)
+{
+    const char *at = strchr(email, '@');
+    return at != NULL ? at + 1 : email; // SQL: instr() = 0 keeps the whole email
+}
+
+static bool predicate_matches(const QueryPredicate *predicate, const Contact *contact)
+{
+    switch (predicate->field)
+    {
+    case QUERY_ID:
+        if (predicate->op == QUERY_LESS)
+            return contact->id < predicate->number;
+        if (predicate->op == QUERY_GREATER)
+            return contact->id > predicate->number;
+        return contact->id == predicate->number;
+    case QUERY_NAME:
+        return text_matches(contact->name, predicate->op, predicate->text);
+    case QUERY_EMAIL:
+        return text_matches(contact->email, predicate->op, predicate->text);
+    case QUERY_DOMAIN:
+        return text_matches(email_domain(contact->email), predicate->op, predicate->text);
+    case QUERY_PHONE:
+    {
+        char digits[20];
+        extract_digits(digits, contact->phone);
+        return text_matches(digits, predicate->op, predicate->text);
+    }
+    }
+    return false;
+}
+
+bool contact_query_matches(const ContactQuery *query, const Contact *contact)
+{
+    for (int i = 0; i < query->count; i++)
+    {
+        if (!predicate_matches(&query->where[i], contact))
+            return false;
+    }
+    return true;
+}
+
+static const char *sort_text(const Contact *contact, IndexField field)
+{
+    switch (field)
+    {
+    case INDEX_BY_NAME:
+        return contact->name;
+    case INDEX_BY_PHONE:
+        return contact->phone;
+    default:
+        return contact->email;
+    }
+}
+
+// Sorts after the keyset position? Text keys compare bytewise, as
+// SQLite's BINARY collation and the index orders do
+static bool after_cursor(const ContactQuery *query, const Contact *contact)
+{
+    if (!query->after.valid)
+    {
+        return true;
+    }
+    if (query->order_by != INDEX_BY_ID)
+    {
+        int cmp = strcmp(sort_text(contact, query->order_by), query->after.key);
+        if (cmp != 0)
+            return cmp > 0;
+    }
+    return contact->id > query->after.id;
+}
+
+static void set_next(const ContactQuery *query, const Contact *last, bool more, QueryCursor *next)
+{
+    if (next == NULL)
+    {
+        return;
+    }
+    memset(next, 0, sizeof(*next));
+    if (more && last != NULL)
+    {
+        next->valid = true;
+        next->id = last->id;
+        if (query->order_by != INDEX_BY_ID)
+        {
+            snprintf(next->key, sizeof(next->key), "%s", sort_text(last, query->order_by));
+        }
+    }
+}
+
+// ============================================================================
+// SQL COMPILER
+// ============================================================================
+
+#define QUERY_MAX_PARAMS (QUERY_MAX_PREDICATES * 2 + 3) // domain uses two, plus keyset and limit
+#define QUERY_PARAM_TEXT (QUERY_MAX_VALUE * 2 + 4)      // a LIKE pattern escapes every byte at worst
+
+static const char *const column_names[INDEX_FIELD_COUNT] = {"id", "name", "phone", "email"};
+
+typedef struct
+{
+    bool is_text;
+    int number;
+    const char *text; // 'buffer', or a string owned by the query
+    char buffer[QUERY_PARAM_TEXT];
+} QueryParam;
+
+typedef struct
+{
+    char sql[QUERY_SQL_MAX];
+    size_t length;
+    bool overflow;
+    bool indexed; // some condition goes through an index table
+    int param_count;
+    QueryParam param[QUERY_MAX_PARAMS];
+} CompiledQuery;
+
+static void emit(CompiledQuery *compiled, const char *format, ...)
+{
+    if (compiled->overflow)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(compiled->sql + compiled->length, sizeof(compiled->sql) - compiled->length,
+                            format, args);
+    va_end(args);
+    if (written < 0 || (size_t)written >= sizeof(compiled->sql) - compiled->length)
+    {
+        compiled->overflow = true;
+        return;
+    }
+    compiled->length += (size_t)written;
+}
+
+// Next ?N - the caller fills in its value
+static QueryParam *add_param(CompiledQuery *compiled, int *number)
+{
+    QueryParam *param = &compiled->param[compiled->param_count++];
+    memset(param, 0, sizeof(*param));
+    param->text = param->buffer;
+    *number = compiled->param_count;
+    return param;
+}
+
+static int text_param(CompiledQuery *compiled, const char *text)
+{
+    int number;
+    QueryParam *param = add_param(compiled, &number);
+    param->is_text = true;
+    snprintf(param->buffer, sizeof(param->buffer), "%s", text);
+    return number;
+}
+
+// LIKE pattern for 'op' with '%', '_' and '\' in the value escaped by '\'
+static int like_param(CompiledQuery *compiled, QueryOp op, const char *value)
+{
+    int number;
+    QueryParam *param = add_param(compiled, &number);
+    param->is_text = true;
+
+    char *out = param->buffer;
+    if (op == QUERY_SUFFIX || op == QUERY_CONTAINS)
+        *out++ = '%';
+    for (const char *p = value; *p != '\0'; p++)
+    {
+        if (*p == '%' || *p == '_' || *p == '\\')
+            *out++ = '\\';
+        *out++ = *p;
+    }
+    if (op == QUERY_PREFIX || op == QUERY_CONTAINS)
+        *out++ = '%';
+    *out = '\0';
+    return number;
+}
+
+// The trigram index needs 3+ characters and no wildcards; ASCII only, as
+// it folds case for all of Unicode where LIKE folds only ASCII
+static bool trigram_usable(const char *text)
+{
+    size_t length = 0;
+    for (const unsigned char *p = (const unsigned char *)text; *p != '\0'; p++, length++)
+    {
+        if (*p >= 0x80 || *p == '%' || *p == '_')
+            return false;
+    }
+    return length >= 3;
+}
+
+static void compile_predicate(CompiledQuery *compiled, const QueryPredicate *predicate, bool use_indexes)
+{
+    switch (predicate->field)
+    {
+    case QUERY_ID:
+    {
+        const char *symbol = predicate->op == QUERY_LESS ? "<" : predicate->op == QUERY_GREATER ? ">" : "=";
+        int number;
+        add_param(compiled, &number)->number = predicate->number;
+        emit(compiled, "id %s ?%d", symbol, number);
+        break;
+    }
+    case QUERY_NAME:
+    case QUERY_EMAIL:
+    {
+        const char *column = predicate->field == QUERY_NAME ? "name" : "email";
+        if (use_indexes && predicate->op == QUERY_CONTAINS && trigram_usable(predicate->text))
+        {
+            char pattern[QUERY_PARAM_TEXT];
+            snprintf(pattern, sizeof(pattern), "%%%s%%", predicate->text);
+            emit(compiled, "id IN (SELECT rowid FROM contacts_fts WHERE %s LIKE ?%d)",
+                 column, text_param(compiled, pattern));
+            compiled->indexed = true;
+        }
+        else
+        {
+            emit(compiled, "%s LIKE ?%d ESCAPE '\\'", column, like_param(compiled, predicate->op, predicate->text));
+        }
+        break;
+    }
+    case QUERY_DOMAIN:
+    {
+        // Narrow by the trigrams of "@domain" (or of the fragment), then
+        // check the domain itself
+        char pattern[QUERY_MAX_VALUE + 1];
+        bool anchored = predicate->op == QUERY_EQUALS || predicate->op == QUERY_PREFIX;
+        snprintf(pattern, sizeof(pattern), "%s%s", anchored ? "@" : "", predicate->text);
+        if (use_indexes && trigram_usable(pattern))
+        {
+            char contains[QUERY_PARAM_TEXT];
+            snprintf(contains, sizeof(contains), "%%%s%%", pattern);
+            emit(compiled, "id IN (SELECT rowid FROM contacts_fts WHERE email LIKE ?%d) AND ",
+                 text_param(compiled, contains));
+            compiled->indexed = true;
+        }
+        emit(compiled, "substr(email, instr(email, '@') + 1) LIKE ?%d ESCAPE '\\'",
+             like_param(compiled, predicate->op, predicate->text));
+        break;
+    }
+    case QUERY_PHONE:
+    {
+        // Against phone_rdigits: the digits reversed, so a suffix is a
+        // range of the index and everything else a scan of the index only
+        char reversed[20];
+        size_t n = strlen(predicate->text);
+        for (size_t i = 0; i < n; i++)
+            reversed[i] = predicate->text[n - 1 - i];
+        reversed[n] = '\0';
+
+        if (predicate->op == QUERY_EQUALS)
+        {
+            emit(compiled, "phone_rdigits = ?%d", text_param(compiled, reversed));
+        }
+        else if (predicate->op == QUERY_SUFFIX)
+        {
+            // Every string starting with 'reversed' sorts below reversed || ':'
+            int number = text_param(compiled, reversed);
+            emit(compiled, "(phone_rdigits >= ?%d AND phone_rdigits < ?%d || ':')", number, number);
+        }
+        else
+        {
+            // Digits need no escaping; a prefix of the number ends the reversed digits
+            char pattern[24];
+            snprintf(pattern, sizeof(pattern), "%%%s%s", reversed, predicate->op == QUERY_CONTAINS ? "%" : "");
+            int number = text_param(compiled, pattern);
+            if (use_indexes)
+            {
+                emit(compiled, "id IN (SELECT id FROM contacts INDEXED BY contacts_phone_rdigits "
+                               "WHERE phone_rdigits LIKE ?%d)", number);
+                compiled->indexed = true;
+            }
+            else
+            {
+                emit(compiled, "phone_rdigits LIKE ?%d", number);
+            }
+        }
+        break;
+    }
+    }
+}
+
+// SELECT ... WHERE <conditions> [AND <keyset>] ORDER BY <key>, id LIMIT ?N
+static bool compile(const ContactQuery *query, bool use_indexes, CompiledQuery *compiled)
+{
+    compiled->length = 0;
+    compiled->overflow = false;
+    compiled->indexed = false;
+    compiled->param_count = 0;
+    compiled->sql[0] = '\0';
+
+    emit(compiled, "SELECT id, name, phone, email FROM contacts");
+    for (int i = 0; i < query->count; i++)
+    {
+        emit(compiled, i == 0 ? " WHERE " : " AND ");
+        compile_predicate(compiled, &query->where[i], use_indexes);
+    }
+
+    const char *key = column_names[query->order_by];
+    if (query->after.valid)
+    {
+        emit(compiled, query->count == 0 ? " WHERE " : " AND ");
+        int id_number;
+        add_param(compiled, &id_number)->number = query->after.id;
+        if (query->order_by == INDEX_BY_ID)
+        {
+            emit(compiled, "id > ?%d", id_number);
+        }
+        else
+        {
+            int key_number;
+            QueryParam *param = add_param(compiled, &key_number);
+            param->is_text = true;
+            param->text = query->after.key;
+            emit(compiled, "(%s, id) > (?%d, ?%d)", key, key_number, id_number);
+        }
+    }
+
+    // Limit as a parameter (-1 = none), so pages of any size share a statement
+    int limit_number;
+    add_param(compiled, &limit_number)->number = query->limit > 0 ? query->limit + 1 : -1; // one row of lookahead
+    if (query->order_by == INDEX_BY_ID)
+        emit(compiled, " ORDER BY id LIMIT ?%d", limit_number);
+    else
+        emit(compiled, " ORDER BY %s, id LIMIT ?%d", key, limit_number);
+    return !compiled->overflow;
+}
+
+int contact_query_sql(const ContactQuery *query, bool use_indexes, char *sql, size_t size)
+{
+    CompiledQuery *compiled = malloc(sizeof(CompiledQuery));
+    int length = -1;
+    if (query != NULL && sql != NULL && compiled != NULL &&
+        compile(query, use_indexes, compiled) && compiled->length < size)
+    {
+        memcpy(sql, compiled->sql, compiled->length + 1);
+        length = (int)compiled->length;
+    }
+    free(compiled);
+    return length;
+}
+
+// ============================================================================
+// DATABASE
+// ============================================================================
+
+static void bind_params(sqlite3_stmt *stmt, const CompiledQuery *compiled)
+{
+    for (int i = 0; i < compiled->param_count; i++)
+    {
+        const QueryParam *param = &compiled->param[i];
+        if (param->is_text)
+            sqlite3_bind_text(stmt, i + 1, param->text, -1, SQLITE_STATIC);
+        else
+            sqlite3_bind_int(stmt, i + 1, param->number);
+    }
+}
+
+ContactList *contact_query_run_db(sqlite3 *db, const ContactQuery *query, QueryCursor *next)
+{
+    if (db == NULL || query == NULL)
+    {
+        return NULL;
+    }
+
+    CompiledQuery *compiled = malloc(sizeof(CompiledQuery));
+    ContactList *results = malloc(sizeof(ContactList));
+    DbCursor cursor = {db, NULL, SQLITE_OK};
+    if (compiled == NULL || results == NULL || !contact_list_init(results, 10))
+    {
+        printf("QUERY ERROR: Out of memory\n");
+        goto fail;
+    }
+
+    // === STEP 1: Prepare (cached per shape) ===
+    // Without contacts_fts or the phone index the indexed form does not
+    // prepare; the plain one still answers, by scanning
+    if (!compile(query, true, compiled))
+    {
+        printf("QUERY ERROR: Query too long\n");
+        goto fail;
+    }
+    if (db_cursor_open_sql(db, &cursor, compiled->sql) != SQLITE_OK &&
+        (!compiled->indexed || !compile(query, false, compiled) ||
+         db_cursor_open_sql(db, &cursor, compiled->sql) != SQLITE_OK))
+    {
+        printf("QUERY ERROR: %s\n", sqlite3_errmsg(db));
+        goto fail;
+    }
+    bind_params(cursor.stmt, compiled);
+
+    // === STEP 2: Decode rows straight into the result list ===
+    int rc;
+    while ((rc = db_cursor_step(&cursor)) == 1)
+    {
+        if (!contact_list_ensure_capacity(results, results->size + 1))
+        {
+            printf("QUERY ERROR: Out of memory\n");
+            goto fail;
+        }
+        db_cursor_read(&cursor, &results->data[results->size]);
+        contact_list_commit_slots(results, 1);
+    }
+    if (rc < 0)
+    {
+        goto fail;
+    }
+
+    // The lookahead row only says another page exists
+    bool more = query->limit > 0 && results->size > query->limit;
+    if (more)
+    {
+        results->size = query->limit;
+    }
+    set_next(query, results->size > 0 ? &results->data[results->size - 1] : NULL, more, next);
+    db_cursor_close(&cursor);
+    free(compiled);
+    return results;
+
+fail:
+    db_cursor_close(&cursor);
+    free(compiled);
+    if (results != NULL)
+    {
+        contact_list_free(results);
+        free(results);
+    }
+    return NULL;
+}
+
+// ============================================================================
+// IN MEMORY
+// ============================================================================
+
+typedef struct
+{
+    int id;
+    int position;
+} RunEntry;
+
+static int compare_run_entries(const void *a, const void *b)
+{
+    int id_a = ((const RunEntry *)a)->id;
+    int id_b = ((const RunEntry *)b)->id;
+    return (id_a > id_b) - (id_a < id_b);
+}
+
+// First slot of the id order whose id is above 'id'
+static uint32_t id_lower_bound(const uint32_t *order, uint32_t count, const ContactList *list, int id)
+{
+    uint32_t low = 0, high = count;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        if (list->data[order[mid]].id <= id)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+// First slot of a text order whose key is not below 'key'
+static uint32_t key_lower_bound(const uint32_t *order, uint32_t count, const ContactList *list,
+                                IndexField field, const char *key)
+{
+    uint32_t low = 0, high = count;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        if (strcmp(sort_text(&list->data[order[mid]], field), key) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+// Both walks stop at the first match past a full page: '*more' tells the
+// caller whether a next page exists, so it never offers an empty one
+static int run_by_id(const ContactQuery *query, const uint32_t *order, const ContactList *list,
+                     int results[], int page, bool *more)
+{
+    // Id conditions bound the walk: start above the highest lower bound,
+    // stop at the lowest upper one
+    bool has_low = query->after.valid, has_high = false;
+    int low = query->after.id, high = 0;
+    for (int i = 0; i < query->count; i++)
+    {
+        const QueryPredicate *predicate = &query->where[i];
+        if (predicate->field != QUERY_ID)
+            continue;
+        if (predicate->op == QUERY_GREATER && (!has_low || predicate->number > low))
+        {
+            low = predicate->number;
+            has_low = true;
+        }
+        else if (predicate->op == QUERY_LESS && (!has_high || predicate->number < high))
+        {
+            high = predicate->number;
+            has_high = true;
+        }
+    }
+
+    uint32_t count = (uint32_t)list->size;
+    int found = 0;
+    for (uint32_t i = has_low ? id_lower_bound(order, count, list, low) : 0; i < count && !*more; i++)
+    {
+        const Contact *contact = &list->data[order[i]];
+        if (has_high && contact->id >= high)
+            break;
+        if (!contact_query_matches(query, contact))
+            continue;
+        if (found == page)
+            *more = true;
+        else
+            results[found++] = (int)order[i];
+    }
+    return found;
+}
+
+static int run_by_key(const ContactQuery *query, const uint32_t *order, const ContactList *list,
+                      int results[], int page, bool *more)
+{
+    IndexField field = query->order_by;
+    uint32_t count = (uint32_t)list->size;
+    uint32_t i = query->after.valid ? key_lower_bound(order, count, list, field, query->after.key) : 0;
+
+    // Equal keys sit in list order; each run is re-sorted by id, the tie-break
+    RunEntry *run = NULL;
+    uint32_t run_capacity = 0;
+    int found = 0;
+    while (i < count && !*more)
+    {
+        const char *key = sort_text(&list->data[order[i]], field);
+        uint32_t end = i + 1;
+        while (end < count && strcmp(sort_text(&list->data[order[end]], field), key) == 0)
+            end++;
+
+        if (end - i > run_capacity)
+        {
+            RunEntry *grown = realloc(run, (end - i) * sizeof(RunEntry));
+            if (grown == NULL)
+            {
+                free(run);
+                return -1;
+            }
+            run = grown;
+            run_capacity = end - i;
+        }
+
+        int matched = 0;
+        for (uint32_t k = i; k < end; k++)
+        {
+            const Contact *contact = &list->data[order[k]];
+            if (after_cursor(query, contact) && contact_query_matches(query, contact))
+            {
+                run[matched].id = contact->id;
+                run[matched].position = (int)order[k];
+                matched++;
+            }
+        }
+        if (matched > 1)
+            qsort(run, (size_t)matched, sizeof(RunEntry), compare_run_entries);
+        for (int k = 0; k < matched && !*more; k++)
+        {
+            if (found == page)
+                *more = true;
+            else
+                results[found++] = run[k].position;
+        }
+        i = end;
+    }
+    free(run);
+    return found;
+}
+
+int contact_query_run_list(const ContactQuery *query, ContactIndex *index, const ContactList *list,
+                           int results[], int max_results, QueryCursor *next)
+{
+    if (query == NULL || index == NULL || list == NULL || results == NULL)
+    {
+        return -1;
+    }
+    int page = query->limit > 0 && query->limit < max_results ? query->limit : max_results;
+    int found = 0;
+    bool more = false;
+
+    // An id equality picks at most one contact - look it up
+    const QueryPredicate *by_id = NULL;
+    for (int i = 0; i < query->count && by_id == NULL; i++)
+    {
+        if (query->where[i].field == QUERY_ID && query->where[i].op == QUERY_EQUALS)
+            by_id = &query->where[i];
+    }
+
+    if (by_id != NULL)
+    {
+        int position = contact_index_find_id(index, list, by_id->number);
+        if (position >= 0 && page > 0 && after_cursor(query, &list->data[position]) &&
+            contact_query_matches(query, &list->data[position]))
+        {
+            results[found++] = position;
+        }
+    }
+    else if (page > 0)
+    {
+        const uint32_t *order = contact_index_order(index, list, query->order_by);
+        if (order == NULL)
+        {
+            printf("QUERY ERROR: Out of memory sorting %d contacts\n", list->size);
+            return -1;
+        }
+        found = query->order_by == INDEX_BY_ID ? run_by_id(query, order, list, results, page, &more)
+                                                : run_by_key(query, order, list, results, page, &more);
+        if (found < 0)
+        {
+            printf("QUERY ERROR: Out of memory\n");
+            return -1;
+        }
+    }
+
+    set_next(query, found > 0 ? &list->data[results[found - 1]] : NULL, more, next);
+    return found;
+}
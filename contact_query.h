@@ -0,0 +1,110 @@
+#ifndef CONTACT_QUERY_H
+#define CONTACT_QUERY_H
+
+#include <stdbool.h>
+#include "contact_dynamic.h"
+#include "contact_index.h"
+#include "sqlite3.h"
+
+// Multi-field contact queries: up to QUERY_MAX_PREDICATES conditions that
+// must all hold, one sort field (ties broken by id), an optional limit and
+// a keyset position to continue after. The same query runs against SQLite
+// - compiled to a single statement, prepared once per shape - or against a
+// ContactList through its ContactIndex orders, with the same results.
+//
+// Text conditions ignore ASCII case, like the searches. Phone conditions
+// compare digits only, so "555-1234" equals "(555) 1234".
+//
+//     ContactQuery query;
+//     contact_query_init(&query);
+//     contact_query_where(&query, QUERY_NAME, QUERY_CONTAINS, "smith");
+//     contact_query_where(&query, QUERY_DOMAIN, QUERY_EQUALS, "example.com");
+//     contact_query_order_by(&query, INDEX_BY_NAME);
+//     contact_query_limit(&query, 50);
+
+#define QUERY_MAX_PREDICATES 8
+#define QUERY_MAX_VALUE 128 // bytes of a condition's value, with terminator
+#define QUERY_SQL_MAX 4096
+
+typedef enum
+{
+    QUERY_ID,
+    QUERY_NAME,
+    QUERY_PHONE,
+    QUERY_EMAIL,
+    QUERY_DOMAIN // the part of email after its first '@'
+} QueryField;
+
+typedef enum
+{
+    QUERY_EQUALS,
+    QUERY_PREFIX,   // text fields only
+    QUERY_SUFFIX,   // text fields only
+    QUERY_CONTAINS, // text fields only
+    QUERY_LESS,     // id only
+    QUERY_GREATER   // id only
+} QueryOp;
+
+typedef struct
+{
+    QueryField field;
+    QueryOp op;
+    int number;                 // QUERY_ID
+    char text[QUERY_MAX_VALUE]; // other fields; digits only for QUERY_PHONE
+} QueryPredicate;
+
+// Where a page ended: the sort key and id of its last contact.
+typedef struct QueryCursor
+{
+    bool valid; // false = from the start / no more pages
+    int id;
+    char key[MAX_EMAIL_LEN]; // unused when sorting by id
+} QueryCursor;
+
+typedef struct ContactQuery
+{
+    QueryPredicate where[QUERY_MAX_PREDICATES];
+    int count;
+    IndexField order_by; // INDEX_BY_ID by default
+    int limit;           // 0 = every match
+    QueryCursor after;   // start after this contact
+} ContactQuery;
+
+// Empty query: every contact, by id.
+void contact_query_init(ContactQuery *query);
+
+// Adds "field op value". Returns false if the query is full, the value
+// does not fit or the operator does not apply to the field.
+bool contact_query_where(ContactQuery *query, QueryField field, QueryOp op, const char *value);
+bool contact_query_where_id(ContactQuery *query, QueryOp op, int id);
+
+void contact_query_order_by(ContactQuery *query, IndexField field);
+void contact_query_limit(ContactQuery *query, int limit);
+
+// Continue after the page that returned 'cursor' (NULL = from the start).
+void contact_query_after(ContactQuery *query, const QueryCursor *cursor);
+
+// Whether 'contact' meets every condition (not the keyset position).
+bool contact_query_matches(const ContactQuery *query, const Contact *contact);
+
+// The SQL the query compiles to, values as ?N parameters. 'use_indexes'
+// routes conditions through contacts_fts and contacts_phone_rdigits.
+// Returns the length, or -1 if it does not fit in 'size'.
+int contact_query_sql(const ContactQuery *query, bool use_indexes, char *sql, size_t size);
+
+// Runs the query on the database. Returns a newly allocated ContactList
+// (caller frees), or NULL on error. If 'next' is given it receives the
+// position after this page, valid only if more matches follow it (one
+// extra row is read to find out).
+ContactList *contact_query_run_db(sqlite3 *db, const ContactQuery *query, QueryCursor *next);
+
+// Runs the query on 'list'. Walks the id order for id lookups and ranges
+// and the sort field's order otherwise, so a limited page stops once it
+// is full instead of sorting every match. Fills 'results' with list
+// positions in sort order; returns how many (at most 'max_results'), or
+// -1 if out of memory. 'next' as for contact_query_run_db, also when the
+// page was cut short by 'max_results'.
+int contact_query_run_list(const ContactQuery *query, ContactIndex *index, const ContactList *list,
+                           int results[], int max_results, QueryCursor *next);
+
+#endif
@@ -0,0 +1,286 @@
+#include "contact_reader.h"
+#include "file_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h> // offsetof
+
+#define REBUILD_CHUNK 256 // records per pread while rebuilding the index
+
+static int compare_slot_id(const void *a, const void *b)
+{
+    const ContactSlot *slot_a = (const ContactSlot *)a;
+    const ContactSlot *slot_b = (const ContactSlot *)b;
+    return (slot_a->id > slot_b->id) - (slot_a->id < slot_b->id);
+}
+
+static long long slot_offset(const ContactFileReader *reader, uint32_t slot)
+{
+    return (long long)reader->header.header_size + (long long)slot * CONTACT_PACKED_SIZE;
+}
+
+// ============================================================================
+// SLOTS SIDECAR
+// ============================================================================
+
+static bool write_slots_file(const char *filename, const ContactSlot *slots, uint32_t count,
+                             const ContactFileHeader *data_header)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s%s", filename, SLOTS_SUFFIX);
+
+    ContactSlotsHeader header = {0};
+    header.magic = SLOTS_MAGIC;
+    header.version = SLOTS_VERSION;
+    header.count = count;
+    header.data_checksum = data_header->data_checksum;
+    header.data_timestamp = data_header->timestamp;
+    header.entries_checksum = fletcher32(slots, count * sizeof(ContactSlot));
+    header.header_checksum = fletcher32(
+        &header.entries_checksum,
+        sizeof(ContactSlotsHeader) - offsetof(ContactSlotsHeader, entries_checksum));
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (count == 0 || fwrite(slots, sizeof(ContactSlot), count, file) == count);
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok)
+    {
+        remove(path); // a stale index is rebuilt, a broken one must not linger
+    }
+    return ok;
+}
+
+// Loads "<filename>.slots" if it belongs to exactly this snapshot
+static bool load_slots_file(ContactFileReader *reader, const char *filename)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s%s", filename, SLOTS_SUFFIX);
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    ContactSlotsHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              header.magic == SLOTS_MAGIC &&
+              header.version == SLOTS_VERSION &&
+              header.count == reader->header.contact_count &&
+              header.data_checksum == reader->header.data_checksum &&
+              header.data_timestamp == reader->header.timestamp &&
+              header.header_checksum == fletcher32(&header.entries_checksum,
+                                                   sizeof(ContactSlotsHeader) -
+                                                       offsetof(ContactSlotsHeader, entries_checksum));
+
+    if (ok)
+    {
+        reader->slots = malloc((header.count > 0 ? header.count : 1) * sizeof(ContactSlot));
+        ok = reader->slots != NULL &&
+             fread(reader->slots, sizeof(ContactSlot), header.count, file) == header.count &&
+             fletcher32(reader->slots, header.count * sizeof(ContactSlot)) == header.entries_checksum;
+    }
+    fclose(file);
+
+    if (!ok)
+    {
+        free(reader->slots);
+        reader->slots = NULL;
+        return false;
+    }
+
+    reader->count = header.count;
+    return true;
+}
+
+// One streaming pass over the ids only, then persist for next time
+static bool rebuild_slots(ContactFileReader *reader, const char *filename)
+{
+    uint32_t count = reader->header.contact_count;
+    uint8_t *chunk = malloc((size_t)REBUILD_CHUNK * CONTACT_PACKED_SIZE);
+    reader->slots = malloc((count > 0 ? count : 1) * sizeof(ContactSlot));
+    if (chunk == NULL || reader->slots == NULL)
+    {
+        free(chunk);
+        free(reader->slots);
+        reader->slots = NULL;
+        return false;
+    }
+
+    const size_t id_offset = MAX_NAME_LEN + MAX_PHONE_LEN + MAX_EMAIL_LEN;
+    for (uint32_t first = 0; first < count; first += REBUILD_CHUNK)
+    {
+        uint32_t n = (count - first < REBUILD_CHUNK) ? count - first : REBUILD_CHUNK;
+        if (!file_pread(reader->file, chunk, (size_t)n * CONTACT_PACKED_SIZE, slot_offset(reader, first)))
+        {
+            printf("READER ERROR: Snapshot is shorter than its header claims\n");
+            free(chunk);
+            free(reader->slots);
+            reader->slots = NULL;
+            return false;
+        }
+
+        for (uint32_t k = 0; k < n; k++)
+        {
+            memcpy(&reader->slots[first + k].id, chunk + (size_t)k * CONTACT_PACKED_SIZE + id_offset, sizeof(int32_t));
+            reader->slots[first + k].slot = first + k;
+        }
+    }
+    free(chunk);
+
+    qsort(reader->slots, count, sizeof(ContactSlot), compare_slot_id);
+    reader->count = count;
+
+    write_slots_file(filename, reader->slots, count, &reader->header); // best effort
+    return true;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+bool contact_reader_open(ContactFileReader *reader, const char *filename)
+{
+    if (reader == NULL || filename == NULL)
+    {
+        return false;
+    }
+    memset(reader, 0, sizeof(*reader));
+
+    reader->file = fopen(filename, "rb");
+    if (reader->file == NULL)
+    {
+        printf("READER ERROR: Cannot open '%s'\n", filename);
+        return false;
+    }
+
+    // === STEP 1: Header only - records stay on disk ===
+    ContactFileHeader *header = &reader->header;
+    bool have_header = file_pread(reader->file, header, sizeof(*header), 0);
+    if (have_header && header->magic == FILE_MAGIC_LRBT &&
+        header->version == FILE_FORMAT_VERSION_COMPRESSED)
+    {
+        printf("READER ERROR: '%s' is compressed - records have no fixed slots\n", filename);
+        contact_reader_close(reader);
+        return false;
+    }
+    if (!have_header ||
+        header->magic != FILE_MAGIC_LRBT ||
+        header->version > FILE_FORMAT_VERSION ||
+        header->header_size != sizeof(ContactFileHeader) ||
+        header->contact_size != CONTACT_PACKED_SIZE)
+    {
+        printf("READER ERROR: '%s' is not a LRBT snapshot\n", filename);
+        contact_reader_close(reader);
+        return false;
+    }
+
+    uint32_t header_checksum = fletcher32(
+        &header->data_checksum,
+        sizeof(ContactFileHeader) - offsetof(ContactFileHeader, data_checksum));
+    if (header_checksum != header->header_checksum)
+    {
+        printf("READER ERROR: HEADER CHECKSUM FAILED for '%s'\n", filename);
+        contact_reader_close(reader);
+        return false;
+    }
+
+    // === STEP 2: id -> slot index ===
+    if (!load_slots_file(reader, filename) && !rebuild_slots(reader, filename))
+    {
+        contact_reader_close(reader);
+        return false;
+    }
+
+    return true;
+}
+
+void contact_reader_close(ContactFileReader *reader)
+{
+    if (reader == NULL)
+    {
+        return;
+    }
+
+    if (reader->file != NULL)
+    {
+        fclose(reader->file);
+    }
+    free(reader->slots);
+    memset(reader, 0, sizeof(*reader));
+}
+
+bool contact_reader_read_slot(const ContactFileReader *reader, uint32_t slot, Contact *contact)
+{
+    if (reader == NULL || reader->file == NULL || contact == NULL ||
+        slot >= reader->header.contact_count)
+    {
+        return false;
+    }
+
+    uint8_t packed[CONTACT_PACKED_SIZE];
+    if (!file_pread(reader->file, packed, CONTACT_PACKED_SIZE, slot_offset(reader, slot)))
+    {
+        return false;
+    }
+
+    contact_unpack(contact, packed);
+    return true;
+}
+
+long contact_reader_slot_of(const ContactFileReader *reader, int id)
+{
+    if (reader == NULL || reader->slots == NULL)
+    {
+        return -1;
+    }
+
+    ContactSlot key;
+    key.id = id;
+    const ContactSlot *found = bsearch(&key, reader->slots, reader->count,
+                                       sizeof(ContactSlot), compare_slot_id);
+    return found != NULL ? (long)found->slot : -1;
+}
+
+bool contact_reader_restamp_slots(const ContactFileReader *reader, const char *filename,
+                                  const ContactFileHeader *header)
+{
+    if (reader == NULL || reader->slots == NULL || filename == NULL || header == NULL)
+    {
+        return false;
+    }
+    return write_slots_file(filename, reader->slots, reader->count, header);
+}
+
+bool contact_reader_write_slots(const char *filename, const ContactList *list,
+                                const ContactFileHeader *header)
+{
+    if (filename == NULL || list == NULL || header == NULL)
+    {
+        return false;
+    }
+
+    ContactSlot *slots = malloc((list->size > 0 ? list->size : 1) * sizeof(ContactSlot));
+    if (slots == NULL)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < list->size; i++)
+    {
+        slots[i].id = list->data[i].id;
+        slots[i].slot = (uint32_t)i;
+    }
+    qsort(slots, list->size, sizeof(ContactSlot), compare_slot_id);
+
+    bool ok = write_slots_file(filename, slots, (uint32_t)list->size, header);
+    free(slots);
+    return ok;
+}
@@ -0,0 +1,67 @@
+#ifndef CONTACT_READER_H
+#define CONTACT_READER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include "contact_dynamic.h"
+#include "contact_file.h"
+
+// Read-only random access into a contacts.dat style snapshot. Records are
+// fixed CONTACT_PACKED_SIZE slots after the header, so record i lives at
+// header_size + i * CONTACT_PACKED_SIZE and can be fetched with one pread.
+// Lookups by id go through a persisted "<file>.slots" index.
+
+#define SLOTS_SUFFIX ".slots"
+#define SLOTS_MAGIC 0x4C524253 // "LRBS"
+#define SLOTS_VERSION 1
+
+typedef struct
+{
+    int32_t id;
+    uint32_t slot;
+} ContactSlot;
+
+typedef struct
+{
+    uint32_t magic;   // "LRBS"
+    uint32_t version; // 1
+    uint32_t header_checksum;
+    uint32_t entries_checksum;
+    uint32_t count;
+    uint32_t data_checksum; // data_checksum of the snapshot it indexes
+    time_t data_timestamp;  // timestamp of the snapshot it indexes
+    uint32_t reserved[2];
+} ContactSlotsHeader;
+
+typedef struct
+{
+    FILE *file;
+    ContactFileHeader header;
+    ContactSlot *slots; // sorted by id
+    uint32_t count;
+} ContactFileReader;
+
+// Opens a snapshot without reading its records. Verifies the header and
+// loads (or rebuilds and persists) the id -> slot index.
+bool contact_reader_open(ContactFileReader *reader, const char *filename);
+void contact_reader_close(ContactFileReader *reader);
+
+// Fetches record 'slot' (0-based position in the file).
+bool contact_reader_read_slot(const ContactFileReader *reader, uint32_t slot, Contact *contact);
+
+// Returns the slot holding 'id', or -1. Used by in-place updates and by
+// ID search on a lazily opened contacts.dat (contact_lazy_find_id).
+long contact_reader_slot_of(const ContactFileReader *reader, int id);
+
+// Re-binds the reader's index to a new header after an in-place update
+// (ids keep their slots, only the checksum/timestamp change).
+bool contact_reader_restamp_slots(const ContactFileReader *reader, const char *filename,
+                                  const ContactFileHeader *header);
+
+// Writes "<filename>.slots" for a snapshot that was just saved from 'list'.
+bool contact_reader_write_slots(const char *filename, const ContactList *list,
+                                const ContactFileHeader *header);
+
+#endif
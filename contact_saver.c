@@ -0,0 +1,305 @@
+#include "contact_saver.h"
+#include "contact_file.h"
+#include "contact_journal.h"
+#include "contact_storage.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NO_BUFFER -1
+
+// Private copy of everything one save needs
+typedef struct
+{
+    ContactList contacts;
+    uint32_t next_contact_id;
+    uint32_t journal_seq;
+    int edited_ids[JOURNAL_PATCH_LIMIT];
+    int edited_count; // -1 = full save
+    bool use_database;
+    int db_saved;     // written by the database thread
+} SaveSnapshot;
+
+// Module state - guarded by saver_lock unless noted
+static pthread_mutex_t saver_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+static pthread_t saver_thread;
+static bool saver_running = false; // main thread only
+static bool saver_stopping = false;
+
+static SaveSnapshot buffers[2]; // double buffer: one being written, one being filled
+static int pending_buffer = NO_BUFFER;
+static int active_buffer = NO_BUFFER;
+
+static SaveStatus statuses[SAVER_STATUS_QUEUE];
+static int status_head = 0;
+static int status_count = 0;
+
+static time_t last_request_time = 0;  // main thread only
+static uint32_t last_request_seq = 0; // main thread only
+static bool db_resync = false;        // main thread only: a database save failed
+
+// ============================================================================
+// WORKER
+// ============================================================================
+
+static void *database_main(void *arg)
+{
+    SaveSnapshot *snapshot = (SaveSnapshot *)arg;
+    // Tracked snapshot: just its change set. Untracked: everything.
+    snapshot->db_saved = storage_sync(&snapshot->contacts, NULL, NULL);
+    return NULL;
+}
+
+// Legacy file on this thread, database on a second one, then join
+static SaveStatus run_save(SaveSnapshot *snapshot)
+{
+    SaveStatus status = {0};
+    time_t started = time(NULL);
+    status.journal_seq = snapshot->journal_seq;
+    status.contact_count = snapshot->contacts.size;
+    status.used_database = snapshot->use_database;
+
+    pthread_t database_thread;
+    bool database_started = false;
+    if (snapshot->use_database)
+    {
+        database_started = pthread_create(&database_thread, NULL, database_main, snapshot) == 0;
+    }
+
+    // Edits only: patch their slots. Anything else: full snapshot + delta.
+    // Quietly - the menu is waiting for input; the result goes out as status.
+    bool patched = snapshot->edited_count > 0 &&
+                   contact_file_update_records(BACKUP_PRIMARY_FILE, &snapshot->contacts,
+                                               snapshot->edited_ids, snapshot->edited_count, false);
+    status.legacy_ok = patched ||
+                       contact_file_save_backup_snapshot(&snapshot->contacts, snapshot->next_contact_id, false);
+
+    if (snapshot->use_database)
+    {
+        if (database_started)
+        {
+            pthread_join(database_thread, NULL);
+        }
+        else
+        {
+            database_main(snapshot); // no second thread - run it here
+        }
+        status.db_ok = snapshot->db_saved >= 0;
+    }
+
+    status.seconds = difftime(time(NULL), started);
+    return status;
+}
+
+static void push_status(const SaveStatus *status)
+{
+    if (status_count == SAVER_STATUS_QUEUE)
+    {
+        // Nobody polled for a while - the oldest result matters least
+        status_head = (status_head + 1) % SAVER_STATUS_QUEUE;
+        status_count--;
+    }
+    statuses[(status_head + status_count) % SAVER_STATUS_QUEUE] = *status;
+    status_count++;
+}
+
+static void *saver_main(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&saver_lock);
+    for (;;)
+    {
+        while (pending_buffer == NO_BUFFER && !saver_stopping)
+        {
+            pthread_cond_wait(&work_ready, &saver_lock);
+        }
+        if (pending_buffer == NO_BUFFER)
+        {
+            break; // stopping, and nothing left to write
+        }
+
+        active_buffer = pending_buffer;
+        pending_buffer = NO_BUFFER;
+        pthread_mutex_unlock(&saver_lock);
+
+        SaveStatus status = run_save(&buffers[active_buffer]);
+
+        pthread_mutex_lock(&saver_lock);
+        push_status(&status);
+        active_buffer = NO_BUFFER;
+        pthread_cond_broadcast(&work_done);
+    }
+    pthread_mutex_unlock(&saver_lock);
+    return NULL;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+bool contact_saver_start(void)
+{
+    if (saver_running)
+    {
+        return true;
+    }
+
+    saver_stopping = false;
+    if (pthread_create(&saver_thread, NULL, saver_main, NULL) != 0)
+    {
+        printf("SAVER ERROR: Cannot start background thread, saving in the foreground\n");
+        return false;
+    }
+
+    saver_running = true;
+    last_request_time = time(NULL);
+    last_request_seq = contact_journal_last_seq();
+    return true;
+}
+
+void contact_saver_stop(void)
+{
+    if (!saver_running)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&saver_lock);
+    saver_stopping = true;
+    pthread_cond_signal(&work_ready);
+    pthread_mutex_unlock(&saver_lock);
+
+    pthread_join(saver_thread, NULL);
+    saver_running = false;
+
+    for (int i = 0; i < 2; i++)
+    {
+        contact_list_free(&buffers[i].contacts);
+        buffers[i].contacts.size = 0;
+    }
+}
+
+bool contact_saver_request(ContactList *list, bool use_database)
+{
+    if (!saver_running || list == NULL)
+    {
+        return false;
+    }
+
+    pthread_mutex_lock(&saver_lock);
+
+    // Fill whichever buffer the worker is not writing from
+    int target = (active_buffer == 0) ? 1 : 0;
+    SaveSnapshot *snapshot = &buffers[target];
+    if (!contact_list_copy(&snapshot->contacts, list))
+    {
+        pthread_mutex_unlock(&saver_lock);
+        printf("SAVER ERROR: Out of memory for a %d contact snapshot\n", list->size);
+        return false;
+    }
+    if (!use_database || db_resync || pending_buffer != NO_BUFFER)
+    {
+        // A failed database save, or a queued one about to be replaced
+        // (its change set would be lost): write everything this time
+        contact_list_stop_tracking(&snapshot->contacts);
+    }
+    snapshot->next_contact_id = (uint32_t)next_contact_id;
+    snapshot->journal_seq = contact_journal_last_seq();
+    // A list loaded from the database never matches contacts.dat slot for slot
+    snapshot->edited_count = use_database ? -1
+                                          : contact_journal_edited_ids(snapshot->edited_ids, JOURNAL_PATCH_LIMIT);
+    snapshot->use_database = use_database;
+    snapshot->db_saved = 0;
+
+    pending_buffer = target; // replaces a request that has not started yet
+    pthread_cond_signal(&work_ready);
+    pthread_mutex_unlock(&saver_lock);
+
+    // The snapshot carries the changes now; the list starts a new set
+    if (use_database)
+    {
+        db_resync = false;
+        if (list->state != NULL)
+        {
+            contact_list_clear_changes(list);
+        }
+        else
+        {
+            contact_list_track_changes(list);
+        }
+    }
+
+    last_request_time = time(NULL);
+    last_request_seq = snapshot->journal_seq;
+    return true;
+}
+
+bool contact_saver_autosave(ContactList *list, bool use_database)
+{
+    if (!saver_running ||
+        difftime(time(NULL), last_request_time) < SAVER_AUTOSAVE_SECONDS ||
+        contact_journal_last_seq() == last_request_seq)
+    {
+        return false;
+    }
+    return contact_saver_request(list, use_database);
+}
+
+bool contact_saver_poll(SaveStatus *status)
+{
+    if (status == NULL)
+    {
+        return false;
+    }
+
+    pthread_mutex_lock(&saver_lock);
+    bool have = status_count > 0;
+    if (have)
+    {
+        *status = statuses[status_head];
+        status_head = (status_head + 1) % SAVER_STATUS_QUEUE;
+        status_count--;
+    }
+    pthread_mutex_unlock(&saver_lock);
+
+    // The journal belongs to the main thread, so it is trimmed here - once
+    // every store it feeds holds its entries
+    if (have && status->legacy_ok && (!status->used_database || status->db_ok))
+    {
+        contact_journal_checkpoint(status->journal_seq);
+    }
+    // Its change set is gone with the failed save - next one writes all
+    if (have && status->used_database && !status->db_ok)
+    {
+        db_resync = true;
+    }
+    return have;
+}
+
+void contact_saver_wait(void)
+{
+    if (!saver_running)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&saver_lock);
+    while (pending_buffer != NO_BUFFER || active_buffer != NO_BUFFER)
+    {
+        pthread_cond_wait(&work_done, &saver_lock);
+    }
+    pthread_mutex_unlock(&saver_lock);
+}
+
+bool contact_saver_busy(void)
+{
+    pthread_mutex_lock(&saver_lock);
+    bool busy = pending_buffer != NO_BUFFER || active_buffer != NO_BUFFER;
+    pthread_mutex_unlock(&saver_lock);
+    return busy;
+}
@@ -0,0 +1,56 @@
+#ifndef CONTACT_SAVER_H
+#define CONTACT_SAVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "contact_dynamic.h"
+
+// Background persistence. contact_saver_request() copies the list into one
+// of two snapshot buffers and returns; a worker thread then writes the
+// legacy file and (optionally) the database at the same time. Results come
+// back through a small status queue that the menu loop polls.
+//
+// Only the main thread calls these functions. The worker never touches
+// contact_list, next_contact_id or the journal.
+
+#define SAVER_STATUS_QUEUE 8
+#define SAVER_AUTOSAVE_SECONDS 120 // interval for contact_saver_autosave
+
+typedef struct
+{
+    uint32_t journal_seq; // journal entries up to here are in this save
+    int contact_count;
+    bool legacy_ok;
+    bool used_database;
+    bool db_ok;
+    double seconds; // wall time of the save
+} SaveStatus;
+
+// Starts the worker thread. Returns false if threads are unavailable;
+// callers then save synchronously.
+bool contact_saver_start(void);
+
+// Finishes a queued or running save, then stops the worker.
+void contact_saver_stop(void);
+
+// Queues a save of 'list'. A request that has not started yet is replaced
+// by the newer one. With the database, the save takes over the list's
+// change set (only those rows are written) and the list starts a new one;
+// after a failed database save the next one writes every row.
+// Returns false if the worker is not running.
+bool contact_saver_request(ContactList *list, bool use_database);
+
+// Queues a save if SAVER_AUTOSAVE_SECONDS have passed since the last one
+// and the journal shows changes since then. Returns true if it queued one.
+bool contact_saver_autosave(ContactList *list, bool use_database);
+
+// Pops the oldest finished save. A successful legacy save checkpoints the
+// journal here, on the calling (main) thread.
+bool contact_saver_poll(SaveStatus *status);
+
+// Blocks until no save is queued or running.
+void contact_saver_wait(void);
+
+bool contact_saver_busy(void);
+
+#endif
@@ -1,27 +1,437 @@
+#define _POSIX_C_SOURCE 200809L // pthread_rwlock_t under -std=c99
+
 #include "contact_storage.h"
 #include "contact_db.h"
+#include "contact_query.h"
 #include "contact_dynamic.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
+#include <pthread.h>
 
 /* ------------------------------------------------------------------ */
 /*  Internal database handle                                           */
 /* ------------------------------------------------------------------ */
 static sqlite3 *db = NULL; // single, module‑private database connection
 static bool use_database = true;
+static DbChangeMark change_mark; // what the loaded list reflects
+static bool have_mark = false;
+static pthread_mutex_t mark_lock = PTHREAD_MUTEX_INITIALIZER; // the mark; the async writer moves it too
+
+/* ------------------------------------------------------------------ */
+/*  Read pool                                                          */
+/* ------------------------------------------------------------------ */
+// Searches run on read-only connections of their own, so they neither
+// queue behind each other on one handle nor wait for a save in progress
+// (WAL readers see the last commit). Opened on first use, up to
+// STORAGE_READERS; the statement cache covers 8 connections in all.
+#define STORAGE_READERS 4
+
+static sqlite3 *readers[STORAGE_READERS];
+static bool reader_busy[STORAGE_READERS];
+static int reader_count = 0;
+static int reader_limit = STORAGE_READERS; // lowered if one fails to open
+static DbTuning storage_tuning; // storage_init's profile, for the readers and the writer
+static pthread_mutex_t reader_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reader_free = PTHREAD_COND_INITIALIZER;
+
+// A connection no other thread is using: an idle reader, a new one while
+// the pool has room, otherwise the next one handed back. Falls back to
+// the writer when no reader can be opened at all.
+static sqlite3 *acquire_reader(void)
+{
+    pthread_mutex_lock(&reader_lock);
+    for (;;)
+    {
+        for (int i = 0; i < reader_count; i++)
+        {
+            if (!reader_busy[i])
+            {
+                reader_busy[i] = true;
+                pthread_mutex_unlock(&reader_lock);
+                return readers[i];
+            }
+        }
+        if (reader_count < reader_limit)
+        {
+            if (db_open_reader(&readers[reader_count], &storage_tuning) == SQLITE_OK)
+            {
+                reader_busy[reader_count] = true;
+                sqlite3 *reader = readers[reader_count++];
+                pthread_mutex_unlock(&reader_lock);
+                return reader;
+            }
+            fprintf(stderr, "Storage Error : Read connection unavailable, %d in the pool\n", reader_count);
+            reader_limit = reader_count;
+        }
+        if (reader_count == 0)
+        {
+            pthread_mutex_unlock(&reader_lock);
+            return db;
+        }
+        pthread_cond_wait(&reader_free, &reader_lock);
+    }
+}
+
+static void release_reader(sqlite3 *reader)
+{
+    pthread_mutex_lock(&reader_lock);
+    for (int i = 0; i < reader_count; i++)
+    {
+        if (readers[i] == reader)
+        {
+            reader_busy[i] = false;
+            pthread_cond_signal(&reader_free);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&reader_lock);
+}
+
+// Call with no search running
+static void close_readers(void)
+{
+    pthread_mutex_lock(&reader_lock);
+    for (int i = 0; i < reader_count; i++)
+    {
+        db_close(readers[i]);
+        readers[i] = NULL;
+        reader_busy[i] = false;
+    }
+    reader_count = 0;
+    reader_limit = STORAGE_READERS;
+    pthread_mutex_unlock(&reader_lock);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Async writer                                                       */
+/* ------------------------------------------------------------------ */
+// storage_*_async hand single-contact writes to one background thread
+// with a connection of its own. Producers push onto a lock-free stack;
+// the thread takes everything pushed so far in one exchange and commits
+// it as one transaction (up to STORAGE_GROUP_MAX writes), so a burst of
+// writes pays for one journal sync instead of one each. Its rows count as
+// the caller's own: the change mark moves past them as for storage_sync.
+#define STORAGE_GROUP_MAX 1000
+
+typedef enum
+{
+    STORAGE_OP_SAVE,
+    STORAGE_OP_UPDATE,
+    STORAGE_OP_DELETE
+} StorageOpKind;
+
+typedef struct StorageOp
+{
+    struct StorageOp *next;
+    StorageOpKind kind;
+    Contact contact; // only the id for STORAGE_OP_DELETE
+    int result;
+    StorageFuture *future;
+    StorageDoneFn done;
+    void *ctx;
+} StorageOp;
+
+static StorageOp *op_stack = NULL; // newest first; pushed without a lock
+static sqlite3 *writer_db = NULL;
+static pthread_t writer_thread;
+static bool writer_running = false; // atomic; set by the first async write, cleared by shutdown
+static bool writer_tried = false;   // atomic; start_writer ran (it may have failed)
+static pthread_mutex_t writer_start_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool writer_stopping = false; // guarded by writer_lock
+// Held shared by every submission and exclusively by shutdown, which
+// closes the queue: nothing is pushed after the writer has drained it
+static pthread_rwlock_t submit_gate = PTHREAD_RWLOCK_INITIALIZER;
+static bool accepting_writes = false; // guarded by submit_gate
+static unsigned long ops_submitted = 0; // atomic
+static unsigned long ops_completed = 0; // guarded by writer_lock
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t writer_done = PTHREAD_COND_INITIALIZER;
+
+static bool contact_fields_valid(const Contact *contact)
+{
+    return contact_validate_name(contact->name) && contact_validate_email(contact->email) &&
+           contact_validate_phone(contact->phone);
+}
+
+static int run_op(sqlite3 *conn, const StorageOp *op)
+{
+    int rc;
+    switch (op->kind)
+    {
+    case STORAGE_OP_SAVE:
+        rc = db_upsert_contact(conn, &op->contact);
+        break;
+    case STORAGE_OP_UPDATE:
+        rc = db_update_contact(conn, &op->contact);
+        break;
+    default:
+        rc = db_delete_contact(conn, op->contact.id);
+        break;
+    }
+    return rc == SQLITE_OK ? 0 : -1;
+}
+
+// Reports 'count' ops from 'first' on and frees them. The future is the
+// caller's again once 'done' is set, so it is not touched after that.
+static void complete_ops(StorageOp *first, int count)
+{
+    StorageOp *op = first;
+    for (int i = 0; i < count; i++)
+    {
+        StorageOp *next = op->next;
+        if (op->future != NULL)
+        {
+            op->future->result = op->result;
+            __atomic_store_n(&op->future->done, 1, __ATOMIC_RELEASE);
+        }
+        if (op->done != NULL)
+            op->done(op->result, op->ctx);
+        free(op);
+        op = next;
+    }
+
+    pthread_mutex_lock(&writer_lock);
+    ops_completed += (unsigned long)count;
+    pthread_cond_broadcast(&writer_done);
+    pthread_mutex_unlock(&writer_lock);
+}
+
+// Only if the mark was at the log's end when the group began: an entry
+// logged before that is someone else's and a refresh must still read it
+static void mark_past_own_writes(sqlite3_int64 seq_before, sqlite3_int64 seq_after)
+{
+    pthread_mutex_lock(&mark_lock);
+    if (have_mark && change_mark.seq == seq_before)
+        change_mark.seq = seq_after;
+    pthread_mutex_unlock(&mark_lock);
+}
+
+// One transaction for 'count' ops, each under a savepoint so a failing
+// write loses only itself. If the transaction cannot be opened or
+// committed, every op is retried on its own.
+static void commit_group(StorageOp *first, int count)
+{
+    bool grouped = sqlite3_exec(writer_db, "BEGIN IMMEDIATE;", NULL, NULL, NULL) == SQLITE_OK;
+    sqlite3_int64 seq_before = 0, seq_after = 0;
+    bool track_mark = grouped && db_change_log_end(writer_db, &seq_before) == SQLITE_OK;
+    StorageOp *op = first;
+    for (int i = 0; grouped && i < count; i++, op = op->next)
+    {
+        sqlite3_exec(writer_db, "SAVEPOINT op;", NULL, NULL, NULL);
+        op->result = run_op(writer_db, op);
+        if (op->result != 0)
+            sqlite3_exec(writer_db, "ROLLBACK TO op;", NULL, NULL, NULL);
+        sqlite3_exec(writer_db, "RELEASE op;", NULL, NULL, NULL);
+    }
+    track_mark = track_mark && db_change_log_end(writer_db, &seq_after) == SQLITE_OK;
+    if (grouped && sqlite3_exec(writer_db, "COMMIT;", NULL, NULL, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Storage Error : Group commit failed (%s), writing one by one\n",
+                sqlite3_errmsg(writer_db));
+        if (!sqlite3_get_autocommit(writer_db))
+            sqlite3_exec(writer_db, "ROLLBACK;", NULL, NULL, NULL);
+        grouped = false;
+    }
+    else if (track_mark)
+    {
+        mark_past_own_writes(seq_before, seq_after);
+    }
+    op = first;
+    for (int i = 0; !grouped && i < count; i++, op = op->next)
+        op->result = run_op(writer_db, op);
+    complete_ops(first, count);
+}
+
+// Everything one exchange took off the stack (newest first), committed
+// in submission order, STORAGE_GROUP_MAX ops per transaction
+static void commit_taken(StorageOp *taken)
+{
+    StorageOp *ordered = NULL;
+    while (taken != NULL)
+    {
+        StorageOp *next = taken->next;
+        taken->next = ordered;
+        ordered = taken;
+        taken = next;
+    }
+    while (ordered != NULL)
+    {
+        StorageOp *first = ordered;
+        int count = 0;
+        while (ordered != NULL && count < STORAGE_GROUP_MAX)
+        {
+            ordered = ordered->next;
+            count++;
+        }
+        commit_group(first, count);
+    }
+}
+
+static void *writer_main(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        StorageOp *taken = __atomic_exchange_n(&op_stack, NULL, __ATOMIC_ACQUIRE);
+        if (taken == NULL)
+        {
+            // Pushers signal under the lock after pushing onto an empty
+            // stack, so checking under it cannot miss one
+            pthread_mutex_lock(&writer_lock);
+            while (__atomic_load_n(&op_stack, __ATOMIC_ACQUIRE) == NULL && !writer_stopping)
+                pthread_cond_wait(&writer_wake, &writer_lock);
+            bool stop = writer_stopping && __atomic_load_n(&op_stack, __ATOMIC_ACQUIRE) == NULL;
+            pthread_mutex_unlock(&writer_lock);
+            if (stop)
+                break;
+            continue;
+        }
+        commit_taken(taken);
+    }
+    return NULL;
+}
+
+static void start_writer(const DbTuning *tuning)
+{
+    if (db_open(&writer_db, tuning) != SQLITE_OK)
+    {
+        writer_db = NULL;
+    }
+    else
+    {
+        writer_stopping = false;
+        __atomic_store_n(&writer_running, pthread_create(&writer_thread, NULL, writer_main, NULL) == 0,
+                         __ATOMIC_RELEASE);
+    }
+    if (!__atomic_load_n(&writer_running, __ATOMIC_ACQUIRE))
+    {
+        fprintf(stderr, "Storage Error : Async writer unavailable, queued writes run at once\n");
+        db_close(writer_db);
+        writer_db = NULL;
+    }
+}
+
+// The thread and its connection cost nothing until an async write needs them
+static void ensure_writer(void)
+{
+    if (__atomic_load_n(&writer_tried, __ATOMIC_ACQUIRE))
+        return;
+    pthread_mutex_lock(&writer_start_lock);
+    if (!writer_tried)
+    {
+        start_writer(&storage_tuning);
+        __atomic_store_n(&writer_tried, true, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&writer_start_lock);
+}
+
+// Closes the queue to new writes, lets the thread drain it and stop, then
+// commits anything still on the stack so every future completes
+static void stop_writer(void)
+{
+    pthread_rwlock_wrlock(&submit_gate);
+    accepting_writes = false;
+    pthread_rwlock_unlock(&submit_gate);
+
+    if (__atomic_load_n(&writer_running, __ATOMIC_ACQUIRE))
+    {
+        pthread_mutex_lock(&writer_lock);
+        writer_stopping = true;
+        pthread_cond_signal(&writer_wake);
+        pthread_mutex_unlock(&writer_lock);
+        pthread_join(writer_thread, NULL);
+        __atomic_store_n(&writer_running, false, __ATOMIC_RELEASE);
+    }
+    StorageOp *left = __atomic_exchange_n(&op_stack, NULL, __ATOMIC_ACQUIRE);
+    if (left != NULL)
+        commit_taken(left); // only pushed while the writer (and writer_db) ran
+    db_close(writer_db);
+    writer_db = NULL;
+    writer_tried = false;
+}
+
+static int submit_op(StorageOpKind kind, const Contact *contact, int id, StorageFuture *future,
+                     StorageDoneFn done, void *ctx)
+{
+    if (future != NULL)
+    {
+        future->result = -1;
+        __atomic_store_n(&future->done, 0, __ATOMIC_RELAXED);
+    }
+    // Shared for the whole submission: shutdown waits for it to finish
+    pthread_rwlock_rdlock(&submit_gate);
+    StorageOp *op = NULL;
+    if (accepting_writes && (kind == STORAGE_OP_DELETE || (contact != NULL && contact_fields_valid(contact))))
+        op = calloc(1, sizeof(StorageOp));
+    if (op == NULL)
+    {
+        pthread_rwlock_unlock(&submit_gate);
+        if (future != NULL)
+            __atomic_store_n(&future->done, 1, __ATOMIC_RELEASE);
+        return -1;
+    }
+    op->kind = kind;
+    if (kind == STORAGE_OP_DELETE)
+        op->contact.id = id;
+    else
+        op->contact = *contact;
+    op->future = future;
+    op->done = done;
+    op->ctx = ctx;
+
+    __atomic_add_fetch(&ops_submitted, 1, __ATOMIC_RELAXED);
+    ensure_writer();
+    if (!__atomic_load_n(&writer_running, __ATOMIC_ACQUIRE))
+    {
+        op->result = run_op(db, op);
+        complete_ops(op, 1);
+        pthread_rwlock_unlock(&submit_gate);
+        return 0;
+    }
+
+    StorageOp *head = __atomic_load_n(&op_stack, __ATOMIC_RELAXED);
+    do
+    {
+        op->next = head;
+    } while (!__atomic_compare_exchange_n(&op_stack, &head, op, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    // Only the push that finds the stack empty has to wake the thread
+    if (head == NULL)
+    {
+        pthread_mutex_lock(&writer_lock);
+        pthread_cond_signal(&writer_wake);
+        pthread_mutex_unlock(&writer_lock);
+    }
+    pthread_rwlock_unlock(&submit_gate);
+    return 0;
+}
+
 /* ------------------------------------------------------------------ */
 /*  storage_init                                                       */
 /* ------------------------------------------------------------------ */
-int storage_init(void)
+int storage_init(const DbTuning *tuning)
 {
-    if (db_open(&db) != SQLITE_OK)
+    if (db_open(&db, tuning) != SQLITE_OK)
     {
         fprintf(stderr, "Storage Error : Could not open database");
         return -1;
     }
+    printf("Database profile: %s\n", tuning != NULL ? tuning->name : DB_TUNING_BALANCED.name);
+    db_watch_changes(db);
+    storage_tuning = tuning != NULL ? *tuning : DB_TUNING_BALANCED;
+    pthread_rwlock_wrlock(&submit_gate);
+    accepting_writes = true;
+    pthread_rwlock_unlock(&submit_gate);
     return 0; // placeholder
 }
 
+const DbTuning *storage_tuning_by_name(const char *name)
+{
+    return db_tuning_by_name(name);
+}
+
 /* ------------------------------------------------------------------ */
 /*  storage_shutdown                                                   */
 /* ------------------------------------------------------------------ */
@@ -29,6 +439,8 @@ void storage_shutdown(void)
 {
     // TODO: call db_close(db)
     // Set db = NULL so we don't accidentally use it later
+    stop_writer();
+    close_readers();
     db_close(db);
     db = NULL;
 }
@@ -40,7 +452,24 @@ int storage_load_all(ContactList *list)
 {
     // TODO: call db_load_all_contacts(db, list)
     // Return the number of contacts loaded, or -1 on error
-    return db_load_all_contacts(db, list);
+    // Mark and rows from one read snapshot: refreshes pick up from here
+    pthread_mutex_lock(&mark_lock);
+    bool snapshot = sqlite3_exec(db, "BEGIN;", NULL, NULL, NULL) == SQLITE_OK;
+    have_mark = db_change_mark(db, &change_mark) == SQLITE_OK;
+    int count = db_load_all_contacts(db, list);
+    if (snapshot)
+        sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
+    if (count < 0)
+        have_mark = false;
+    pthread_mutex_unlock(&mark_lock);
+
+    // New contacts must not reuse a loaded id - syncs address rows by id
+    for (int i = 0; list != NULL && i < list->size; i++)
+    {
+        if (list->data[i].id >= next_contact_id)
+            next_contact_id = list->data[i].id + 1;
+    }
+    return count;
 }
 
 /* ------------------------------------------------------------------ */
@@ -76,40 +505,139 @@ int storage_save_all(const ContactList *list)
 {
     if (list == NULL || db == NULL)
         return -1;
+    int saved = db_save_batch(db, list->data, list->size, DB_BATCH_CHUNK, NULL, NULL);
+    if (saved < 0 || db_delete_missing(db, list->data, list->size) < 0)
+        return -1;
+    return saved;
+}
 
-    const char *sql =
-        "INSERT OR REPLACE INTO contacts (id, name, phone, email) "
-        "VALUES (?1, ?2, ?3, ?4);";
-    sqlite3_stmt *stmt = NULL;
-
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK)
-    {
-        fprintf(stderr, "storage_save_all prepare error: %s\n", sqlite3_errmsg(db));
+/* ------------------------------------------------------------------ */
+/*  storage_sync                                                       */
+/* ------------------------------------------------------------------ */
+int storage_sync(ContactList *list, StorageProgressFn progress, void *ctx)
+{
+    if (list == NULL || db == NULL)
         return -1;
-    }
 
-    int saved = 0;
-    for (int i = 0; i < list->size; i++)
+    // Untracked: the database may differ anywhere -> full save, then track.
+    // Afterwards the table mirrors the list, so refreshes start here
+    if (list->state == NULL)
     {
-        const Contact *c = &list->data[i];
-        sqlite3_bind_int(stmt, 1, c->id);
-        sqlite3_bind_text(stmt, 2, c->name, -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 3, c->phone, -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 4, c->email, -1, SQLITE_STATIC);
+        DbChangeMark before;
+        bool marked = db_change_mark(db, &before) == SQLITE_OK;
+        pthread_mutex_lock(&mark_lock);
+        change_mark = before;
+        have_mark = marked;
+        pthread_mutex_unlock(&mark_lock);
+        db_record_changes(false);
+        int saved = db_save_batch(db, list->data, list->size, DB_BATCH_CHUNK, progress, ctx);
+        if (saved >= 0 && db_delete_missing(db, list->data, list->size) < 0)
+            saved = -1;
+        db_record_changes(true);
+        if (saved < 0)
+            return -1;
 
-        if (sqlite3_step(stmt) == SQLITE_DONE)
+        // No other connection committed meanwhile (data_version unmoved):
+        // every entry the save logged is ours, so start past them
+        DbChangeMark after;
+        if (marked && db_change_mark(db, &after) == SQLITE_OK && after.data_version == before.data_version)
         {
-            saved++;
+            pthread_mutex_lock(&mark_lock);
+            change_mark = after;
+            pthread_mutex_unlock(&mark_lock);
         }
-        else
+        contact_list_track_changes(list);
+        return saved;
+    }
+
+    int changed_count = contact_list_changed_count(list);
+    if (changed_count == 0 && list->deleted_count == 0)
+        return 0;
+
+    Contact *changed = NULL;
+    if (changed_count > 0)
+    {
+        changed = malloc((size_t)changed_count * sizeof(Contact));
+        if (changed == NULL)
+            return -1;
+        int n = 0;
+        for (int i = 0; i < list->size; i++)
         {
-            fprintf(stderr, "Failed to save contact ID %d: %s\n", c->id, sqlite3_errmsg(db));
+            if (list->state[i] != 0)
+                changed[n++] = list->data[i];
         }
-        sqlite3_reset(stmt);
     }
 
-    sqlite3_finalize(stmt);
-    return saved;
+    // Rows the list already holds - nothing for a refresh to fetch, neither
+    // through the update hook nor through the log
+    db_record_changes(false);
+    pthread_mutex_lock(&mark_lock);
+    int written = db_sync(db, changed, changed_count, list->deleted_ids, list->deleted_count,
+                          have_mark ? &change_mark : NULL);
+    pthread_mutex_unlock(&mark_lock);
+    db_record_changes(true);
+    free(changed);
+    if (written < 0)
+    {
+        fprintf(stderr, "Storage Error : Sync failed, changes kept for the next save\n");
+        return -1;
+    }
+    if (progress != NULL)
+        progress(changed_count + list->deleted_count, changed_count + list->deleted_count, ctx);
+    contact_list_clear_changes(list);
+    return written;
+}
+
+/* ------------------------------------------------------------------ */
+/*  storage_refresh                                                    */
+/* ------------------------------------------------------------------ */
+int storage_refresh(ContactList *list)
+{
+    if (db == NULL || list == NULL || list->state == NULL || contact_list_has_changes(list))
+        return -1;
+
+    DbChanges changes;
+    pthread_mutex_lock(&mark_lock);
+    bool marked = have_mark;
+    int rc = marked ? db_read_changes(db, &change_mark, &changes) : SQLITE_ERROR;
+    pthread_mutex_unlock(&mark_lock);
+    if (!marked)
+        return -1;
+    if (rc != SQLITE_OK)
+    {
+        if (rc == SQLITE_NOTFOUND)
+            printf("Change log no longer reaches the loaded copy, reloading.\n");
+        return -1;
+    }
+
+    // The mark has moved on: if the patch fails, only a reload is right
+    int patched = changes.rows.size + changes.removed_count;
+    if (patched > 0 &&
+        !contact_list_apply_rows(list, changes.rows.data, changes.rows.size,
+                                 changes.removed_ids, changes.removed_count))
+    {
+        patched = -1;
+        pthread_mutex_lock(&mark_lock);
+        have_mark = false;
+        pthread_mutex_unlock(&mark_lock);
+    }
+    for (int i = 0; patched > 0 && i < changes.rows.size; i++)
+    {
+        if (changes.rows.data[i].id >= next_contact_id)
+            next_contact_id = changes.rows.data[i].id + 1;
+    }
+    db_changes_free(&changes);
+    return patched;
+}
+
+/* ------------------------------------------------------------------ */
+/*  storage_save_batch                                                 */
+/* ------------------------------------------------------------------ */
+int storage_save_batch(const Contact contacts[], int count, StorageProgressFn progress, void *ctx)
+{
+    if (db == NULL)
+        return -1;
+    return db_save_batch(db, contacts, count, DB_BATCH_CHUNK, progress, ctx);
 }
 
 /* ------------------------------------------------------------------ */
@@ -155,6 +683,42 @@ int storage_delete_contact(int id)
     return 0; // placeholder
 }
 
+/* ------------------------------------------------------------------ */
+/*  Async writes                                                       */
+/* ------------------------------------------------------------------ */
+int storage_save_contact_async(const Contact *contact, StorageFuture *future, StorageDoneFn done, void *ctx)
+{
+    return submit_op(STORAGE_OP_SAVE, contact, 0, future, done, ctx);
+}
+
+int storage_update_contact_async(const Contact *contact, StorageFuture *future, StorageDoneFn done, void *ctx)
+{
+    return submit_op(STORAGE_OP_UPDATE, contact, 0, future, done, ctx);
+}
+
+int storage_delete_contact_async(int id, StorageFuture *future, StorageDoneFn done, void *ctx)
+{
+    return submit_op(STORAGE_OP_DELETE, NULL, id, future, done, ctx);
+}
+
+int storage_future_wait(StorageFuture *future)
+{
+    pthread_mutex_lock(&writer_lock);
+    while (!__atomic_load_n(&future->done, __ATOMIC_ACQUIRE))
+        pthread_cond_wait(&writer_done, &writer_lock);
+    pthread_mutex_unlock(&writer_lock);
+    return future->result;
+}
+
+void storage_flush(void)
+{
+    unsigned long target = __atomic_load_n(&ops_submitted, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&writer_lock);
+    while (ops_completed < target)
+        pthread_cond_wait(&writer_done, &writer_lock);
+    pthread_mutex_unlock(&writer_lock);
+}
+
 /* ------------------------------------------------------------------ */
 /*  storage_search_by_name                                             */
 /* ------------------------------------------------------------------ */
@@ -162,7 +726,10 @@ ContactList *storage_search_by_name(const char *pattern)
 {
     if (db == NULL || pattern == NULL)
         return NULL;
-    return db_search_by_name(db, pattern);
+    sqlite3 *reader = acquire_reader();
+    ContactList *results = db_search_by_name(reader, pattern);
+    release_reader(reader);
+    return results;
 }
 
 /* ------------------------------------------------------------------ */
@@ -172,7 +739,10 @@ ContactList *storage_search_by_email(const char *pattern)
 {
     if (db == NULL || pattern == NULL)
         return NULL;
-    return db_search_by_email(db, pattern);
+    sqlite3 *reader = acquire_reader();
+    ContactList *results = db_search_by_email(reader, pattern);
+    release_reader(reader);
+    return results;
 }
 
 /* ------------------------------------------------------------------ */
@@ -182,5 +752,80 @@ ContactList *storage_search_by_phone(const char *pattern)
 {
     if (db == NULL || pattern == NULL)
         return NULL;
-    return db_search_by_phone(db, pattern);
+    sqlite3 *reader = acquire_reader();
+    ContactList *results = db_search_by_phone(reader, pattern);
+    release_reader(reader);
+    return results;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Paged searches                                                     */
+/* ------------------------------------------------------------------ */
+ContactList *storage_search_by_name_page(const char *pattern, int after_id, int limit, int *next_id)
+{
+    if (db == NULL || pattern == NULL)
+        return NULL;
+    sqlite3 *reader = acquire_reader();
+    ContactList *results = db_search_by_name_page(reader, pattern, after_id, limit, next_id);
+    release_reader(reader);
+    return results;
+}
+
+ContactList *storage_search_by_email_page(const char *pattern, int after_id, int limit, int *next_id)
+{
+    if (db == NULL || pattern == NULL)
+        return NULL;
+    sqlite3 *reader = acquire_reader();
+    ContactList *results = db_search_by_email_page(reader, pattern, after_id, limit, next_id);
+    release_reader(reader);
+    return results;
+}
+
+ContactList *storage_search_by_phone_page(const char *pattern, int after_id, int limit, int *next_id)
+{
+    if (db == NULL || pattern == NULL)
+        return NULL;
+    sqlite3 *reader = acquire_reader();
+    ContactList *results = db_search_by_phone_page(reader, pattern, after_id, limit, next_id);
+    release_reader(reader);
+    return results;
+}
+
+/* ------------------------------------------------------------------ */
+/*  storage_find_by_phone                                              */
+/* ------------------------------------------------------------------ */
+ContactList *storage_find_by_phone(const char *phone)
+{
+    if (db == NULL || phone == NULL)
+        return NULL;
+    sqlite3 *reader = acquire_reader();
+    ContactList *results = db_find_by_phone(reader, phone);
+    release_reader(reader);
+    return results;
+}
+
+/* ------------------------------------------------------------------ */
+/*  storage_search_by_phone_suffix                                     */
+/* ------------------------------------------------------------------ */
+ContactList *storage_search_by_phone_suffix(const char *suffix)
+{
+    if (db == NULL || suffix == NULL)
+        return NULL;
+    sqlite3 *reader = acquire_reader();
+    ContactList *results = db_search_by_phone_suffix(reader, suffix);
+    release_reader(reader);
+    return results;
+}
+
+/* ------------------------------------------------------------------ */
+/*  storage_query                                                      */
+/* ------------------------------------------------------------------ */
+ContactList *storage_query(const ContactQuery *query, QueryCursor *next)
+{
+    if (db == NULL || query == NULL)
+        return NULL;
+    sqlite3 *reader = acquire_reader();
+    ContactList *results = contact_query_run_db(reader, query, next);
+    release_reader(reader);
+    return results;
 }
@@ -4,8 +4,16 @@
 
 #include "contact_dynamic.h" // Contact, ContactList
 
+struct DbTuning;     // contact_db.h
+struct ContactQuery; // contact_query.h
+struct QueryCursor;
+
 // Initialize the storage subsystem (open database, etc.). Call once at startup.
-int storage_init(void);
+// 'tuning' picks the SQLite profile (NULL = balanced).
+int storage_init(const struct DbTuning *tuning);
+
+// Tuning preset by name ("durable", "balanced", "bulk-load"), or NULL.
+const struct DbTuning *storage_tuning_by_name(const char *name);
 
 // Shutdown the storage subsystem (close database, etc.).
 void storage_shutdown(void);
@@ -15,17 +23,83 @@ int storage_load_all(ContactList *list);
 
 // Save (insert) a new contact. Returns 0 on success, non-zero on error.
 int storage_save_contact(const Contact *contact);
+// Writes every contact and deletes rows not in 'list'. Returns rows saved or -1.
 int storage_save_all(const ContactList *list);
 
+// Progress of a batched save: rows committed so far out of 'total'.
+typedef void (*StorageProgressFn)(int done, int total, void *ctx);
+
+// Batched insert-or-replace in chunked transactions (see db_save_batch).
+// Returns the number of contacts saved, or -1 on error.
+int storage_save_batch(const Contact contacts[], int count, StorageProgressFn progress, void *ctx);
+
 // Update an existing contact.
 int storage_update_contact(const Contact *contact);
 
 // Delete a contact by ID.
 int storage_delete_contact(int id);
 
+// Queued writes. The *_async calls copy their arguments, queue the write
+// and return 0 at once (-1, with nothing queued, for an invalid contact or
+// once storage_shutdown has begun; the future then holds -1). A background
+// thread, started by the first of them, commits whatever is queued in one
+// transaction, in submission order; storage_shutdown commits what is left.
+// Each write's outcome - 0 on success, -1 on error - is stored in 'future'
+// and passed to 'done' (called on the writer thread, after the commit);
+// either may be NULL. The save keeps contact->id: it inserts that row or
+// overwrites it. These rows are taken to be in the caller's list already,
+// so storage_refresh does not count them (as for storage_sync).
+typedef void (*StorageDoneFn)(int result, void *ctx);
+
+// Owned by the caller; keep it alive until the write completes.
+typedef struct StorageFuture
+{
+    int done;
+    int result;
+} StorageFuture;
+
+int storage_save_contact_async(const Contact *contact, StorageFuture *future, StorageDoneFn done, void *ctx);
+int storage_update_contact_async(const Contact *contact, StorageFuture *future, StorageDoneFn done, void *ctx);
+int storage_delete_contact_async(int id, StorageFuture *future, StorageDoneFn done, void *ctx);
+
+// Blocks until the write behind 'future' is committed; returns its result.
+int storage_future_wait(StorageFuture *future);
+
+// Blocks until every write queued so far is committed.
+void storage_flush(void);
+
+// Writes what changed in 'list' since its last sync - upserts for new and
+// edited contacts, deletes for removed ids - in one transaction, then
+// clears the change set. A list without change tracking gets a full save
+// (rows missing from the list are deleted) and starts tracking.
+// Returns the number of rows written, or -1 on error (changes kept).
+int storage_sync(ContactList *list, StorageProgressFn progress, void *ctx);
+
+// Patches 'list' - loaded by storage_load_all (or synced), with no unsaved
+// changes - with what changed in the database since: rows written by
+// other connections or processes, and single-contact writes made through
+// this one. Call while no save is running.
+// Returns the number of contacts updated, added or removed (0 = nothing
+// changed), or -1 if the list has to be reloaded instead.
+int storage_refresh(ContactList *list);
+
 // Search functions...
 ContactList *storage_search_by_name(const char *pattern);
 ContactList *storage_search_by_email(const char *pattern);
 ContactList *storage_search_by_phone(const char *pattern);
 
+// One page of a search: up to 'limit' matches after id 'after_id'.
+// *next_id is the after_id for the next page, 0 after the last one.
+ContactList *storage_search_by_name_page(const char *pattern, int after_id, int limit, int *next_id);
+ContactList *storage_search_by_email_page(const char *pattern, int after_id, int limit, int *next_id);
+ContactList *storage_search_by_phone_page(const char *pattern, int after_id, int limit, int *next_id);
+
+// Exact phone number / "ends with these digits", formatting ignored.
+ContactList *storage_find_by_phone(const char *phone);
+ContactList *storage_search_by_phone_suffix(const char *suffix);
+
+// Runs a multi-field query as one statement (see contact_query_run_db).
+// 'next' gets the position after a full page. NULL on error.
+ContactList *storage_query(const struct ContactQuery *query, struct QueryCursor *next);
+
 #endif
\ No newline at end of file
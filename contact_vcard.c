@@ -0,0 +1,561 @@
+#include "contact_vcard.h"
+#include "file_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// A piece of the mapped file (or of the unfold buffer) - never copied
+typedef struct
+{
+    const char *data;
+    size_t length;
+} Slice;
+
+typedef struct
+{
+    Slice name; // without any "group." prefix
+    Slice params;
+    Slice value;
+} Property;
+
+// What has been collected for the card being read
+typedef struct
+{
+    Contact contact;
+    char family_given[MAX_NAME_LEN]; // from N, used when there is no FN
+    bool family_given_overflow;
+    bool have_fn;
+    bool have_phone, phone_pref;
+    bool have_email, email_pref;
+    bool overflow;
+    long line; // of BEGIN:VCARD
+} CardState;
+
+// ============================================================================
+// SLICES
+// ============================================================================
+
+// Property names are ASCII; toupper() would consult the locale per byte
+static char ascii_upper(char c)
+{
+    return (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+}
+
+static bool slice_is(Slice slice, const char *text)
+{
+    size_t length = strlen(text);
+    if (slice.length != length)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        if (ascii_upper(slice.data[i]) != text[i])
+            return false;
+    }
+    return true;
+}
+
+static bool slice_starts_with(Slice slice, const char *prefix)
+{
+    Slice head = {slice.data, strlen(prefix)};
+    return slice.length >= head.length && slice_is(head, prefix);
+}
+
+// "pref" anywhere in the parameters: TYPE=pref (3.0) or PREF=1 (4.0)
+static bool params_have_pref(Slice params)
+{
+    for (size_t i = 0; i + 4 <= params.length; i++)
+    {
+        Slice word = {params.data + i, 4};
+        if (slice_is(word, "PREF"))
+            return true;
+    }
+    return false;
+}
+
+// Splits "[group.]NAME[;params]:value". Quoted parameter values may hold
+// ':' and ';'.
+static bool parse_property(const char *line, size_t length, Property *property)
+{
+    const char *end = line + length;
+    const char *p = line;
+
+    while (p < end && *p != ';' && *p != ':')
+    {
+        p++;
+    }
+    if (p == end)
+    {
+        return false;
+    }
+    property->name.data = line;
+    property->name.length = (size_t)(p - line);
+    for (size_t i = property->name.length; i > 0; i--)
+    {
+        if (line[i - 1] == '.')
+        {
+            property->name.data = line + i;
+            property->name.length -= i;
+            break;
+        }
+    }
+
+    const char *params = p;
+    bool quoted = false;
+    while (p < end && (quoted || *p != ':'))
+    {
+        if (*p == '"')
+            quoted = !quoted;
+        p++;
+    }
+    if (p == end)
+    {
+        return false;
+    }
+    property->params.data = params;
+    property->params.length = (size_t)(p - params);
+    property->value.data = p + 1;
+    property->value.length = (size_t)(end - p - 1);
+    return true;
+}
+
+// Unescapes \\ \, \; \n into 'dst' (capacity includes the NUL), stopping
+// at an unescaped ';' if 'stop_at_semicolon'. Returns the number of source
+// bytes used; *overflow is set if the value did not fit.
+static size_t unescape_value(char *dst, size_t capacity, const char *src, size_t length,
+                             bool stop_at_semicolon, bool *overflow)
+{
+    // Common case: nothing to unescape or split - one copy
+    if (memchr(src, '\\', length) == NULL && (!stop_at_semicolon || memchr(src, ';', length) == NULL))
+    {
+        size_t count = length;
+        if (count >= capacity)
+        {
+            *overflow = true;
+            count = capacity - 1;
+        }
+        memcpy(dst, src, count);
+        dst[count] = '\0';
+        return length;
+    }
+
+    size_t out = 0;
+    size_t i = 0;
+    while (i < length)
+    {
+        char c = src[i++];
+        if (c == ';' && stop_at_semicolon)
+        {
+            break;
+        }
+        if (c == '\\' && i < length)
+        {
+            c = src[i++];
+            if (c == 'n' || c == 'N')
+                c = ' '; // contacts have no multi-line fields
+        }
+        if (out + 1 >= capacity)
+        {
+            *overflow = true;
+            continue;
+        }
+        dst[out++] = c;
+    }
+    dst[out] = '\0';
+    return i;
+}
+
+// ============================================================================
+// IMPORT
+// ============================================================================
+
+// N:Family;Given;Additional;Prefix;Suffix -> "Given Family"
+static void name_from_n(CardState *card, Slice value)
+{
+    char family[MAX_NAME_LEN];
+    char given[MAX_NAME_LEN];
+    bool *overflow = &card->family_given_overflow;
+    size_t used = unescape_value(family, sizeof(family), value.data, value.length, true, overflow);
+    given[0] = '\0';
+    if (used < value.length)
+    {
+        unescape_value(given, sizeof(given), value.data + used, value.length - used, true, overflow);
+    }
+
+    size_t given_length = strlen(given);
+    size_t family_length = strlen(family);
+    size_t length = 0;
+    if (given_length + 1 + family_length >= MAX_NAME_LEN)
+    {
+        *overflow = true;
+        family_length = 0;
+    }
+    memcpy(card->family_given, given, given_length);
+    length = given_length;
+    if (given_length > 0 && family_length > 0)
+    {
+        card->family_given[length++] = ' ';
+    }
+    memcpy(card->family_given + length, family, family_length);
+    card->family_given[length + family_length] = '\0';
+}
+
+// 'truncated': the line was longer than VCARD_LINE_MAX (only matters for
+// the properties used here - a folded PHOTO is fine)
+static void apply_property(CardState *card, const Property *property, bool truncated)
+{
+    Slice value = property->value;
+
+    if (slice_is(property->name, "FN"))
+    {
+        if (!card->have_fn)
+        {
+            unescape_value(card->contact.name, MAX_NAME_LEN, value.data, value.length, false, &card->overflow);
+            card->overflow |= truncated;
+            card->have_fn = true;
+        }
+    }
+    else if (slice_is(property->name, "N"))
+    {
+        name_from_n(card, value);
+        card->family_given_overflow |= truncated;
+    }
+    else if (slice_is(property->name, "TEL"))
+    {
+        bool pref = params_have_pref(property->params);
+        if (!card->have_phone || (pref && !card->phone_pref))
+        {
+            if (slice_starts_with(value, "TEL:"))
+            {
+                value.data += 4; // 4.0 URI form
+                value.length -= 4;
+            }
+            unescape_value(card->contact.phone, MAX_PHONE_LEN, value.data, value.length, false, &card->overflow);
+            card->overflow |= truncated;
+            card->have_phone = true;
+            card->phone_pref = pref;
+        }
+    }
+    else if (slice_is(property->name, "EMAIL"))
+    {
+        bool pref = params_have_pref(property->params);
+        if (!card->have_email || (pref && !card->email_pref))
+        {
+            unescape_value(card->contact.email, MAX_EMAIL_LEN, value.data, value.length, false, &card->overflow);
+            card->overflow |= truncated;
+            card->have_email = true;
+            card->email_pref = pref;
+        }
+    }
+}
+
+static const char *finish_card(CardState *card)
+{
+    if (!card->have_fn)
+    {
+        memcpy(card->contact.name, card->family_given, MAX_NAME_LEN);
+        card->overflow |= card->family_given_overflow;
+    }
+    if (card->overflow)
+        return "field too long";
+    if (!contact_validate_name(card->contact.name))
+        return "invalid name";
+    if (!contact_validate_phone(card->contact.phone))
+        return "invalid phone";
+    if (!contact_validate_email(card->contact.email))
+        return "invalid e-mail";
+    return NULL;
+}
+
+// Copies a folded line without its CRLF + space/tab continuations
+static size_t unfold(char *dst, const char *src, size_t length, bool *truncated)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (src[i] == '\r' && i + 1 < length && src[i + 1] == '\n')
+        {
+            continue; // the '\n' that follows does the skipping
+        }
+        if (src[i] == '\n')
+        {
+            i++; // and the leading space/tab of the continuation
+            continue;
+        }
+        if (out == VCARD_LINE_MAX)
+        {
+            *truncated = true;
+            break;
+        }
+        dst[out++] = src[i];
+    }
+    return out;
+}
+
+bool contact_vcard_import(const char *path, CsvBatchFn sink, void *ctx, CsvStats *stats)
+{
+    if (path == NULL || sink == NULL || stats == NULL)
+    {
+        return false;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    clock_t started = clock();
+    FileMap map;
+    char *scratch = NULL;
+    Contact *batch = NULL;
+    int batched = 0;
+    bool success = false;
+    bool in_card = false;
+    CardState card;
+
+    // === STEP 1: Map the whole file ===
+    if (!file_map(path, &map))
+    {
+        printf("VCARD ERROR: Cannot open '%s'\n", path);
+        return false;
+    }
+    scratch = malloc(VCARD_LINE_MAX);
+    batch = malloc(CSV_BATCH_SIZE * sizeof(Contact));
+    if (scratch == NULL || batch == NULL)
+    {
+        printf("VCARD ERROR: Out of memory\n");
+        goto cleanup;
+    }
+
+    // === STEP 2: One logical (unfolded) line at a time ===
+    const char *p = (const char *)map.data;
+    const char *end = p + map.size;
+    long line_number = 0;
+    while (p < end)
+    {
+        const char *line = p;
+        const char *line_end;
+        bool folded = false;
+        do
+        {
+            if (p != line)
+                folded = true;
+            const char *newline = memchr(p, '\n', (size_t)(end - p));
+            line_end = (newline != NULL) ? newline : end;
+            p = (newline != NULL) ? newline + 1 : end;
+            line_number++;
+        } while (p < end && (*p == ' ' || *p == '\t'));
+
+        if (line_end > line && line_end[-1] == '\r')
+        {
+            line_end--;
+        }
+        size_t length = (size_t)(line_end - line);
+        if (length == 0)
+        {
+            continue;
+        }
+
+        bool truncated = false;
+        if (folded)
+        {
+            length = unfold(scratch, line, length, &truncated);
+            line = scratch;
+        }
+
+        Property property;
+        if (!parse_property(line, length, &property))
+        {
+            continue; // not a property line - ignored like any unknown one
+        }
+
+        if (slice_is(property.name, "BEGIN") && slice_is(property.value, "VCARD"))
+        {
+            memset(&card, 0, sizeof(card));
+            card.line = line_number;
+            in_card = true;
+        }
+        else if (slice_is(property.name, "END") && slice_is(property.value, "VCARD") && in_card)
+        {
+            in_card = false;
+            stats->rows++;
+            const char *reason = finish_card(&card);
+            if (reason != NULL)
+            {
+                if (stats->rejected < CSV_MAX_REPORTED)
+                    printf("VCARD WARNING: Card at line %ld skipped (%s)\n", card.line, reason);
+                stats->rejected++;
+                continue;
+            }
+
+            card.contact.id = next_contact_id++;
+            batch[batched++] = card.contact;
+            if (batched == CSV_BATCH_SIZE)
+            {
+                if (!sink(batch, batched, ctx))
+                {
+                    printf("VCARD ERROR: Could not store cards before line %ld\n", line_number);
+                    goto cleanup;
+                }
+                stats->imported += batched;
+                batched = 0;
+            }
+        }
+        else if (in_card)
+        {
+            apply_property(&card, &property, truncated);
+        }
+    }
+
+    if (batched > 0)
+    {
+        if (!sink(batch, batched, ctx))
+        {
+            printf("VCARD ERROR: Could not store the last %d cards\n", batched);
+            goto cleanup;
+        }
+        stats->imported += batched;
+    }
+    success = true;
+
+cleanup:
+    if (stats->rejected > CSV_MAX_REPORTED)
+    {
+        printf("VCARD WARNING: %ld more cards skipped\n", stats->rejected - CSV_MAX_REPORTED);
+    }
+    stats->bytes = (long long)map.size;
+    stats->seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+    file_unmap(&map);
+    free(scratch);
+    free(batch);
+    return success;
+}
+
+// ============================================================================
+// EXPORT
+// ============================================================================
+
+// Appends 'text' to 'line' with , ; \ escaped
+static size_t append_escaped(char *line, size_t length, const char *text)
+{
+    for (; *text != '\0'; text++)
+    {
+        if (*text == ',' || *text == ';' || *text == '\\')
+            line[length++] = '\\';
+        line[length++] = *text;
+    }
+    return length;
+}
+
+// Writes one logical line, folded so no physical line exceeds
+// VCARD_FOLD_WIDTH octets (never inside a UTF-8 sequence)
+static void write_folded(FILE *file, const char *line, size_t length)
+{
+    size_t width = VCARD_FOLD_WIDTH;
+    while (length > width)
+    {
+        size_t cut = width;
+        while (cut > 1 && ((unsigned char)line[cut] & 0xC0) == 0x80)
+            cut--;
+        fwrite(line, 1, cut, file);
+        fputs("\r\n ", file);
+        line += cut;
+        length -= cut;
+        width = VCARD_FOLD_WIDTH - 1; // the leading space counts
+    }
+    fwrite(line, 1, length, file);
+    fputs("\r\n", file);
+}
+
+static void write_property(FILE *file, const char *prefix, const char *value)
+{
+    char line[64 + 2 * MAX_EMAIL_LEN]; // prefix + every byte escaped
+    size_t length = strlen(prefix);
+    memcpy(line, prefix, length);
+    length = append_escaped(line, length, value);
+    write_folded(file, line, length);
+}
+
+static void write_card(FILE *file, const Contact *contact, int version)
+{
+    fputs(version == 4 ? "BEGIN:VCARD\r\nVERSION:4.0\r\n" : "BEGIN:VCARD\r\nVERSION:3.0\r\n", file);
+    write_property(file, "FN:", contact->name);
+
+    // N: last word as family name, the rest as given name
+    char line[16 + 2 * MAX_NAME_LEN];
+    char given[MAX_NAME_LEN];
+    const char *space = strrchr(contact->name, ' ');
+    size_t given_length = (space != NULL) ? (size_t)(space - contact->name) : 0;
+    memcpy(given, contact->name, given_length);
+    given[given_length] = '\0';
+
+    memcpy(line, "N:", 2);
+    size_t length = append_escaped(line, 2, space != NULL ? space + 1 : contact->name);
+    line[length++] = ';';
+    length = append_escaped(line, length, given);
+    memcpy(line + length, ";;;", 3);
+    write_folded(file, line, length + 3);
+
+    write_property(file, version == 4 ? "TEL;VALUE=text:" : "TEL;TYPE=VOICE:", contact->phone);
+    write_property(file, version == 4 ? "EMAIL:" : "EMAIL;TYPE=INTERNET:", contact->email);
+    fputs("END:VCARD\r\n", file);
+}
+
+bool contact_vcard_export(const char *path, const ContactList *list, int version, CsvStats *stats)
+{
+    if (path == NULL || list == NULL || stats == NULL)
+    {
+        return false;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    clock_t started = clock();
+    char temp_name[512];
+    snprintf(temp_name, sizeof(temp_name), "%s.tmp", path);
+
+    FILE *file = fopen(temp_name, "wb");
+    if (file == NULL)
+    {
+        printf("VCARD ERROR: Cannot create '%s'\n", temp_name);
+        return false;
+    }
+    setvbuf(file, NULL, _IOFBF, CSV_BUFFER_SIZE);
+
+    for (int i = 0; i < list->size; i++)
+    {
+        write_card(file, &list->data[i], version);
+    }
+
+    bool success = fflush(file) == 0 && !ferror(file) && file_sync(file);
+    stats->bytes = (long long)ftell(file);
+    if (fclose(file) != 0)
+    {
+        success = false;
+    }
+    if (success && !file_replace(temp_name, path))
+    {
+        printf("VCARD ERROR: Cannot replace '%s'\n", path);
+        success = false;
+    }
+    if (!success)
+    {
+        printf("VCARD ERROR: Export to '%s' failed\n", path);
+        remove(temp_name);
+        return false;
+    }
+
+    stats->rows = list->size;
+    stats->imported = list->size;
+    stats->seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+    return true;
+}
+
+bool contact_vcard_is_vcf(const char *path)
+{
+    if (path == NULL)
+    {
+        return false;
+    }
+    size_t length = strlen(path);
+    Slice tail4 = {path + (length >= 4 ? length - 4 : 0), length >= 4 ? 4 : 0};
+    Slice tail6 = {path + (length >= 6 ? length - 6 : 0), length >= 6 ? 6 : 0};
+    return slice_is(tail4, ".VCF") || slice_is(tail6, ".VCARD");
+}
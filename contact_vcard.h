@@ -0,0 +1,31 @@
+#ifndef CONTACT_VCARD_H
+#define CONTACT_VCARD_H
+
+#include <stdbool.h>
+#include "contact_dynamic.h"
+#include "contact_csv.h" // CsvBatchFn, CsvStats
+
+// vCard 3.0 / 4.0 import and export.
+//
+// The importer memory-maps the .vcf file and walks it line by line. Property
+// names, parameters and values are slices of the mapping; only lines that
+// are folded (continued on the next line with a leading space or tab) are
+// unfolded into a scratch buffer first. Each value is unescaped straight
+// into its Contact field.
+//
+// Per card: FN (or, without FN, "Given Family" from N), the first TEL and
+// the first EMAIL - a later one marked "pref" wins. Cards go through the
+// same validation and batching as CSV rows.
+
+#define VCARD_LINE_MAX 4096 // longest folded line that is unfolded
+#define VCARD_FOLD_WIDTH 75 // octets per written line, as RFC 6350 asks
+
+bool contact_vcard_import(const char *path, CsvBatchFn sink, void *ctx, CsvStats *stats);
+
+// Writes 'list' as vCard 'version' (3 or 4) through a temp file + rename.
+bool contact_vcard_export(const char *path, const ContactList *list, int version, CsvStats *stats);
+
+// True for *.vcf / *.vcard file names.
+bool contact_vcard_is_vcf(const char *path);
+
+#endif
@@ -0,0 +1,303 @@
+/******************************************************************************
+ * FILE: file_io.c
+ * DESCRIPTION: Durable file I/O helpers (Windows + POSIX)
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L // fileno, fsync, ftruncate under -std=c99
+
+#include "file_io.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool file_sync(FILE *file)
+{
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    // Step 1: stdio buffer -> OS
+    if (fflush(file) != 0)
+    {
+        return false;
+    }
+
+    // Step 2: OS cache -> disk
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#elif defined(_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
+    return fdatasync(fileno(file)) == 0; // skips mtime-only inode updates
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool file_pread(FILE *file, void *buffer, size_t size, long long offset)
+{
+    if (file == NULL || buffer == NULL || offset < 0)
+    {
+        return false;
+    }
+
+    char *bytes = (char *)buffer;
+    size_t done = 0;
+    while (done < size)
+    {
+#ifdef _WIN32
+        // ReadFile with an OVERLAPPED offset is the Windows pread
+        OVERLAPPED overlapped = {0};
+        DWORD got = 0;
+        long long at = offset + (long long)done;
+        overlapped.Offset = (DWORD)(at & 0xFFFFFFFF);
+        overlapped.OffsetHigh = (DWORD)(at >> 32);
+        if (!ReadFile((HANDLE)_get_osfhandle(_fileno(file)), bytes + done,
+                      (DWORD)(size - done), &got, &overlapped) ||
+            got == 0)
+        {
+            return false;
+        }
+#else
+        ssize_t got = pread(fileno(file), bytes + done, size - done, (off_t)(offset + (long long)done));
+        if (got <= 0)
+        {
+            return false; // error or unexpected end of file
+        }
+#endif
+        done += (size_t)got;
+    }
+    return true;
+}
+
+bool file_pwrite(FILE *file, const void *buffer, size_t size, long long offset)
+{
+    if (file == NULL || buffer == NULL || offset < 0)
+    {
+        return false;
+    }
+
+    const char *bytes = (const char *)buffer;
+    size_t done = 0;
+    while (done < size)
+    {
+#ifdef _WIN32
+        OVERLAPPED overlapped = {0};
+        DWORD put = 0;
+        long long at = offset + (long long)done;
+        overlapped.Offset = (DWORD)(at & 0xFFFFFFFF);
+        overlapped.OffsetHigh = (DWORD)(at >> 32);
+        if (!WriteFile((HANDLE)_get_osfhandle(_fileno(file)), bytes + done,
+                       (DWORD)(size - done), &put, &overlapped) ||
+            put == 0)
+        {
+            return false;
+        }
+#else
+        ssize_t put = pwrite(fileno(file), bytes + done, size - done, (off_t)(offset + (long long)done));
+        if (put <= 0)
+        {
+            return false;
+        }
+#endif
+        done += (size_t)put;
+    }
+    return true;
+}
+
+bool file_truncate(FILE *file, long length)
+{
+    if (file == NULL || length < 0)
+    {
+        return false;
+    }
+
+    if (fflush(file) != 0)
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    return _chsize(_fileno(file), length) == 0;
+#else
+    return ftruncate(fileno(file), (off_t)length) == 0;
+#endif
+}
+
+bool file_replace(const char *from, const char *to)
+{
+    if (from == NULL || to == NULL)
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    // Plain rename() refuses to overwrite on Windows
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+bool file_sync_dir(const char *path)
+{
+    if (path == NULL)
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    // NTFS journals the rename itself; MOVEFILE_WRITE_THROUGH already waited
+    return true;
+#else
+    char directory[260];
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL)
+    {
+        snprintf(directory, sizeof(directory), ".");
+    }
+    else
+    {
+        size_t length = (slash == path) ? 1 : (size_t)(slash - path);
+        if (length >= sizeof(directory))
+        {
+            return false;
+        }
+        memcpy(directory, path, length);
+        directory[length] = '\0';
+    }
+
+    int fd = open(directory, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+#endif
+}
+
+bool file_link(const char *existing, const char *new_path)
+{
+    if (existing == NULL || new_path == NULL)
+    {
+        return false;
+    }
+
+#ifdef _WIN32
+    return CreateHardLinkA(new_path, existing, NULL) != 0;
+#else
+    return link(existing, new_path) == 0;
+#endif
+}
+
+bool file_map(const char *path, FileMap *map)
+{
+    if (path == NULL || map == NULL)
+    {
+        return false;
+    }
+    memset(map, 0, sizeof(*map));
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || (unsigned long long)size.QuadPart > (size_t)-1)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    map->size = (size_t)size.QuadPart;
+    map->os_file = file;
+    if (map->size == 0)
+    {
+        return true; // CreateFileMapping rejects empty files
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        file_unmap(map);
+        return false;
+    }
+    map->os_mapping = mapping;
+    map->data = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (map->data == NULL)
+    {
+        file_unmap(map);
+        return false;
+    }
+    return true;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    map->size = (size_t)info.st_size;
+    if (map->size > 0)
+    {
+        void *data = mmap(NULL, map->size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            map->size = 0;
+            return false;
+        }
+        map->data = (const uint8_t *)data;
+    }
+    close(fd); // the mapping keeps the file referenced
+    return true;
+#endif
+}
+
+void file_unmap(FileMap *map)
+{
+    if (map == NULL)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    if (map->data != NULL)
+    {
+        UnmapViewOfFile(map->data);
+    }
+    if (map->os_mapping != NULL)
+    {
+        CloseHandle((HANDLE)map->os_mapping);
+    }
+    if (map->os_file != NULL)
+    {
+        CloseHandle((HANDLE)map->os_file);
+    }
+#else
+    if (map->data != NULL)
+    {
+        munmap((void *)map->data, map->size);
+    }
+#endif
+    memset(map, 0, sizeof(*map));
+}
@@ -0,0 +1,51 @@
+/******************************************************************************
+ * FILE: file_io.h
+ * DESCRIPTION: Small portability layer for durable file I/O
+ * RULE: Hide every #ifdef _WIN32 behind these functions
+ ******************************************************************************/
+
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Read-only view of a whole file. 'data' is NULL for an empty file.
+typedef struct
+{
+    const uint8_t *data;
+    size_t size;
+    void *os_file;    // Windows: file and mapping handles; unused on POSIX
+    void *os_mapping;
+} FileMap;
+
+// Flush stdio buffers and force the file contents to stable storage.
+bool file_sync(FILE *file);
+
+// Positional read at a byte offset (pread / ReadFile with OVERLAPPED).
+// Succeeds only when exactly 'size' bytes were read.
+bool file_pread(FILE *file, void *buffer, size_t size, long long offset);
+
+// Positional write at a byte offset (pwrite / WriteFile with OVERLAPPED).
+// Bypasses stdio buffering; call file_sync() to make it durable.
+bool file_pwrite(FILE *file, const void *buffer, size_t size, long long offset);
+
+// Cut the file down to 'length' bytes (used to drop a torn journal tail).
+bool file_truncate(FILE *file, long length);
+
+// Atomically replace 'to' with 'from' (rename / MoveFileEx). Readers see
+// either the old or the new file, never a mix or nothing.
+bool file_replace(const char *from, const char *to);
+
+// Make renames/links inside the directory holding 'path' durable.
+bool file_sync_dir(const char *path);
+
+// Second name for an existing file without copying it (link / CreateHardLink).
+bool file_link(const char *existing, const char *new_path);
+
+// Map a file read-only (mmap / MapViewOfFile). Pages are read on first touch.
+bool file_map(const char *path, FileMap *map);
+void file_unmap(FileMap *map);
+
+#endif // FILE_IO_H
@@ -16,6 +16,14 @@
 #include <direct.h>
 #include <windows.h>
 #include "contact_storage.h"
+#include "contact_journal.h"
+#include "contact_saver.h"
+#include "contact_index.h"
+#include "contact_csv.h"
+#include "contact_vcard.h"
+#include "contact_columnar.h"
+#include "contact_query.h"
+#include "contact_lazy.h"
 
 static bool g_use_database = false;
 
@@ -32,6 +40,12 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE hPrev,
 // ============================================================================
 
 extern ContactList contact_list;
+static ContactIndex g_index; // sorted orders over contact_list, built on demand and kept in step with edits
+static LazyContactFile g_lazy; // contacts.dat read on demand, until something needs the whole list
+static bool g_lazy_open = false;
+static int g_failed_db_writes = 0; // queued database writes that failed, counted on the writer thread
+
+#define SEARCH_PAGE_SIZE 20 // database search results shown per page
 
 // ============================================================================
 // FUNCTION PROTOTYPES
@@ -43,9 +57,16 @@ void list_contacts(void);
 void search_contacts(void);
 void delete_contact(void);
 void edit_contact(void);
+void import_export_contacts(void);
 
 // Helper functions
 void display_search_results(const Contact contacts[], const int indices[], int count);
+bool load_legacy_contacts(void);
+bool load_legacy_snapshot(void);
+bool ensure_contacts_loaded(void);
+bool load_database_contacts(void);
+bool save_contacts_now(void);
+void report_background_saves(void);
 
 // UI functions
 void show_menu(void);
@@ -69,8 +90,15 @@ int main(int argc, char **argv)
         printf("Current working directory: %s\n", cwd);
     }
 
-    // Try to initialize the SQLite database
-    if (storage_init() == 0)
+    // Try to initialize the SQLite database, with the profile picked for
+    // this deployment (CM_DB_PROFILE=durable|balanced|bulk-load)
+    const char *profile = getenv("CM_DB_PROFILE");
+    const struct DbTuning *tuning = storage_tuning_by_name(profile);
+    if (profile != NULL && tuning == NULL)
+    {
+        printf("Unknown CM_DB_PROFILE '%s', using 'balanced'.\n", profile);
+    }
+    if (storage_init(tuning) == 0)
     {
         g_use_database = true;
     }
@@ -82,15 +110,7 @@ int main(int argc, char **argv)
     // Load contacts
     if (g_use_database)
     {
-        int count = storage_load_all(&contact_list);
-        if (count >= 0)
-        {
-            printf("Loaded %d contacts from database.\n", count);
-        }
-        else
-        {
-            printf("Failed to load from database.\n");
-        }
+        load_database_contacts();
 
         // If database loaded zero contacts, offer to import legacy
         if (contact_list.size == 0)
@@ -99,8 +119,9 @@ int main(int argc, char **argv)
             if (get_char_prompt("Database is empty. Attempt to load from legacy file? (Y/N): ", &ch) &&
                 tolower(ch) == 'y')
             {
-                if (contact_file_load_backup(&contact_list))
+                if (load_legacy_contacts())
                 {
+                    contact_list_stop_tracking(&contact_list); // first save writes them all
                     printf("Legacy contacts imported successfully!\n");
                 }
                 else
@@ -117,7 +138,7 @@ int main(int argc, char **argv)
         if (get_char_prompt("Attempt to load saved contacts? (Y/N): ", &ch) &&
             tolower(ch) == 'y')
         {
-            if (contact_file_load_backup(&contact_list))
+            if (load_legacy_contacts())
             {
                 printf("Contacts loaded successfully!\n");
             }
@@ -127,15 +148,26 @@ int main(int argc, char **argv)
             }
         }
     }
+
+    // Every add/edit/delete is appended here until the next save compacts it
+    if (!contact_journal_open())
+    {
+        printf("Warning: change journal unavailable, unsaved edits are not crash-safe.\n");
+    }
+
+    // Saves run on a worker thread; without one they run in the foreground
+    contact_saver_start();
+
     int choice;
     do
     {
+        report_background_saves();
         show_menu();
 
         // Use YOUR library - consistent error handling!
-        if (!get_int_range_prompt("Enter choice (1-9): ", 1, 9, &choice))
+        if (!get_int_range_prompt("Enter choice (1-10): ", 1, 10, &choice))
         {
-            printf("\nInvalid input! Please enter a number 1-9.\n");
+            printf("\nInvalid input! Please enter a number 1-10.\n");
             pause_program("Press Enter to continue...");
             continue;
         }
@@ -158,54 +190,57 @@ int main(int argc, char **argv)
             edit_contact();
             break;
         case 6:
-            // Always save to legacy backup
-            bool legacy_ok = contact_file_save_backup(&contact_list);
-
-            // If SQLite is active, also save to the database
-            bool db_ok = true; // assume ok if not using database
-            if (g_use_database)
+            ensure_contacts_loaded();
+            if (contact_saver_request(&contact_list, g_use_database))
             {
-                int saved = storage_save_all(&contact_list);
-                db_ok = (saved >= 0);
+                printf("Saving %d contacts in the background...\n", contact_list.size);
             }
-
-            if (legacy_ok && db_ok)
+            else if (save_contacts_now())
             {
                 printf("Contacts saved successfully.\n");
             }
-            else
-            {
-                if (!legacy_ok)
-                    printf("Failed to save to legacy file.\n");
-                if (!db_ok)
-                    printf("Failed to save to database.\n");
-            }
             pause_program("Press Enter to continue...");
             break;
         case 7:
+            // Reload what is on disk, so let a running save land first
+            contact_saver_wait();
+            report_background_saves();
+
+            // Nothing unsaved: patch in only what changed in the database
+            if (g_use_database && !contact_list_has_changes(&contact_list))
+            {
+                int patched = storage_refresh(&contact_list);
+                if (patched >= 0)
+                {
+                    if (patched > 0)
+                    {
+                        contact_index_invalidate(&g_index);
+                        printf("\nUpdated %d contact(s) changed in the database.\n", patched);
+                    }
+                    else
+                    {
+                        printf("\nContacts are already up to date.\n");
+                    }
+                    pause_program("Press Enter to continue...");
+                    break;
+                }
+            }
+
             printf("\nReloading contacts...\n");
+            contact_index_invalidate(&g_index);
             contact_list_free(&contact_list);
             contact_list_init(&contact_list, 10);
 
             bool loaded = false;
             if (g_use_database)
             {
-                int count = storage_load_all(&contact_list);
-                if (count >= 0)
-                {
-                    printf("Loaded %d contacts from database.\n", count);
-                    loaded = true;
-                }
-                else
-                {
-                    printf("Failed to load from database.\n");
-                }
+                loaded = load_database_contacts();
             }
 
             if (!loaded)
             {
                 // Fallback to legacy
-                if (contact_file_load_backup(&contact_list))
+                if (load_legacy_contacts())
                 {
                     printf("Loaded contacts from legacy backup.\n");
                     loaded = true;
@@ -221,6 +256,9 @@ int main(int argc, char **argv)
             clear_screen();
             break;
         case 9:
+            import_export_contacts();
+            break;
+        case 10:
             printf("\nExiting Contact Manager...\n");
             break;
         default:
@@ -229,8 +267,28 @@ int main(int argc, char **argv)
             break;
         }
 
-    } while (choice != 9);
+        contact_journal_sync(); // one fsync per menu action at most
+
+        if (choice != 10 && !g_lazy_open && contact_saver_autosave(&contact_list, g_use_database))
+        {
+            printf("Autosaving in the background...\n");
+        }
+
+    } while (choice != 10);
 
+    contact_saver_stop(); // a save still in flight completes first
+    if (g_use_database)
+    {
+        storage_flush(); // so do queued database writes, reported below
+    }
+    report_background_saves();
+    if (g_use_database)
+    {
+        storage_shutdown(); // closes the database after any queued writes
+    }
+    contact_journal_close();
+    contact_lazy_close(&g_lazy);
+    contact_index_close(&g_index);
     contact_list_free(&contact_list);
     pause_program("Press Enter to exit completely...");
     return 0;
@@ -240,10 +298,44 @@ int main(int argc, char **argv)
 // CORE OPERATIONS (IMPLEMENT THESE!)
 // ============================================================================
 
+// In database mode every add, edit and delete also goes to the database
+// right away, through the storage writer (a burst of them shares one
+// commit). The list keeps tracking the change all the same, so the next
+// save writes it again if the queued write failed.
+static void count_failed_write(int result, void *ctx)
+{
+    (void)ctx;
+    if (result != 0)
+    {
+        __atomic_add_fetch(&g_failed_db_writes, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void write_through(JournalOp op, const Contact *contact)
+{
+    if (!g_use_database)
+    {
+        return;
+    }
+    switch (op)
+    {
+    case JOURNAL_OP_ADD:
+        storage_save_contact_async(contact, NULL, count_failed_write, NULL);
+        break;
+    case JOURNAL_OP_EDIT:
+        storage_update_contact_async(contact, NULL, count_failed_write, NULL);
+        break;
+    default:
+        storage_delete_contact_async(contact->id, NULL, count_failed_write, NULL);
+        break;
+    }
+}
+
 // DONE
 void add_contact(void)
 {
     printf("\n=== ADD NEW CONTACT ===\n");
+    ensure_contacts_loaded(); // the new contact joins the whole list
 
     Contact new_contact;
     char name[MAX_NAME_LEN];
@@ -314,6 +406,9 @@ void add_contact(void)
         pause_program("\nPress Enter to return to menu...");
         return;
     }
+    contact_journal_append(JOURNAL_OP_ADD, &new_contact);
+    write_through(JOURNAL_OP_ADD, &new_contact);
+    contact_index_appended(&g_index, &contact_list, (uint32_t)contact_list.size - 1);
 
     printf("\nContact '%s' Added Successfully To Directory.", name);
     printf("\nCurrent Total Number of Contacts In Directory : %d\n", contact_list.size);
@@ -324,6 +419,7 @@ void list_contacts(void)
 {
     int choice;
     Contact *temp_contacts = NULL;
+    ensure_contacts_loaded();
     printf("\n=== ALL CONTACTS (%d) ===\n", contact_list.size);
     if (contact_list.size <= 0)
     {
@@ -374,12 +470,214 @@ void list_contacts(void)
     pause_program("\nPress Enter to return to menu...");
     return;
 }
+// The database answers searches only when it holds exactly what is in
+// contact_list: changes tracked, none unsaved and no save in flight
+static bool search_in_database(void)
+{
+    return g_use_database && contact_list.state != NULL &&
+           !contact_list_has_changes(&contact_list) && !contact_saver_busy();
+}
+
+static bool show_more(void)
+{
+    char more;
+    return get_char_prompt("\nShow More? (Y/N) : ", &more) && tolower(more) == 'y';
+}
+
+typedef ContactList *(*SearchPageFn)(const char *pattern, int after_id, int limit, int *next_id);
+
+// Prints a storage search one page at a time, in id order
+static void print_search_pages(SearchPageFn search, const char *field, const char *pattern)
+{
+    int shown = 0;
+    int after_id = 0;
+    do
+    {
+        int next_id = 0;
+        ContactList *page = search(pattern, after_id, SEARCH_PAGE_SIZE, &next_id);
+        if (page == NULL)
+        {
+            printf("Search error occurred. Returning To Main Menu\n");
+            return;
+        }
+        if (shown == 0 && page->size > 0)
+        {
+            printf("Contacts with %s : \'%s\':\n", field, pattern);
+        }
+        for (int i = 0; i < page->size; i++)
+        {
+            contact_print(&page->data[i]);
+        }
+        shown += page->size;
+        contact_list_free(page);
+        free(page);
+        after_id = next_id;
+    } while (after_id != 0 && show_more());
+
+    if (shown == 0)
+    {
+        printf("No such Contact with %s : %s exists within the directory.\n", field, pattern);
+        return;
+    }
+    printf("\nShown %d Contact(s)%s\n", shown, after_id != 0 ? ", more not shown" : "");
+}
+
+// Prints a whole storage search result (exact and ends-with phone lookups
+// are index searches with few hits) and frees it
+static void print_search_results(ContactList *found, const char *field, const char *pattern)
+{
+    if (found == NULL)
+    {
+        printf("Search error occurred. Returning To Main Menu\n");
+        return;
+    }
+    if (found->size == 0)
+    {
+        printf("No such Contact with %s : %s exists within the directory.\n", field, pattern);
+    }
+    else
+    {
+        printf("Found %d Contact(s)\n", found->size);
+        printf("Contacts with %s : \'%s\':\n", field, pattern);
+        for (int i = 0; i < found->size; i++)
+        {
+            contact_print(&found->data[i]);
+        }
+    }
+    contact_list_free(found);
+    free(found);
+}
+
+// Phone number equal to / ending in the digits of 'phone', on the list
+// through the query engine - the same digit rules as phone_rdigits
+static int find_phone_in_list(const char *phone, QueryOp op, int found_indices[])
+{
+    ContactQuery query;
+    contact_query_init(&query);
+    if (!contact_query_where(&query, QUERY_PHONE, op, phone))
+    {
+        return -1;
+    }
+    return contact_query_run_list(&query, &g_index, &contact_list, found_indices,
+                                  contact_list.size > 0 ? contact_list.size : 1, NULL);
+}
+
+// Name contains 'name' (any name if blank) and the e-mail domain is
+// 'domain', sorted by name. Runs as one query on the database, or on the
+// list through its index orders.
+static void search_name_and_domain(const char *name, const char *domain)
+{
+    ContactQuery query;
+    contact_query_init(&query);
+    if ((!is_whitespace(name) && !contact_query_where(&query, QUERY_NAME, QUERY_CONTAINS, name)) ||
+        !contact_query_where(&query, QUERY_DOMAIN, QUERY_EQUALS, domain))
+    {
+        printf("Search error occurred. Returning To Main Menu\n");
+        return;
+    }
+    contact_query_order_by(&query, INDEX_BY_NAME);
+    contact_query_limit(&query, SEARCH_PAGE_SIZE);
+
+    bool database = search_in_database();
+    int shown = 0;
+    QueryCursor next;
+    do
+    {
+        int found = 0;
+        int found_indices[SEARCH_PAGE_SIZE];
+        ContactList *page = NULL;
+        if (database)
+        {
+            page = storage_query(&query, &next);
+            found = page != NULL ? page->size : -1;
+        }
+        else
+        {
+            found = contact_query_run_list(&query, &g_index, &contact_list, found_indices, SEARCH_PAGE_SIZE, &next);
+        }
+        if (found < 0)
+        {
+            printf("Search error occurred. Returning To Main Menu\n");
+            return;
+        }
+
+        if (shown == 0 && found > 0)
+        {
+            printf("Contacts with E-mail Domain : \'%s\':\n", domain);
+        }
+        for (int i = 0; i < found; i++)
+        {
+            contact_print(database ? &page->data[i] : &contact_list.data[found_indices[i]]);
+        }
+        shown += found;
+        if (page != NULL)
+        {
+            contact_list_free(page);
+            free(page);
+        }
+        contact_query_after(&query, &next);
+    } while (next.valid && show_more());
+
+    if (shown == 0)
+    {
+        printf("No such Contact exists within the directory.\n");
+        return;
+    }
+    printf("\nShown %d Contact(s)%s\n", shown, next.valid ? ", more not shown" : "");
+}
+
+// Lazy mode: the id goes through contacts.dat.slots and one record is read
+static void search_lazy_id(int id)
+{
+    const Contact *found = contact_lazy_find_id(&g_lazy, id);
+    if (found == NULL)
+    {
+        printf("No such Contact with ID : %d exists within the directory.\n", id);
+        return;
+    }
+    printf("Found 1 Contact(s)\n");
+    printf("Contact with ID : \'%d\':\n", id);
+    contact_print(found);
+}
+
+// Lazy mode: names are matched on the in-memory index, only hits are read
+static void search_lazy_name(const char *name)
+{
+    uint32_t count = contact_lazy_count(&g_lazy);
+    uint32_t *positions = malloc((count > 0 ? count : 1) * sizeof(uint32_t));
+    if (positions == NULL)
+    {
+        printf("Search error occurred. Returning To Main Menu\n");
+        return;
+    }
+
+    int result = contact_lazy_find_by_name(&g_lazy, name, positions, (int)count);
+    if (result <= 0)
+    {
+        printf("No such Contact with Name : %s exists within the directory.\n", name);
+        free(positions);
+        return;
+    }
+
+    printf("Found %d Contact(s)\n", result);
+    printf("Contacts with Name : \'%s\'\n", name);
+    for (int i = 0; i < result; i++)
+    {
+        const Contact *contact = contact_lazy_get(&g_lazy, positions[i]);
+        if (contact != NULL)
+        {
+            contact_print(contact);
+        }
+    }
+    free(positions);
+}
+
 // DONE
 void search_contacts(void)
 {
     printf("\n=== SEARCH CONTACTS ===\n");
 
-    if (contact_list.size == 0)
+    if (contact_list.size == 0 && contact_lazy_count(&g_lazy) == 0)
     {
         printf("No contacts to search.\n");
         pause_program("\nPress Enter to return to menu..."); // Since VLAs with len = 0 are legal but good to avoid to avoid segfaults
@@ -388,17 +686,23 @@ void search_contacts(void)
 
     int choice;
     int result; // Not single int for readability //
-    int found_indices[contact_list.size];
     int found_index; // Learnt the hard way that total number != index
 
     // FIXED: Clearer prompt without show_search_menu()
-    if (!get_int_range_prompt("\n1 - Search By ID\n2 - Search By Name\n3 - Search By Phone\n4 - Search By E-mail\n5 - Quit\nEnter Choice: ", 1, 5, &choice))
+    if (!get_int_range_prompt("\n1 - Search By ID\n2 - Search By Name\n3 - Search By Phone\n4 - Search By E-mail\n5 - Search By Name And E-mail Domain\n6 - Quit\nEnter Choice: ", 1, 6, &choice))
     {
         printf("Invalid Choice Has Been Entered. Returning to Main Menu.\n");
         pause_program(NULL);
         return;
     }
 
+    // A lazily opened file answers id and name searches itself
+    if (choice >= 3 && choice <= 5)
+    {
+        ensure_contacts_loaded();
+    }
+    int found_indices[contact_list.size > 0 ? contact_list.size : 1];
+
     switch (choice)
     {
     case 1: // Search by id
@@ -411,7 +715,13 @@ void search_contacts(void)
             return;
         }
 
-        found_index = contact_find_by_id_in_list(&contact_list, id);
+        if (g_lazy_open)
+        {
+            search_lazy_id(id);
+            break;
+        }
+
+        found_index = contact_index_find_id(&g_index, &contact_list, id);
         if (found_index == -1)
         {
             printf("No such Contact with ID : %d exists within the directory.\n", id);
@@ -434,6 +744,17 @@ void search_contacts(void)
             return;
         }
 
+        if (search_in_database())
+        {
+            print_search_pages(storage_search_by_name_page, "Name", name);
+            break;
+        }
+        if (g_lazy_open)
+        {
+            search_lazy_name(name);
+            break;
+        }
+
         result = contact_find_by_name_in_list(&contact_list, name, found_indices); // CHANGED: found_count → found_indices
 
         // FIXED: Check for 0 results, not -1 (unless -1 means error in your implementation)
@@ -460,14 +781,39 @@ void search_contacts(void)
     case 3: // Search by phone
     {
         char phone[MAX_PHONE_LEN];
+        char digits[20];
+        int match;
         if (!get_string_prompt("Enter Phone : ", phone, sizeof(phone)) || is_whitespace(phone))
         {
             printf("Invalid Phone Has Been Entered. Returning To Main Menu.\n");
             pause_program(NULL);
             return;
         }
+        extract_digits(digits, phone);
+        if (!get_int_range_prompt("1 - Contains\n2 - Exact Number\n3 - Ends With\nEnter Match : ", 1, 3, &match) ||
+            (match != 1 && digits[0] == '\0'))
+        {
+            printf("Invalid Match Has Been Entered. Returning To Main Menu.\n");
+            pause_program(NULL);
+            return;
+        }
+
+        // Exact and ends-with are lookups on the reversed-digit index
+        if (search_in_database())
+        {
+            if (match == 1)
+                print_search_pages(storage_search_by_phone_page, "Phone", phone);
+            else if (match == 2)
+                print_search_results(storage_find_by_phone(phone), "Phone Number", phone);
+            else
+                print_search_results(storage_search_by_phone_suffix(phone), "Phone Ending", phone);
+            break;
+        }
 
-        result = contact_find_by_phone_in_list(&contact_list, phone, found_indices); // CHANGED: found_count → found_indices
+        if (match == 1)
+            result = contact_find_by_phone_in_list(&contact_list, phone, found_indices); // CHANGED: found_count → found_indices
+        else
+            result = find_phone_in_list(phone, match == 2 ? QUERY_EQUALS : QUERY_SUFFIX, found_indices);
 
         // FIXED: Same logic as name search
         if (result == 0)
@@ -500,6 +846,12 @@ void search_contacts(void)
             return;
         }
 
+        if (search_in_database())
+        {
+            print_search_pages(storage_search_by_email_page, "E-mail", email);
+            break;
+        }
+
         result = contact_find_by_email_in_list(&contact_list, email, found_indices); // CHANGED: found_count → found_indices
 
         // FIXED: Same logic
@@ -523,7 +875,23 @@ void search_contacts(void)
         break;
     }
 
-    case 5: // Quit
+    case 5: // Search by name and e-mail domain
+    {
+        char name[MAX_NAME_LEN];
+        char domain[MAX_EMAIL_LEN];
+        if (!get_string_prompt("Enter Name (blank for any) : ", name, sizeof(name)) ||
+            !get_string_prompt("Enter E-mail Domain : ", domain, sizeof(domain)) || is_whitespace(domain))
+        {
+            printf("Invalid Search Has Been Entered. Returning To Main Menu.\n");
+            pause_program(NULL);
+            return;
+        }
+
+        search_name_and_domain(name, domain);
+        break;
+    }
+
+    case 6: // Quit
         printf("Returning to main menu...\n");
         return;
     }
@@ -534,6 +902,7 @@ void search_contacts(void)
 void delete_contact(void)
 {
     printf("\n=== DELETE CONTACT ===\n"); // Not show all Contacts Because It's Too Much
+    ensure_contacts_loaded();
     if (contact_list.size == 0)
     {
         printf("No contacts to delete.\n");
@@ -549,7 +918,7 @@ void delete_contact(void)
         return;
     }
 
-    int index = contact_find_by_id_in_list(&contact_list, id_to_delete);
+    int index = contact_index_find_id(&g_index, &contact_list, id_to_delete);
     if (index == -1)
     {
         printf("Contact with ID %d not found.\n", id_to_delete);
@@ -572,12 +941,16 @@ void delete_contact(void)
 
     if (tolower(choice) == 'y')
     {
+        Contact removed = contact_list.data[index]; // Copy before the shift overwrites it
         if (!contact_list_remove_by_index(&contact_list, index))
         {
             printf("Failure To Execute. Directory Is Being Left Unchanged.\nReturning To Main Menu.\n");
             pause_program(NULL);
             return;
         }
+        contact_journal_append(JOURNAL_OP_DELETE, &removed);
+        write_through(JOURNAL_OP_DELETE, &removed);
+        contact_index_removed(&g_index, &contact_list, (uint32_t)index);
         printf("Contact Deletion Executed Successfully.\nTotal Contacts Remaining In Directory : %d\n", contact_list.size);
     }
     else if (tolower(choice) == 'n')
@@ -598,6 +971,7 @@ void delete_contact(void)
 void edit_contact(void)
 {
     printf("\n=== EDIT CONTACT ===\n");
+    ensure_contacts_loaded();
     if (contact_list.size == 0)
     {
         printf("No contacts to edit.\n");
@@ -613,7 +987,7 @@ void edit_contact(void)
         return;
     }
 
-    int index = contact_find_by_id_in_list(&contact_list, id_to_find);
+    int index = contact_index_find_id(&g_index, &contact_list, id_to_find);
     if (index == -1)
     {
         printf("Contact with ID %d not found.\n", id_to_find);
@@ -659,6 +1033,10 @@ void edit_contact(void)
                 // Update
                 strncpy(contact_list.data[index].name, new_name, MAX_NAME_LEN - 1);
                 contact_list.data[index].name[MAX_NAME_LEN - 1] = '\0';
+                contact_list_mark_dirty(&contact_list, index);
+                contact_journal_append(JOURNAL_OP_EDIT, &contact_list.data[index]);
+                write_through(JOURNAL_OP_EDIT, &contact_list.data[index]);
+                contact_index_edited(&g_index, &contact_list, (uint32_t)index, INDEX_BY_NAME);
 
                 // Show results
                 printf("\nContact Updated Successfully. (Field Updated : Name)\n");
@@ -681,6 +1059,10 @@ void edit_contact(void)
                 // Update
                 strncpy(contact_list.data[index].phone, new_phone, MAX_PHONE_LEN - 1);
                 contact_list.data[index].phone[MAX_PHONE_LEN - 1] = '\0';
+                contact_list_mark_dirty(&contact_list, index);
+                contact_journal_append(JOURNAL_OP_EDIT, &contact_list.data[index]);
+                write_through(JOURNAL_OP_EDIT, &contact_list.data[index]);
+                contact_index_edited(&g_index, &contact_list, (uint32_t)index, INDEX_BY_PHONE);
 
                 // Show results
                 printf("\nContact Updated Successfully. (Field Updated : Phone)\n");
@@ -703,6 +1085,10 @@ void edit_contact(void)
                 // Update
                 strncpy(contact_list.data[index].email, new_email, MAX_EMAIL_LEN - 1);
                 contact_list.data[index].email[MAX_EMAIL_LEN - 1] = '\0';
+                contact_list_mark_dirty(&contact_list, index);
+                contact_journal_append(JOURNAL_OP_EDIT, &contact_list.data[index]);
+                write_through(JOURNAL_OP_EDIT, &contact_list.data[index]);
+                contact_index_edited(&g_index, &contact_list, (uint32_t)index, INDEX_BY_EMAIL);
 
                 // Show results
                 printf("\nContact Updated Successfully. (Field Updated : Email)\n");
@@ -733,6 +1119,108 @@ void edit_contact(void)
     return;
 }
 
+// Maps a columnar export and reads its email column only
+static void count_email_domain(const char *path)
+{
+    char domain[MAX_EMAIL_LEN];
+    if (!get_string_prompt("Email Domain (e.g. example.com) : ", domain, sizeof(domain)) || is_whitespace(domain))
+    {
+        printf("Invalid Domain Has Been Entered.\n");
+        return;
+    }
+
+    const char *bare = (domain[0] == '@') ? domain + 1 : domain;
+
+    ColumnarSnapshot snapshot;
+    if (!contact_columnar_open(&snapshot, path))
+    {
+        return;
+    }
+    int total = (int)snapshot.header->contact_count;
+    int matches = contact_columnar_count_domain(&snapshot, bare);
+    contact_columnar_close(&snapshot);
+
+    if (matches < 0)
+        printf("\nEmail Column Of '%s' Is Corrupted.\n", path);
+    else
+        printf("\n%d of %d Contact(s) In '%s' Use @%s\n", matches, total, path, bare);
+}
+
+void import_export_contacts(void)
+{
+    printf("\n=== IMPORT / EXPORT ===\n");
+    ensure_contacts_loaded();
+
+    int choice;
+    if (!get_int_range_prompt("\n1 - Import From CSV/TSV/vCard\n2 - Export To CSV/TSV/vCard/Columnar\n3 - Count Email Domain In A Columnar Export\n4 - Quit\nEnter Choice: ", 1, 4, &choice))
+    {
+        printf("Invalid Choice Has Been Entered. Returning to Main Menu.\n");
+        pause_program(NULL);
+        return;
+    }
+    if (choice == 4)
+    {
+        return;
+    }
+
+    char path[260];
+    if (!get_string_prompt("File Name (.csv, .tsv, .vcf or .col) : ", path, sizeof(path)) || is_whitespace(path))
+    {
+        printf("Invalid File Name Has Been Entered. Returning to Main Menu.\n");
+        pause_program(NULL);
+        return;
+    }
+
+    bool vcard = contact_vcard_is_vcf(path);
+    bool columnar = contact_columnar_is_col(path);
+    CsvOptions options = contact_csv_options_for(path);
+    CsvStats stats;
+    if (choice == 3)
+    {
+        count_email_domain(path);
+    }
+    else if (choice == 1 && columnar)
+    {
+        printf("\nColumnar Files Can Only Be Exported. Import Cancelled.\n");
+    }
+    else if (choice == 1)
+    {
+        int before = contact_list.size;
+        bool ok = vcard ? contact_vcard_import(path, contact_csv_to_list, &contact_list, &stats)
+                        : contact_csv_import(path, &options, contact_csv_to_list, &contact_list, &stats);
+        printf("\nImported %ld of %ld Record(s) (%ld Skipped) in %.2f s",
+               stats.imported, stats.rows, stats.rejected, stats.seconds);
+        if (stats.seconds > 0)
+            printf(" - %.2f Million Records/s", stats.rows / stats.seconds / 1e6);
+        printf("\n");
+        if (!ok)
+            printf("Import Stopped Early. Rows Before The Error Were Kept.\n");
+
+        if (contact_list.size > before)
+        {
+            contact_index_appended(&g_index, &contact_list, (uint32_t)before);
+
+            // Imported rows bypass the journal, so persist them right away
+            if (contact_saver_request(&contact_list, g_use_database))
+                printf("Saving %d contacts in the background...\n", contact_list.size);
+            else if (save_contacts_now())
+                printf("Contacts saved successfully.\n");
+        }
+    }
+    else if (columnar)
+    {
+        contact_columnar_save(&contact_list, path);
+    }
+    else if (vcard ? contact_vcard_export(path, &contact_list, 3, &stats)
+                   : contact_csv_export(path, &contact_list, &options, &stats))
+    {
+        printf("\nExported %ld Contact(s) To '%s' (%lld bytes) in %.2f s\n",
+               stats.imported, path, stats.bytes, stats.seconds);
+    }
+
+    pause_program("\nPress Enter to return to menu...");
+}
+
 void clear_screen(void)
 {
 #ifdef _WIN32
@@ -745,6 +1233,141 @@ void clear_screen(void)
 #endif
 }
 
+bool load_legacy_contacts(void)
+{
+    contact_lazy_close(&g_lazy);
+    g_lazy_open = false;
+
+    // Nothing to replay and no database to fill: open contacts.dat lazily,
+    // ensure_contacts_loaded() reads the rest once something needs it
+    if (!g_use_database && contact_journal_is_empty() &&
+        contact_file_validate(BACKUP_PRIMARY_FILE) &&
+        contact_lazy_open(&g_lazy, BACKUP_PRIMARY_FILE))
+    {
+        g_lazy_open = true;
+        next_contact_id = (int)contact_lazy_next_id(&g_lazy);
+        printf("Opened %u contacts from %s (records are read on demand)\n",
+               contact_lazy_count(&g_lazy), BACKUP_PRIMARY_FILE);
+        return true;
+    }
+    return load_legacy_snapshot();
+}
+
+// Newest loadable generation plus the journal, straight into contact_list
+bool load_legacy_snapshot(void)
+{
+    bool loaded = contact_file_load_backup(&contact_list);
+
+    // Bring the snapshot up to date with edits made since the last save
+    // (a journal without any snapshot is replayed onto an empty list)
+    int replayed = contact_journal_replay(&contact_list);
+
+    // Untouched snapshot: its saved search orders can be mapped as they are
+    contact_index_close(&g_index);
+    if (loaded && replayed == 0)
+    {
+        contact_index_open(&g_index, BACKUP_PRIMARY_FILE, &contact_list);
+    }
+    return loaded || replayed > 0;
+}
+
+// Leaves lazy mode: adds, edits, listing, saves and the other searches
+// work on the whole list
+bool ensure_contacts_loaded(void)
+{
+    if (!g_lazy_open)
+    {
+        return true;
+    }
+
+    contact_lazy_close(&g_lazy);
+    g_lazy_open = false;
+    if (!load_legacy_snapshot())
+    {
+        printf("Could not load the contacts from %s.\n", BACKUP_PRIMARY_FILE);
+        return false;
+    }
+    return true;
+}
+
+bool load_database_contacts(void)
+{
+    int count = storage_load_all(&contact_list);
+    if (count < 0)
+    {
+        printf("Failed to load from database.\n");
+        return false;
+    }
+    printf("Loaded %d contacts from database.\n", count);
+    contact_list_track_changes(&contact_list); // saves write only what changes from here
+
+    // Edits journaled before a crash never reached the database: replayed
+    // as tracked changes, the next save writes them
+    int replayed = contact_journal_replay(&contact_list);
+    if (replayed > 0)
+    {
+        contact_index_invalidate(&g_index);
+    }
+    return true;
+}
+
+static void print_save_progress(int done, int total, void *ctx)
+{
+    (void)ctx;
+    printf("\rDatabase: %d / %d contacts saved", done, total);
+    if (done == total)
+        printf("\n");
+    fflush(stdout);
+}
+
+// Foreground save: the database (if active), then the legacy file
+bool save_contacts_now(void)
+{
+    bool db_ok = true; // assume ok if not using database
+    if (g_use_database)
+    {
+        // Only what changed since the last sync (everything the first time)
+        int saved = storage_sync(&contact_list, print_save_progress, NULL);
+        db_ok = (saved >= 0);
+    }
+
+    // Always save to legacy backup. The journal is folded in and emptied
+    // only once the database holds its entries too.
+    bool legacy_ok = db_ok ? contact_journal_compact(&contact_list, !g_use_database)
+                           : contact_file_save_backup(&contact_list);
+
+    if (!legacy_ok)
+        printf("Failed to save to legacy file.\n");
+    if (!db_ok)
+        printf("Failed to save to database.\n");
+    return legacy_ok && db_ok;
+}
+
+void report_background_saves(void)
+{
+    SaveStatus status;
+    while (contact_saver_poll(&status))
+    {
+        if (status.legacy_ok && (!status.used_database || status.db_ok))
+        {
+            printf("Background save finished: %d contacts (%.0f s).\n",
+                   status.contact_count, status.seconds);
+            continue;
+        }
+
+        if (!status.legacy_ok)
+            printf("Background save FAILED for the legacy file - your changes are still in the journal.\n");
+        if (status.used_database && !status.db_ok)
+            printf("Background save FAILED for the database.\n");
+    }
+
+    int failed = __atomic_exchange_n(&g_failed_db_writes, 0, __ATOMIC_RELAXED);
+    if (failed > 0)
+    {
+        printf("%d database write(s) FAILED - the next save writes them again.\n", failed);
+    }
+}
+
 void display_search_results(const Contact contacts[], const int indices[], int count)
 {
     if (count == 0)
@@ -777,5 +1400,6 @@ void show_menu(void)
     printf("6. Save to File\n");
     printf("7. Load from File\n");
     printf("8. Clear Screen\n");
-    printf("9. Exit\n");
+    printf("9. Import / Export (CSV, vCard)\n");
+    printf("10. Exit\n");
 }
@@ -0,0 +1,173 @@
+// Delta backup chain: save -> load round trips for every generation, a
+// single flipped byte in a full or delta generation, and the generation an
+// in-place patch pushes.
+// Run from an empty directory - it writes contacts.dat and its backups.
+
+#include "../contact_file.h"
+#include "../contact_index.h"
+#include "../contact_reader.h"
+#include "test_util.h"
+
+#define SAVES 15
+
+// Save k: ids 1..k+3 minus every fifth, contact 2 renamed each time
+static void build_save(ContactList *list, int k)
+{
+    contact_list_init(list, k + 4);
+    for (int id = 1; id <= k + 3; id++)
+    {
+        if (id % 5 == 0 && id != k + 3)
+        {
+            continue;
+        }
+        char name[MAX_NAME_LEN];
+        char phone[MAX_PHONE_LEN];
+        char email[MAX_EMAIL_LEN];
+        if (id == 2)
+            snprintf(name, sizeof(name), "Renamed %d", k);
+        else
+            snprintf(name, sizeof(name), "Contact %d", id);
+        snprintf(phone, sizeof(phone), "555%04d", id);
+        snprintf(email, sizeof(email), "c%d@example.com", id);
+        Contact contact = test_contact(id, name, phone, email);
+        contact_list_add(list, &contact);
+    }
+}
+
+static void generation_name(char *buffer, size_t size, int generation)
+{
+    if (generation == 0)
+        snprintf(buffer, size, "%s", BACKUP_PRIMARY_FILE);
+    else
+        snprintf(buffer, size, "%s.bak%d", BACKUP_PRIMARY_FILE, generation);
+}
+
+static bool is_full(int generation)
+{
+    char filename[64];
+    uint32_t magic = 0;
+    generation_name(filename, sizeof(filename), generation);
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool read = fread(&magic, sizeof(magic), 1, file) == 1;
+    fclose(file);
+    return read && magic == FILE_MAGIC_LRBT;
+}
+
+// Flips one byte of the last record (just before the footer)
+static void corrupt(int generation)
+{
+    char filename[64];
+    generation_name(filename, sizeof(filename), generation);
+    CHECK(flip_byte(filename, -(long)(sizeof(uint32_t) + sizeof(time_t)) - 7, SEEK_END, 0x20));
+}
+
+static void remove_all(void)
+{
+    char filename[64];
+    for (int generation = 0; generation <= BACKUP_GENERATIONS; generation++)
+    {
+        generation_name(filename, sizeof(filename), generation);
+        remove(filename);
+    }
+    remove(BACKUP_NEXT_DELTA_FILE);
+    remove(BACKUP_PRIMARY_FILE SLOTS_SUFFIX);
+    remove("contacts" INDEX_SUFFIX);
+}
+
+static bool loads_as(int generation, const ContactList *expected)
+{
+    ContactList loaded = {0};
+    bool ok = contact_file_load_generation(&loaded, generation) &&
+              same_contacts(&loaded, expected);
+    contact_list_free(&loaded);
+    return ok;
+}
+
+// Generation g holds save SAVES - 1 - g
+static bool generation_is(int generation, const ContactList saves[])
+{
+    return loads_as(generation, &saves[SAVES - 1 - generation]);
+}
+
+int main(void)
+{
+    ContactList saves[SAVES];
+
+    remove_all();
+    for (int k = 0; k < SAVES; k++)
+    {
+        build_save(&saves[k], k);
+        CHECK(contact_file_save_backup_snapshot(&saves[k], (uint32_t)(k + 4), false));
+    }
+
+    // === Round trip: every generation rebuilds its save ===
+    for (int generation = 0; generation < SAVES; generation++)
+    {
+        CHECK(generation_is(generation, saves));
+    }
+
+    // .bak1 is whole, and so is a keyframe no more than
+    // BACKUP_KEYFRAME_INTERVAL generations further up
+    int keyframe = 2;
+    while (keyframe < SAVES && !is_full(keyframe))
+    {
+        keyframe++;
+    }
+    CHECK(is_full(0));
+    CHECK(is_full(1));
+    CHECK(keyframe < SAVES && keyframe <= 1 + BACKUP_KEYFRAME_INTERVAL);
+
+    // === One flipped byte in a delta: that generation and the ones after
+    // it on the same chain are lost, newer ones still load ===
+    corrupt(3);
+    CHECK(generation_is(2, saves));
+    CHECK(!generation_is(3, saves));
+    CHECK(!generation_is(4, saves));
+
+    // === One flipped byte in contacts.dat and .bak1: loading falls back
+    // to the keyframe, which needs no newer generation ===
+    corrupt(0);
+    corrupt(1);
+    CHECK(!generation_is(0, saves));
+    CHECK(!generation_is(1, saves));
+    CHECK(generation_is(keyframe, saves));
+
+    ContactList recovered = {0};
+    CHECK(contact_file_load_backup(&recovered));
+    CHECK(same_contacts(&recovered, &saves[SAVES - 1 - keyframe]));
+    contact_list_free(&recovered);
+
+    // === An in-place patch pushes the unpatched file as a delta .bak1
+    // (the old .bak1 becomes the delta its save left), and the next full
+    // save keeps both in the chain ===
+    remove_all();
+    CHECK(contact_file_save_backup_snapshot(&saves[0], 4, false));
+    CHECK(contact_file_save_backup_snapshot(&saves[1], 5, false));
+    ContactList patched = {0};
+    build_save(&patched, 1);
+    snprintf(patched.data[2].name, MAX_NAME_LEN, "Patched");
+    int patched_id = patched.data[2].id;
+    CHECK(contact_file_update_records(BACKUP_PRIMARY_FILE, &patched, &patched_id, 1, false));
+    CHECK(!is_full(1) && !is_full(2) && is_full(0));
+    CHECK(loads_as(0, &patched));
+    CHECK(loads_as(1, &saves[1]));
+    CHECK(loads_as(2, &saves[0]));
+
+    CHECK(contact_file_save_backup_snapshot(&saves[2], 6, false));
+    CHECK(loads_as(0, &saves[2]));
+    CHECK(loads_as(1, &patched));
+    CHECK(loads_as(2, &saves[1]));
+    CHECK(loads_as(3, &saves[0]));
+    contact_list_free(&patched);
+
+    for (int k = 0; k < SAVES; k++)
+    {
+        contact_list_free(&saves[k]);
+    }
+    remove_all();
+    return test_report();
+}
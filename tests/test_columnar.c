@@ -0,0 +1,92 @@
+// Columnar snapshot: save -> load round trip, and a single flipped byte in
+// a column body and in the header.
+// Run from an empty directory - it writes test.col.
+
+#include "../contact_columnar.h"
+#include "../contact_file.h"
+#include "test_util.h"
+#include <ctype.h>
+#include <stddef.h>
+
+#define TEST_FILE "test.col"
+#define CONTACTS 500
+
+// Contacts whose e-mail domain is 'domain', ignoring ASCII case
+static int count_domain(const ContactList *list, const char *domain)
+{
+    int count = 0;
+    for (int i = 0; i < list->size; i++)
+    {
+        const char *at = strchr(list->data[i].email, '@');
+        if (at == NULL || strlen(at + 1) != strlen(domain))
+            continue;
+        int j = 0;
+        while (domain[j] != '\0' && tolower((unsigned char)at[1 + j]) == tolower((unsigned char)domain[j]))
+            j++;
+        count += domain[j] == '\0';
+    }
+    return count;
+}
+
+// File offset of the body of column 'tag'
+static long column_offset(ColumnTag tag)
+{
+    ColumnarSnapshot snapshot;
+    long offset = -1;
+    if (contact_columnar_open(&snapshot, TEST_FILE))
+    {
+        for (uint32_t i = 0; i < snapshot.header->column_count; i++)
+        {
+            if (snapshot.directory[i].tag == (uint32_t)tag)
+                offset = (long)snapshot.directory[i].offset;
+        }
+        contact_columnar_close(&snapshot);
+    }
+    return offset;
+}
+
+int main(void)
+{
+    ContactList list;
+    ContactList loaded = {0};
+    ColumnarSnapshot snapshot;
+    test_build_list(&list, CONTACTS);
+    int example_com = count_domain(&list, "example.com");
+    CHECK(example_com > 0);
+
+    // === Round trip ===
+    CHECK(contact_columnar_save(&list, TEST_FILE));
+    CHECK(contact_columnar_load(&loaded, TEST_FILE));
+    CHECK(same_contacts(&loaded, &list));
+    contact_list_free(&loaded);
+
+    CHECK(contact_columnar_open(&snapshot, TEST_FILE));
+    CHECK(contact_columnar_count_domain(&snapshot, "example.COM") == example_com);
+    contact_columnar_close(&snapshot);
+
+    // === One flipped byte in the phone column: loading fails, columns
+    // that were not touched still scan ===
+    long phones = column_offset(COLUMN_PHONE);
+    CHECK(phones > 0);
+    CHECK(flip_byte(TEST_FILE, phones + (long)(list.size + 1) * (long)sizeof(uint32_t) + 5, SEEK_SET, 0x01));
+
+    CHECK(!contact_columnar_load(&loaded, TEST_FILE));
+    CHECK(loaded.size == 0);
+    contact_list_free(&loaded);
+
+    ColumnView view;
+    CHECK(contact_columnar_open(&snapshot, TEST_FILE));
+    CHECK(!contact_columnar_column(&snapshot, COLUMN_PHONE, &view));
+    CHECK(contact_columnar_count_domain(&snapshot, "example.com") == example_com);
+    contact_columnar_close(&snapshot);
+
+    // === One flipped byte in the header: the file does not open ===
+    CHECK(contact_columnar_save(&list, TEST_FILE));
+    CHECK(flip_byte(TEST_FILE, (long)offsetof(ColumnarHeader, contact_count), SEEK_SET, 0x01));
+    CHECK(!contact_columnar_open(&snapshot, TEST_FILE));
+    CHECK(!contact_columnar_load(&loaded, TEST_FILE));
+
+    contact_list_free(&list);
+    remove(TEST_FILE);
+    return test_report();
+}
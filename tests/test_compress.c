@@ -0,0 +1,101 @@
+// Compressed (version 2) snapshots and the LZ block codec: round trips,
+// and single flipped bytes in the payload and in a saved file.
+// Run from an empty directory - it writes test.dat and its test.idx.
+
+#include "../contact_compress.h"
+#include "../contact_file.h"
+#include "../contact_index.h"
+#include "test_util.h"
+
+#define TEST_FILE "test.dat"
+#define CONTACTS 20000 // model well past one COMPRESS_BLOCK_SIZE block
+
+static void test_lz(void)
+{
+    uint32_t size = 3 * COMPRESS_BLOCK_SIZE / 2;
+    uint8_t *in = malloc(size);
+    uint8_t *packed = malloc(size);
+    uint8_t *out = malloc(size);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        in[i] = (uint8_t)("contact manager "[i % 16] + (i / 4096) % 3);
+    }
+
+    uint32_t packed_size = contact_lz_compress(in, size, packed);
+    CHECK(packed_size > 0 && packed_size < size / 4);
+    CHECK(contact_lz_decompress(packed, packed_size, out, size));
+    CHECK(memcmp(in, out, size) == 0);
+
+    // Random bytes do not shrink and are reported as such
+    srand(1);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        in[i] = (uint8_t)rand();
+    }
+    CHECK(contact_lz_compress(in, size, packed) == 0);
+
+    free(in);
+    free(packed);
+    free(out);
+}
+
+static void test_payload(const ContactList *list)
+{
+    uint8_t *payload = NULL;
+    uint32_t size = 0;
+    ContactList decoded;
+    contact_list_init(&decoded, list->size);
+
+    CHECK(contact_compress_encode(list, &payload, &size));
+    CHECK(contact_compress_decode(payload, size, (uint32_t)list->size, &decoded));
+    CHECK(same_contacts(&decoded, list));
+
+    // One flipped byte anywhere - sizes, block headers or data - must be caught
+    for (uint32_t position = 0; position < size; position += size / 64 + 1)
+    {
+        payload[position] ^= 0x10;
+        decoded.size = 0;
+        bool accepted = contact_compress_decode(payload, size, (uint32_t)list->size, &decoded);
+        payload[position] ^= 0x10;
+        if (accepted)
+        {
+            printf("FAIL: flipped byte %u of %u was accepted\n", position, size);
+            failures++;
+            break;
+        }
+    }
+
+    free(payload);
+    contact_list_free(&decoded);
+}
+
+static void test_file(const ContactList *list)
+{
+    ContactList loaded = {0};
+
+    CHECK(contact_file_save_compressed(list, TEST_FILE));
+    CHECK(contact_file_load(&loaded, TEST_FILE));
+    CHECK(same_contacts(&loaded, list));
+
+    // One flipped byte in the middle of the compressed body
+    long body = file_size(TEST_FILE) - (long)sizeof(ContactFileHeader);
+    CHECK(flip_byte(TEST_FILE, (long)sizeof(ContactFileHeader) + body / 2, SEEK_SET, 0x04));
+    CHECK(!contact_file_load(&loaded, TEST_FILE));
+
+    contact_list_free(&loaded);
+    remove(TEST_FILE);
+    remove("test" INDEX_SUFFIX);
+}
+
+int main(void)
+{
+    ContactList list;
+    test_build_list(&list, CONTACTS);
+
+    test_lz();
+    test_payload(&list);
+    test_file(&list);
+
+    contact_list_free(&list);
+    return test_report();
+}
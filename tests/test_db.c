@@ -0,0 +1,128 @@
+// Database sync and refresh: syncs write only the change set, and a
+// refresh brings in exactly what another connection wrote - not the rows
+// this process synced or queued itself. Queued writes as the menu makes
+// them, and a shutdown that commits the queue and then refuses writes.
+// Run from an empty directory - it writes contacts.db.
+
+#include "../contact_db.h"
+#include "../contact_storage.h"
+#include "test_util.h"
+
+#define COUNT 200
+
+static void remove_all(void)
+{
+    remove(DB_FILENAME);
+    remove(DB_FILENAME "-wal");
+    remove(DB_FILENAME "-shm");
+}
+
+static const Contact *by_id(const ContactList *list, int id)
+{
+    int index = contact_find_by_id_in_list(list, id);
+    return index >= 0 ? &list->data[index] : NULL;
+}
+
+int main(void)
+{
+    ContactList list;
+    ContactList loaded;
+    sqlite3 *other = NULL;
+    remove_all();
+    CHECK(storage_init(NULL) == 0);
+    test_build_list(&list, COUNT);
+
+    // === First sync of an untracked list: everything, then tracked ===
+    CHECK(storage_sync(&list, NULL, NULL) == list.size);
+    CHECK(list.state != NULL && !contact_list_has_changes(&list));
+    CHECK(storage_refresh(&list) == 0);
+
+    // === Edits, an add and a delete: only those are written ===
+    snprintf(list.data[3].name, MAX_NAME_LEN, "Synced Here");
+    contact_list_mark_dirty(&list, 3);
+    CHECK(contact_list_add(&list, &(Contact){.id = COUNT * 3 + 2, .name = "Added Here"}));
+    int removed_id = list.data[7].id;
+    CHECK(contact_list_remove_by_index(&list, 7));
+    CHECK(storage_sync(&list, NULL, NULL) == 3);
+    CHECK(!contact_list_has_changes(&list));
+    CHECK(storage_refresh(&list) == 0);
+
+    // === Another connection writes: the refresh counts its rows only,
+    // not the ones synced above ===
+    CHECK(db_open(&other, NULL) == SQLITE_OK);
+    Contact theirs = list.data[10];
+    snprintf(theirs.email, MAX_EMAIL_LEN, "elsewhere@example.com");
+    int their_delete = list.data[20].id;
+    CHECK(db_sync(other, &theirs, 1, &their_delete, 1, NULL) == 2);
+    CHECK(storage_refresh(&list) == 2);
+    CHECK(by_id(&list, theirs.id) != NULL && strcmp(by_id(&list, theirs.id)->email, theirs.email) == 0);
+    CHECK(by_id(&list, their_delete) == NULL && by_id(&list, removed_id) == NULL);
+    CHECK(!contact_list_has_changes(&list));
+    CHECK(storage_refresh(&list) == 0);
+
+    // === Our sync after theirs, then theirs again: still only theirs ===
+    snprintf(list.data[30].phone, MAX_PHONE_LEN, "5550000");
+    contact_list_mark_dirty(&list, 30);
+    CHECK(storage_sync(&list, NULL, NULL) == 1);
+    theirs = list.data[40];
+    snprintf(theirs.name, MAX_NAME_LEN, "Renamed Elsewhere");
+    CHECK(db_sync(other, &theirs, 1, NULL, 0, NULL) == 1);
+    CHECK(storage_refresh(&list) == 1);
+    CHECK(strcmp(by_id(&list, theirs.id)->name, theirs.name) == 0);
+    db_close(other);
+
+    // === Queued writes beside the change set, as the menu makes them: a
+    // save keeps its id (new or existing), and the refresh after the sync
+    // counts none of them ===
+    StorageFuture added, saved_over, updated, deleted;
+    Contact fresh = {.id = COUNT * 3 + 5, .name = "Queued Add", .phone = "5551234", .email = "queued@example.com"};
+    CHECK(contact_list_add(&list, &fresh));
+    CHECK(storage_save_contact_async(&fresh, &added, NULL, NULL) == 0);
+    snprintf(list.data[70].name, MAX_NAME_LEN, "Saved Over"); // some built emails do not validate
+    snprintf(list.data[70].email, MAX_EMAIL_LEN, "saved.over@example.com");
+    contact_list_mark_dirty(&list, 70);
+    CHECK(storage_save_contact_async(&list.data[70], &saved_over, NULL, NULL) == 0);
+    snprintf(list.data[50].name, MAX_NAME_LEN, "Queued Edit");
+    contact_list_mark_dirty(&list, 50);
+    CHECK(storage_update_contact_async(&list.data[50], &updated, NULL, NULL) == 0);
+    int queued_delete = list.data[60].id;
+    CHECK(contact_list_remove_by_index(&list, 60));
+    CHECK(storage_delete_contact_async(queued_delete, &deleted, NULL, NULL) == 0);
+    CHECK(storage_future_wait(&added) == 0 && storage_future_wait(&saved_over) == 0);
+    CHECK(storage_future_wait(&updated) == 0 && storage_future_wait(&deleted) == 0);
+    CHECK(storage_sync(&list, NULL, NULL) == 4);
+    CHECK(storage_refresh(&list) == 0);
+
+    // === The list matches the table (loading also moves the mark) ===
+    contact_list_init(&loaded, COUNT);
+    CHECK(storage_load_all(&loaded) == list.size);
+    CHECK(same_contacts(&loaded, &list));
+    contact_list_free(&loaded);
+
+    // === Shutdown commits what is still queued, then refuses writes ===
+    StorageFuture queued[8];
+    for (int i = 0; i < 8; i++)
+    {
+        snprintf(list.data[80 + i].phone, MAX_PHONE_LEN, "555%04d", i);
+        snprintf(list.data[80 + i].email, MAX_EMAIL_LEN, "queued%d@example.com", i);
+        CHECK(storage_update_contact_async(&list.data[80 + i], &queued[i], NULL, NULL) == 0);
+    }
+    storage_shutdown();
+    for (int i = 0; i < 8; i++)
+    {
+        CHECK(queued[i].done && queued[i].result == 0);
+    }
+    CHECK(storage_update_contact_async(&list.data[0], &updated, NULL, NULL) == -1);
+    CHECK(updated.done && updated.result == -1);
+
+    CHECK(storage_init(NULL) == 0);
+    contact_list_init(&loaded, COUNT);
+    CHECK(storage_load_all(&loaded) == list.size);
+    CHECK(same_contacts(&loaded, &list));
+    contact_list_free(&loaded);
+
+    storage_shutdown();
+    contact_list_free(&list);
+    remove_all();
+    return test_report();
+}
@@ -0,0 +1,174 @@
+// Search index: the persisted id order maps only for the snapshot it was
+// written with, a corrupted column is rebuilt, in-place patches re-bind it,
+// and orders updated through add/edit/delete match a fresh sort.
+// Run from an empty directory - it writes contacts.dat and its side files.
+
+#include "../contact_file.h"
+#include "../contact_index.h"
+#include "../contact_reader.h"
+#include "test_util.h"
+
+#define COUNT 300
+#define INDEX_FILE "contacts" INDEX_SUFFIX
+
+static void remove_all(void)
+{
+    char filename[64];
+    remove(BACKUP_PRIMARY_FILE);
+    remove(BACKUP_PRIMARY_FILE SLOTS_SUFFIX);
+    remove(BACKUP_NEXT_DELTA_FILE);
+    remove(INDEX_FILE);
+    for (int generation = 1; generation <= BACKUP_GENERATIONS; generation++)
+    {
+        snprintf(filename, sizeof(filename), "%s.bak%d", BACKUP_PRIMARY_FILE, generation);
+        remove(filename);
+    }
+}
+
+static bool finds_every_id(ContactIndex *index, const ContactList *list)
+{
+    for (int i = 0; i < list->size; i++)
+    {
+        if (contact_index_find_id(index, list, list->data[i].id) != i)
+            return false;
+    }
+    return contact_index_find_id(index, list, 2) == -1; // ids are 1, 4, 7 ...
+}
+
+// Still built - updated in place rather than dropped for a re-sort
+static bool all_built(const ContactIndex *index)
+{
+    for (int field = 0; field < INDEX_FIELD_COUNT; field++)
+    {
+        if (index->owned[field] == NULL)
+            return false;
+    }
+    return true;
+}
+
+// Every order of 'index' equals the one a fresh index sorts
+static bool matches_fresh_sort(ContactIndex *index, const ContactList *list)
+{
+    ContactIndex fresh = {0};
+    bool same = true;
+    for (int field = 0; same && field < INDEX_FIELD_COUNT; field++)
+    {
+        const uint32_t *order = contact_index_order(index, list, (IndexField)field);
+        const uint32_t *expected = contact_index_order(&fresh, list, (IndexField)field);
+        same = order != NULL && expected != NULL &&
+               memcmp(order, expected, (size_t)list->size * sizeof(uint32_t)) == 0;
+    }
+    contact_index_close(&fresh);
+    return same;
+}
+
+static bool read_file(const char *path, void *buffer, long size)
+{
+    FILE *file = fopen(path, "rb");
+    bool ok = file != NULL && fread(buffer, 1, (size_t)size, file) == (size_t)size;
+    if (file != NULL)
+        fclose(file);
+    return ok;
+}
+
+static bool write_file(const char *path, const void *buffer, long size)
+{
+    FILE *file = fopen(path, "wb");
+    bool ok = file != NULL && fwrite(buffer, 1, (size_t)size, file) == (size_t)size;
+    if (file != NULL && fclose(file) != 0)
+        ok = false;
+    return ok;
+}
+
+int main(void)
+{
+    ContactList list;
+    ContactIndex index;
+    remove_all();
+    test_build_list(&list, COUNT);
+    CHECK(contact_file_save_backup_snapshot(&list, (uint32_t)(COUNT * 3 + 2), false));
+
+    // === Saves persist the id order only ===
+    long index_size = file_size(INDEX_FILE);
+    CHECK(index_size == (long)(sizeof(ContactIndexHeader) + (size_t)list.size * sizeof(uint32_t)));
+    CHECK(contact_index_open(&index, BACKUP_PRIMARY_FILE, &list));
+    CHECK(index.order[INDEX_BY_ID] != NULL && index.order[INDEX_BY_NAME] == NULL);
+    CHECK(finds_every_id(&index, &list));
+    CHECK(index.id_verified && index.owned[INDEX_BY_ID] == NULL); // served from the mapping
+    contact_index_close(&index);
+
+    // === A list of another size does not map it ===
+    ContactList shorter;
+    test_build_list(&shorter, COUNT - 1);
+    CHECK(!contact_index_open(&index, BACKUP_PRIMARY_FILE, &shorter));
+    contact_list_free(&shorter);
+
+    // === A corrupted column maps, fails its check on first use, and is rebuilt ===
+    CHECK(flip_byte(INDEX_FILE, -8, SEEK_END, 0x01));
+    CHECK(contact_index_open(&index, BACKUP_PRIMARY_FILE, &list));
+    CHECK(finds_every_id(&index, &list));
+    CHECK(!index.id_verified && index.owned[INDEX_BY_ID] != NULL);
+    contact_index_close(&index);
+
+    // === An index written for another snapshot of the same size is refused ===
+    char *saved = malloc((size_t)index_size);
+    CHECK(saved != NULL);
+    CHECK(contact_file_save_backup_snapshot(&list, (uint32_t)(COUNT * 3 + 2), false));
+    CHECK(saved != NULL && read_file(INDEX_FILE, saved, index_size));
+    snprintf(list.data[10].name, MAX_NAME_LEN, "Another Snapshot");
+    CHECK(contact_file_save_backup_snapshot(&list, (uint32_t)(COUNT * 3 + 2), false));
+    CHECK(saved != NULL && write_file(INDEX_FILE, saved, index_size));
+    CHECK(!contact_index_open(&index, BACKUP_PRIMARY_FILE, &list));
+    free(saved);
+
+    // === An in-place patch re-binds the index instead of rewriting it ===
+    CHECK(contact_file_save_backup_snapshot(&list, (uint32_t)(COUNT * 3 + 2), false));
+    int patched_id = list.data[20].id;
+    snprintf(list.data[20].name, MAX_NAME_LEN, "Patched In Place");
+    CHECK(contact_file_update_records(BACKUP_PRIMARY_FILE, &list, &patched_id, 1, false));
+    CHECK(file_size(INDEX_FILE) == index_size);
+    CHECK(contact_index_open(&index, BACKUP_PRIMARY_FILE, &list));
+    CHECK(finds_every_id(&index, &list));
+    CHECK(index.id_verified);
+
+    // === Add, edit and delete keep every built order equal to a fresh sort ===
+    CHECK(matches_fresh_sort(&index, &list)); // builds name/phone/email, id still mapped
+    uint32_t size = (uint32_t)list.size;
+    CHECK(contact_list_add(&list, &(Contact){.id = COUNT * 3 + 2, .name = "Person 00100 Smith",
+                                             .phone = "5550100", .email = "new@example.com"}));
+    contact_index_appended(&index, &list, size);
+    CHECK(index.map.data == NULL && all_built(&index)); // copied, file released for the next save
+    CHECK(index.count == (uint32_t)list.size && matches_fresh_sort(&index, &list));
+
+    snprintf(list.data[7].name, MAX_NAME_LEN, "Aaron First");
+    contact_index_edited(&index, &list, 7, INDEX_BY_NAME);
+    snprintf(list.data[8].email, MAX_EMAIL_LEN, "zz@last.example");
+    contact_index_edited(&index, &list, 8, INDEX_BY_EMAIL);
+    snprintf(list.data[9].phone, MAX_PHONE_LEN, "%s", list.data[30].phone); // a tie: list order
+    contact_index_edited(&index, &list, 9, INDEX_BY_PHONE);
+    CHECK(all_built(&index) && matches_fresh_sort(&index, &list));
+
+    CHECK(contact_list_remove_by_index(&list, 5));
+    contact_index_removed(&index, &list, 5);
+    CHECK(contact_list_remove_by_index(&list, (int)list.size - 1));
+    contact_index_removed(&index, &list, (uint32_t)list.size);
+    CHECK(all_built(&index));
+    CHECK(index.count == (uint32_t)list.size && matches_fresh_sort(&index, &list));
+    CHECK(finds_every_id(&index, &list));
+
+    // === A bulk append extends the id order and drops the others ===
+    size = (uint32_t)list.size;
+    for (int i = 0; i < 10; i++)
+    {
+        contact_list_add(&list, &(Contact){.id = COUNT * 3 + 10 + i, .name = "Bulk"});
+    }
+    contact_index_appended(&index, &list, size);
+    CHECK(index.order[INDEX_BY_ID] != NULL && index.order[INDEX_BY_NAME] == NULL);
+    CHECK(finds_every_id(&index, &list));
+    CHECK(matches_fresh_sort(&index, &list));
+    contact_index_close(&index);
+
+    contact_list_free(&list);
+    remove_all();
+    return test_report();
+}
@@ -0,0 +1,120 @@
+// Change journal: replay onto an empty list and onto a tracked one (the
+// database load), a torn tail, a corrupted entry, checkpoint and compact.
+// Run from an empty directory - it writes contacts.dat.wal and contacts.dat.
+
+#include "../contact_file.h"
+#include "../contact_index.h"
+#include "../contact_journal.h"
+#include "../contact_reader.h"
+#include "test_util.h"
+
+static void remove_all(void)
+{
+    char filename[64];
+    remove(JOURNAL_FILENAME);
+    remove(BACKUP_PRIMARY_FILE);
+    remove(BACKUP_PRIMARY_FILE SLOTS_SUFFIX);
+    remove("contacts" INDEX_SUFFIX);
+    for (int generation = 1; generation <= BACKUP_GENERATIONS; generation++)
+    {
+        snprintf(filename, sizeof(filename), "%s.bak%d", BACKUP_PRIMARY_FILE, generation);
+        remove(filename);
+    }
+}
+
+// Five entries: add 1, add 2, edit 1, delete 2, add 3
+static void write_journal(void)
+{
+    Contact first = test_contact(1, "Ada Lovelace", "5550101", "ada@example.com");
+    Contact second = test_contact(2, "Alan Turing", "5550102", "alan@example.com");
+    Contact renamed = test_contact(1, "Ada King", "5550101", "ada@example.com");
+    Contact third = test_contact(3, "Grace Hopper", "5550103", "grace@example.com");
+
+    CHECK(contact_journal_open());
+    next_contact_id = 3;
+    CHECK(contact_journal_append(JOURNAL_OP_ADD, &first));
+    CHECK(contact_journal_append(JOURNAL_OP_ADD, &second));
+    CHECK(contact_journal_append(JOURNAL_OP_EDIT, &renamed));
+    CHECK(contact_journal_append(JOURNAL_OP_DELETE, &second));
+    next_contact_id = 4;
+    CHECK(contact_journal_append(JOURNAL_OP_ADD, &third));
+    contact_journal_close();
+}
+
+static void expected_list(ContactList *list)
+{
+    contact_list_init(list, 2);
+    Contact renamed = test_contact(1, "Ada King", "5550101", "ada@example.com");
+    Contact third = test_contact(3, "Grace Hopper", "5550103", "grace@example.com");
+    contact_list_add(list, &renamed);
+    contact_list_add(list, &third);
+}
+
+int main(void)
+{
+    ContactList expected;
+    ContactList list;
+    remove_all();
+    write_journal();
+    expected_list(&expected);
+
+    // === Replay onto an empty list (legacy load without a snapshot) ===
+    next_contact_id = 1;
+    contact_list_init(&list, 4);
+    CHECK(contact_journal_replay(&list) == 5);
+    CHECK(same_contacts(&list, &expected));
+    CHECK(next_contact_id == 4);
+    contact_list_free(&list);
+
+    // === Replay onto a tracked list (the database load): the entries
+    // become changes the next sync writes ===
+    contact_list_init(&list, 4);
+    Contact stored_first = test_contact(1, "Ada Lovelace", "5550101", "ada@example.com");
+    Contact stored_second = test_contact(2, "Alan Turing", "5550102", "alan@example.com");
+    contact_list_add(&list, &stored_first);
+    contact_list_add(&list, &stored_second);
+    contact_list_track_changes(&list);
+    CHECK(!contact_list_has_changes(&list));
+    CHECK(contact_journal_replay(&list) == 5);
+    CHECK(same_contacts(&list, &expected));
+    CHECK(contact_list_changed_count(&list) == 2); // 1 edited, 3 new
+    CHECK(list.deleted_count == 1 && list.deleted_ids[0] == 2);
+    contact_list_free(&list);
+
+    // === A torn tail is cut off when the journal opens ===
+    FILE *file = fopen(JOURNAL_FILENAME, "ab");
+    CHECK(file != NULL);
+    if (file != NULL)
+    {
+        fwrite("torn entry", 1, 10, file);
+        fclose(file);
+    }
+    CHECK(contact_journal_open());
+    contact_journal_close();
+    CHECK(file_size(JOURNAL_FILENAME) == 5 * (long)JOURNAL_ENTRY_SIZE);
+
+    // === A corrupted entry ends the replay: only the ones before it apply ===
+    CHECK(flip_byte(JOURNAL_FILENAME, 3 * (long)JOURNAL_ENTRY_SIZE + 40, SEEK_SET, 0x01));
+    contact_list_init(&list, 4);
+    CHECK(contact_journal_replay(&list) == 3);
+    CHECK(list.size == 2);
+    contact_list_free(&list);
+
+    // === Compact: the snapshot holds every entry, the journal is empty ===
+    remove(JOURNAL_FILENAME);
+    write_journal();
+    CHECK(contact_journal_open());
+    CHECK(contact_journal_compact(&expected, false));
+    CHECK(file_size(JOURNAL_FILENAME) == 0);
+    contact_journal_close();
+
+    contact_list_init(&list, 4);
+    CHECK(contact_file_load(&list, BACKUP_PRIMARY_FILE));
+    CHECK(same_contacts(&list, &expected));
+    CHECK(contact_journal_replay(&list) == 0);
+    contact_list_free(&list);
+
+    contact_list_free(&expected);
+    remove_all();
+    return test_report();
+}
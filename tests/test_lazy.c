@@ -0,0 +1,101 @@
+// Lazy snapshot view: the id/name index matches the file, ids go through
+// the slot index, name search touches only the hits, the LRU cache, and a
+// file the view must refuse (corrupted, compressed).
+// Run from an empty directory - it writes contacts.dat and its side files.
+
+#include "../contact_file.h"
+#include "../contact_index.h"
+#include "../contact_journal.h"
+#include "../contact_lazy.h"
+#include "test_util.h"
+
+#define COUNT 1000
+
+static void remove_all(void)
+{
+    char filename[64];
+    remove(BACKUP_PRIMARY_FILE);
+    remove(BACKUP_PRIMARY_FILE SLOTS_SUFFIX);
+    remove(BACKUP_NEXT_DELTA_FILE);
+    remove(JOURNAL_FILENAME);
+    remove("contacts" INDEX_SUFFIX);
+    for (int generation = 1; generation <= BACKUP_GENERATIONS; generation++)
+    {
+        snprintf(filename, sizeof(filename), "%s.bak%d", BACKUP_PRIMARY_FILE, generation);
+        remove(filename);
+    }
+}
+
+static bool same_contact(const Contact *a, const Contact *b)
+{
+    return a != NULL && a->id == b->id && strcmp(a->name, b->name) == 0 &&
+           strcmp(a->phone, b->phone) == 0 && strcmp(a->email, b->email) == 0;
+}
+
+int main(void)
+{
+    ContactList list;
+    LazyContactFile lazy;
+    remove_all();
+    test_build_list(&list, COUNT);
+    CHECK(contact_file_save_backup_snapshot(&list, (uint32_t)(COUNT * 3 + 2), false));
+
+    // === Open: every record indexed, nothing decoded yet ===
+    CHECK(contact_journal_is_empty());
+    CHECK(contact_lazy_open(&lazy, BACKUP_PRIMARY_FILE));
+    CHECK(contact_lazy_count(&lazy) == (uint32_t)list.size);
+    CHECK(contact_lazy_next_id(&lazy) == (uint32_t)(COUNT * 3 + 2));
+    CHECK(lazy.hits == 0 && lazy.misses == 0);
+
+    // === Ids through the slot index, positions in file order ===
+    CHECK(same_contact(contact_lazy_find_id(&lazy, 4), &list.data[1]));
+    CHECK(same_contact(contact_lazy_find_id(&lazy, 42 * 3 + 1), &list.data[42])); // every field full
+    CHECK(same_contact(contact_lazy_find_id(&lazy, COUNT * 3 + 1), &list.data[COUNT]));
+    CHECK(contact_lazy_find_id(&lazy, 2) == NULL);
+    CHECK(same_contact(contact_lazy_get(&lazy, 500), &list.data[500]));
+    CHECK(contact_lazy_get(&lazy, (uint32_t)list.size) == NULL);
+    CHECK(lazy.misses == 4);
+
+    // === A repeat is a cache hit; LAZY_CACHE_SIZE newer reads evict it ===
+    CHECK(same_contact(contact_lazy_get(&lazy, 500), &list.data[500]));
+    CHECK(lazy.hits == 1);
+    for (uint32_t i = 0; i < LAZY_CACHE_SIZE; i++)
+    {
+        contact_lazy_get(&lazy, i + 600);
+    }
+    unsigned long misses = lazy.misses;
+    contact_lazy_get(&lazy, 500);
+    CHECK(lazy.misses == misses + 1);
+
+    // === Name search on the index matches contact_find_by_name_in_list ===
+    uint32_t positions[COUNT + 1];
+    int indices[COUNT + 1];
+    int found = contact_lazy_find_by_name(&lazy, "person 0012", positions, COUNT + 1);
+    CHECK(found > 0);
+    CHECK(found == contact_find_by_name_in_list(&list, "person 0012", indices));
+    for (int i = 0; i < found; i++)
+    {
+        CHECK(positions[i] == (uint32_t)indices[i]);
+    }
+    contact_lazy_close(&lazy);
+
+    // === A flipped record byte fails the checksum taken while indexing ===
+    CHECK(flip_byte(BACKUP_PRIMARY_FILE, (long)sizeof(ContactFileHeader) + 700L * CONTACT_PACKED_SIZE + 60,
+                    SEEK_SET, 0x04));
+    CHECK(!contact_lazy_open(&lazy, BACKUP_PRIMARY_FILE));
+    CHECK(lazy.index == NULL && lazy.reader.file == NULL);
+
+    // === Compressed snapshots have no slots to fault records in from ===
+    CHECK(contact_file_save_compressed(&list, BACKUP_PRIMARY_FILE));
+    CHECK(!contact_lazy_open(&lazy, BACKUP_PRIMARY_FILE));
+
+    // === Journal entries mean the snapshot is not the whole story ===
+    CHECK(contact_journal_open());
+    CHECK(contact_journal_append(JOURNAL_OP_EDIT, &list.data[0]));
+    contact_journal_close();
+    CHECK(!contact_journal_is_empty());
+
+    contact_list_free(&list);
+    remove_all();
+    return test_report();
+}
@@ -0,0 +1,141 @@
+// In-place update of contacts.dat: patched slots load with a valid
+// checksum, the unpatched file stays reachable as .bak1, lists that are
+// not the snapshot are refused untouched, an interrupted patch still loads,
+// and a journal of edits is compacted by patching.
+// Run from an empty directory - it writes contacts.dat and its side files.
+
+#include "../contact_file.h"
+#include "../contact_index.h"
+#include "../contact_journal.h"
+#include "../contact_reader.h"
+#include "test_util.h"
+#include <stddef.h>
+
+#define COUNT 200
+
+static void remove_all(void)
+{
+    char filename[64];
+    remove(BACKUP_PRIMARY_FILE);
+    remove(BACKUP_PRIMARY_FILE SLOTS_SUFFIX);
+    remove(BACKUP_NEXT_DELTA_FILE);
+    remove(JOURNAL_FILENAME);
+    remove("contacts" INDEX_SUFFIX);
+    for (int generation = 1; generation <= BACKUP_GENERATIONS; generation++)
+    {
+        snprintf(filename, sizeof(filename), "%s.bak%d", BACKUP_PRIMARY_FILE, generation);
+        remove(filename);
+    }
+}
+
+static bool primary_header(ContactFileHeader *header)
+{
+    FILE *file = fopen(BACKUP_PRIMARY_FILE, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool got = fread(header, sizeof(*header), 1, file) == 1;
+    fclose(file);
+    return got;
+}
+
+static bool bak1_is_delta(void)
+{
+    uint32_t magic = 0;
+    FILE *file = fopen(BACKUP_PRIMARY_FILE ".bak1", "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool got = fread(&magic, sizeof(magic), 1, file) == 1;
+    fclose(file);
+    return got && magic == FILE_MAGIC_LRBD;
+}
+
+static bool loads_as(int generation, const ContactList *expected)
+{
+    ContactList loaded = {0};
+    bool ok = contact_file_load_generation(&loaded, generation) &&
+              same_contacts(&loaded, expected);
+    contact_list_free(&loaded);
+    return ok;
+}
+
+int main(void)
+{
+    ContactList original;
+    ContactList edited;
+    ContactFileHeader before;
+    ContactFileHeader after;
+    remove_all();
+    test_build_list(&original, COUNT);
+    test_build_list(&edited, COUNT);
+    CHECK(contact_file_save_backup_snapshot(&original, (uint32_t)(COUNT * 3 + 2), false));
+    long size = file_size(BACKUP_PRIMARY_FILE);
+
+    // === Two edited records are patched into their slots ===
+    int ids[2] = {edited.data[5].id, edited.data[150].id};
+    snprintf(edited.data[5].name, MAX_NAME_LEN, "Patched Name");
+    snprintf(edited.data[150].email, MAX_EMAIL_LEN, "patched@example.com");
+    CHECK(primary_header(&before));
+    CHECK(contact_file_update_records(BACKUP_PRIMARY_FILE, &edited, ids, 2, false));
+    CHECK(primary_header(&after));
+    CHECK(file_size(BACKUP_PRIMARY_FILE) == size);
+    CHECK(after.data_checksum != before.data_checksum && after.pending_flag == 0);
+    CHECK(loads_as(0, &edited));   // full load verifies the patched checksum
+    CHECK(loads_as(1, &original)); // the unpatched file, as a delta
+
+    // === A list that differs outside 'ids' is refused, nothing written ===
+    ContactList drifted;
+    test_build_list(&drifted, COUNT);
+    snprintf(drifted.data[5].name, MAX_NAME_LEN, "Patched Name");
+    snprintf(drifted.data[150].email, MAX_EMAIL_LEN, "patched@example.com");
+    snprintf(drifted.data[7].phone, MAX_PHONE_LEN, "5550000");
+    snprintf(drifted.data[9].phone, MAX_PHONE_LEN, "5551111");
+    int drifted_id = drifted.data[9].id;
+    CHECK(!contact_file_update_records(BACKUP_PRIMARY_FILE, &drifted, &drifted_id, 1, false));
+    CHECK(primary_header(&before));
+    CHECK(before.data_checksum == after.data_checksum && before.timestamp == after.timestamp);
+    CHECK(loads_as(1, &original)); // no generation pushed
+
+    // === So is an added contact: adds change the slot count ===
+    contact_list_add(&drifted, &(Contact){.id = COUNT * 3 + 2});
+    CHECK(!contact_file_update_records(BACKUP_PRIMARY_FILE, &drifted, &drifted_id, 1, false));
+    contact_list_free(&drifted);
+
+    // === Interrupted after the announce: the file still loads, and the
+    // next update asks for a full save ===
+    after.pending_flag = FILE_PATCH_PENDING;
+    after.pending_checksum = after.data_checksum ^ 0x5A5A;
+    after.header_checksum = fletcher32(&after.data_checksum,
+                                       sizeof(ContactFileHeader) - offsetof(ContactFileHeader, data_checksum));
+    FILE *file = fopen(BACKUP_PRIMARY_FILE, "r+b");
+    CHECK(file != NULL);
+    if (file != NULL)
+    {
+        fwrite(&after, sizeof(after), 1, file);
+        fclose(file);
+    }
+    CHECK(loads_as(0, &edited));
+    CHECK(!contact_file_update_records(BACKUP_PRIMARY_FILE, &edited, ids, 2, false));
+
+    // === A journal of edits only is compacted by patching ===
+    CHECK(contact_file_save_backup_snapshot(&edited, (uint32_t)(COUNT * 3 + 2), false));
+    CHECK(contact_journal_open());
+    snprintf(edited.data[20].name, MAX_NAME_LEN, "Journaled Edit");
+    CHECK(contact_journal_append(JOURNAL_OP_EDIT, &edited.data[20]));
+    CHECK(primary_header(&before));
+    CHECK(contact_journal_compact(&edited, true));
+    CHECK(bak1_is_delta()); // a full save would have kept the old file whole
+    CHECK(primary_header(&after));
+    CHECK(file_size(JOURNAL_FILENAME) == 0);
+    CHECK(after.timestamp >= before.timestamp && after.data_checksum != before.data_checksum);
+    CHECK(loads_as(0, &edited));
+    contact_journal_close();
+
+    contact_list_free(&original);
+    contact_list_free(&edited);
+    remove_all();
+    return test_report();
+}
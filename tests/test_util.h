@@ -0,0 +1,124 @@
+// Shared by the tests: the CHECK macro and its summary, a contact list
+// builder, list comparison and single-byte corruption of a file.
+// Each test is one translation unit, so everything here is static inline.
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include "../contact_dynamic.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition)                                              \
+    do                                                                \
+    {                                                                 \
+        if (!(condition))                                             \
+        {                                                             \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                               \
+        }                                                             \
+    } while (0)
+
+// Prints the summary line; the exit status of main
+static inline int test_report(void)
+{
+    printf("%s: %d failure(s)\n", failures == 0 ? "PASS" : "FAIL", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+static inline Contact test_contact(int id, const char *name, const char *phone, const char *email)
+{
+    Contact contact = {0};
+    contact.id = id;
+    snprintf(contact.name, MAX_NAME_LEN, "%s", name);
+    snprintf(contact.phone, MAX_PHONE_LEN, "%s", phone);
+    snprintf(contact.email, MAX_EMAIL_LEN, "%s", email);
+    return contact;
+}
+
+// 'count' contacts with ids 1, 4, 7 ..., then one with every field empty.
+// Unsorted names with shared prefixes, phones with and without 4-bit
+// codes, e-mails with and without a domain (in mixed case), and one
+// record with every field filled to the last byte.
+static inline void test_build_list(ContactList *list, int count)
+{
+    static const char *const domains[] = {"example.com", "mail.example.org", "Example.COM", "mail.org"};
+    contact_list_init(list, count + 1);
+    for (int i = 0; i < count; i++)
+    {
+        Contact contact = {0};
+        int key = (int)(((long)i * 7919) % count);
+        contact.id = i * 3 + 1;
+        snprintf(contact.name, MAX_NAME_LEN, "Person %05d %s", key, key % 3 ? "Smith" : "Jones");
+        snprintf(contact.phone, MAX_PHONE_LEN, i % 5 ? "+1 (555) %04d" : "555x%04d", key % 10000);
+        if (i % 9 == 0)
+            snprintf(contact.email, MAX_EMAIL_LEN, "no-domain-%d", i);
+        else
+            snprintf(contact.email, MAX_EMAIL_LEN, "p%d@%s", key, domains[i % 4]);
+        if (i == 42 % count)
+        {
+            memset(contact.name, 'N', MAX_NAME_LEN - 1);
+            memset(contact.phone, '9', MAX_PHONE_LEN - 1);
+            memset(contact.email, 'e', MAX_EMAIL_LEN - 1);
+        }
+        contact_list_add(list, &contact);
+    }
+    contact_list_add(list, &(Contact){.id = count * 3 + 1});
+}
+
+// Same contacts, field for field. 'actual' is sorted by id first, so it
+// may come back in any order; 'expected' must be in id order.
+static inline bool same_contacts(ContactList *actual, const ContactList *expected)
+{
+    if (actual->size != expected->size)
+    {
+        return false;
+    }
+    qsort(actual->data, actual->size, sizeof(Contact), contact_compare_id);
+    for (int i = 0; i < actual->size; i++)
+    {
+        const Contact *a = &actual->data[i];
+        const Contact *b = &expected->data[i];
+        if (a->id != b->id || strcmp(a->name, b->name) != 0 ||
+            strcmp(a->phone, b->phone) != 0 || strcmp(a->email, b->email) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// XORs one byte of 'path' at 'offset' from 'whence' (a SEEK_* constant)
+static inline bool flip_byte(const char *path, long offset, int whence, int mask)
+{
+    FILE *file = fopen(path, "r+b");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool flipped = fseek(file, offset, whence) == 0;
+    long position = ftell(file);
+    int byte = flipped ? fgetc(file) : EOF;
+    flipped = byte != EOF && fseek(file, position, SEEK_SET) == 0 && fputc(byte ^ mask, file) != EOF;
+    fclose(file);
+    return flipped;
+}
+
+static inline long file_size(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+#endif